@@ -0,0 +1,243 @@
+/**
+ * @file autotune.cpp
+ * @brief Sweeps MyBambooFilter configurations against a key sample and query mix
+ * and reports the Pareto-optimal ones for lookup throughput, FPR and memory.
+ *
+ * MyBambooFilter stores every slot in 16 bytes whatever the fingerprint width, so
+ * memoryUsage() cannot tell a narrow fingerprint from a wide one. The frontier is
+ * therefore scored on the modelled bit-packed size (fingerprint bits times table slots),
+ * which is what a narrower fingerprint buys; the --memory-budget still applies to the
+ * memory actually allocated.
+ *
+ * Usage:
+ *   BambooAutotune (--keys FILE | --synthetic N) [--sample N] [--positive-fraction F]
+ *                  [--queries N] [--memory-budget BYTES[K|M|G]] [--expected-items N]
+ *                  [--repeats N] [--quick] [--all] [--csv]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "bamboo_filter.h"
+#include "bench_util.h"
+
+namespace {
+
+struct Options {
+    std::string keys_path;
+    std::size_t synthetic_keys = 0;
+    std::size_t sample = 0;
+    double positive_fraction = 0.5;
+    std::size_t queries = 0;
+    std::size_t memory_budget = 0;
+    std::size_t expected_items = 0;
+    std::size_t repeats = 1;
+    bool quick = false;
+    bool all = false;
+    bool csv = false;
+};
+
+struct Result {
+    MyBambooFilter::Config config;
+    double insert_mops;
+    double lookup_mops;
+    double fpr;
+    std::size_t memory_bytes;  ///< memoryUsage()
+    std::size_t packed_bytes;  ///< Fingerprint bits of every table slot, rounded up to bytes
+    double bits_per_item;      ///< Packed bits per stored item
+};
+
+std::size_t parse_size(const std::string& text) {
+    std::size_t pos = 0;
+    double value = std::stod(text, &pos);
+    if (pos < text.size()) {
+        switch (text[pos]) {
+            case 'k': case 'K': value *= 1024.0; break;
+            case 'm': case 'M': value *= 1024.0 * 1024.0; break;
+            case 'g': case 'G': value *= 1024.0 * 1024.0 * 1024.0; break;
+            default: throw std::invalid_argument("Bad size suffix in " + text);
+        }
+    }
+    return static_cast<std::size_t>(value);
+}
+
+void usage() {
+    std::cerr << "Usage: BambooAutotune (--keys FILE | --synthetic N) [--sample N] [--positive-fraction F]\n"
+                 "                      [--queries N] [--memory-budget BYTES[K|M|G]] [--expected-items N]\n"
+                 "                      [--repeats N] [--quick] [--all] [--csv]\n";
+}
+
+bool parse_args(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--keys") opt.keys_path = next();
+        else if (arg == "--synthetic") opt.synthetic_keys = parse_size(next());
+        else if (arg == "--sample") opt.sample = parse_size(next());
+        else if (arg == "--positive-fraction") opt.positive_fraction = std::stod(next());
+        else if (arg == "--queries") opt.queries = parse_size(next());
+        else if (arg == "--memory-budget") opt.memory_budget = parse_size(next());
+        else if (arg == "--expected-items") opt.expected_items = parse_size(next());
+        else if (arg == "--repeats") opt.repeats = std::max<std::size_t>(1, parse_size(next()));
+        else if (arg == "--quick") opt.quick = true;
+        else if (arg == "--all") opt.all = true;
+        else if (arg == "--csv") opt.csv = true;
+        else return false;
+    }
+    return !opt.keys_path.empty() || opt.synthetic_keys != 0;
+}
+
+Result evaluate(const MyBambooFilter::Config& config, const std::vector<std::string>& keys,
+                const std::vector<std::string>& queries, const std::vector<bool>& query_is_member,
+                std::size_t repeats) {
+    Result best{config, 0.0, 0.0, 0.0, 0, 0, 0.0};
+    for (std::size_t r = 0; r < repeats; ++r) {
+        MyBambooFilter filter(config);
+
+        bench::Stopwatch watch;
+        for (const auto& key : keys) filter.insert(key);
+        const double insert_seconds = watch.seconds();
+
+        std::size_t negatives = 0;
+        std::size_t false_positives = 0;
+        std::size_t hits = 0;
+        watch.reset();
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            const bool found = filter.contains(queries[i]);
+            hits += found;
+            if (!query_is_member[i]) {
+                negatives++;
+                false_positives += found;
+            }
+        }
+        const double lookup_seconds = watch.seconds();
+        bench::consume(hits);
+
+        best.insert_mops = std::max(best.insert_mops, keys.size() / insert_seconds / 1e6);
+        best.lookup_mops = std::max(best.lookup_mops, queries.size() / lookup_seconds / 1e6);
+        best.fpr = negatives ? static_cast<double>(false_positives) / negatives : 0.0;
+        best.memory_bytes = filter.memoryUsage();
+        const std::size_t packed_bits = filter.capacity_buckets() * config.slots_per_bucket * filter.fingerprint_bits();
+        best.packed_bytes = (packed_bits + 7) / 8;
+        best.bits_per_item = static_cast<double>(packed_bits) / std::max<std::size_t>(1, filter.size());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        if (!parse_args(argc, argv, opt)) {
+            usage();
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        usage();
+        return 1;
+    }
+
+    std::vector<std::string> keys = opt.keys_path.empty() ? bench::make_keys(opt.synthetic_keys, 1)
+                                                           : bench::read_lines(opt.keys_path, opt.sample);
+    if (keys.empty()) {
+        std::cerr << "No keys to tune against.\n";
+        return 1;
+    }
+    const std::size_t expected_items = opt.expected_items ? opt.expected_items : keys.size();
+    const std::size_t num_queries = opt.queries ? opt.queries : keys.size();
+
+    // Negative queries are derived from the sample so they share its length and alphabet.
+    const std::unordered_set<std::string> members(keys.begin(), keys.end());
+    std::mt19937_64 rng(42);
+    std::vector<std::string> queries;
+    std::vector<bool> query_is_member;
+    queries.reserve(num_queries);
+    query_is_member.reserve(num_queries);
+    std::bernoulli_distribution pick_member(opt.positive_fraction);
+    std::uniform_int_distribution<std::size_t> pick_key(0, keys.size() - 1);
+    for (std::size_t i = 0; queries.size() < num_queries; ++i) {
+        if (pick_member(rng)) {
+            queries.push_back(keys[pick_key(rng)]);
+            query_is_member.push_back(true);
+        } else {
+            std::string negative = keys[pick_key(rng)] + "~" + std::to_string(i);
+            if (members.count(negative)) continue;
+            queries.push_back(std::move(negative));
+            query_is_member.push_back(false);
+        }
+    }
+
+    const std::vector<std::size_t> slot_options = opt.quick ? std::vector<std::size_t>{4, 8} : std::vector<std::size_t>{2, 4, 8};
+    const std::vector<unsigned> fp_options = opt.quick ? std::vector<unsigned>{12, 16} : std::vector<unsigned>{8, 12, 16};
+    const std::vector<float> load_options = opt.quick ? std::vector<float>{0.9f, 0.95f} : std::vector<float>{0.85f, 0.9f, 0.95f};
+    const std::vector<std::size_t> kick_options = opt.quick ? std::vector<std::size_t>{100, 500} : std::vector<std::size_t>{50, 200, 500};
+    const std::vector<MyBambooFilter::HashPolicy> hash_options = {
+        MyBambooFilter::HashPolicy::Fnv1a, MyBambooFilter::HashPolicy::Fnv1aMix, MyBambooFilter::HashPolicy::WordMix};
+
+    std::vector<Result> results;
+    for (std::size_t slots : slot_options) {
+        for (unsigned fp_bits : fp_options) {
+            for (float load : load_options) {
+                for (std::size_t kicks : kick_options) {
+                    for (auto hash : hash_options) {
+                        MyBambooFilter::Config config;
+                        config.slots_per_bucket = slots;
+                        config.fingerprint_bits = fp_bits;
+                        config.load_factor_threshold = load;
+                        config.max_cuckoo_kicks = kicks;
+                        config.hash_policy = hash;
+                        // Size the table for the expected item count so the sweep measures steady state, not rebuilds.
+                        config.initial_num_buckets = static_cast<std::size_t>(expected_items / (slots * load)) + 1;
+
+                        Result result = evaluate(config, keys, queries, query_is_member, opt.repeats);
+                        if (opt.memory_budget != 0 && result.memory_bytes > opt.memory_budget) continue;
+                        results.push_back(result);
+                    }
+                }
+            }
+        }
+    }
+    if (results.empty()) {
+        std::cerr << "No configuration fits the memory budget.\n";
+        return 1;
+    }
+
+    std::vector<std::vector<double>> points;
+    for (const auto& r : results) points.push_back({r.lookup_mops, r.fpr, static_cast<double>(r.packed_bytes)});
+    const std::vector<bool> on_front = bench::pareto_front(points, {true, false, false});
+
+    if (opt.csv) {
+        std::cout << "pareto,slots_per_bucket,fingerprint_bits,load_factor_threshold,max_cuckoo_kicks,hash_policy,"
+                     "insert_mops,lookup_mops,fpr,memory_bytes,packed_bytes,bits_per_item\n";
+    } else {
+        std::cout << "keys=" << keys.size() << " queries=" << queries.size()
+                  << " positive_fraction=" << opt.positive_fraction
+                  << " configurations=" << results.size() << "\n\n";
+        std::printf("%-3s %5s %4s %5s %5s %-10s %9s %9s %10s %12s %12s %9s\n", "", "slots", "fp", "load", "kicks", "hash",
+                    "ins Mop/s", "qry Mop/s", "fpr", "memory B", "packed B", "bits/item");
+    }
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        if (!opt.all && !on_front[i]) continue;
+        const Result& r = results[i];
+        if (opt.csv) {
+            std::printf("%d,%zu,%u,%.2f,%zu,%s,%.3f,%.3f,%.6g,%zu,%zu,%.2f\n", on_front[i] ? 1 : 0,
+                        r.config.slots_per_bucket, r.config.fingerprint_bits, r.config.load_factor_threshold,
+                        r.config.max_cuckoo_kicks, MyBambooFilter::hash_policy_name(r.config.hash_policy),
+                        r.insert_mops, r.lookup_mops, r.fpr, r.memory_bytes, r.packed_bytes, r.bits_per_item);
+        } else {
+            std::printf("%-3s %5zu %4u %5.2f %5zu %-10s %9.3f %9.3f %10.3g %12zu %12zu %9.2f\n", on_front[i] ? "*" : "",
+                        r.config.slots_per_bucket, r.config.fingerprint_bits, r.config.load_factor_threshold,
+                        r.config.max_cuckoo_kicks, MyBambooFilter::hash_policy_name(r.config.hash_policy),
+                        r.insert_mops, r.lookup_mops, r.fpr, r.memory_bytes, r.packed_bytes, r.bits_per_item);
+        }
+    }
+    return 0;
+}
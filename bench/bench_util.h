@@ -0,0 +1,125 @@
+#ifndef BAMBOO_BENCH_UTIL_H
+#define BAMBOO_BENCH_UTIL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @file bench_util.h
+ * @brief Small helpers shared by the benchmark and tuning executables.
+ */
+namespace bench {
+
+/** @brief Monotonic stopwatch measuring elapsed seconds since construction or the last reset. */
+class Stopwatch {
+public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+    /** @brief Restarts the measurement. */
+    void reset() { start_ = std::chrono::steady_clock::now(); }
+
+    /** @brief Returns the elapsed time in seconds. */
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+/** @brief Publishes a result so the compiler cannot discard the loop that produced it. */
+inline void consume(std::size_t value) {
+    static std::atomic<std::size_t> sink;
+    sink.store(value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Reads a file into a vector of lines, skipping empty lines.
+ * @param path Path of the file.
+ * @param max_lines Stop after this many lines (0 = read everything).
+ * @return The lines, without trailing newline or carriage return characters.
+ * @throws std::runtime_error If the file cannot be opened.
+ */
+inline std::vector<std::string> read_lines(const std::string& path, std::size_t max_lines = 0) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open " + path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        lines.push_back(line);
+        if (max_lines != 0 && lines.size() >= max_lines) break;
+    }
+    return lines;
+}
+
+/**
+ * @brief Generates deterministic pseudo-random keys ("key-<n>" with a scrambled n).
+ * @param count Number of keys to generate.
+ * @param seed Seed distinguishing independent key sets.
+ * @return The generated keys.
+ */
+inline std::vector<std::string> make_keys(std::size_t count, std::uint64_t seed) {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    std::uint64_t state = seed * 0x9e3779b97f4a7c15ULL + 1;
+    for (std::size_t i = 0; i < count; ++i) {
+        // splitmix64 step
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        keys.push_back("key-" + std::to_string(seed) + "-" + std::to_string(z));
+    }
+    return keys;
+}
+
+/**
+ * @brief Returns the p-th percentile (0..100) of the samples using nearest-rank.
+ * The samples are partially reordered.
+ */
+template <typename T>
+T percentile(std::vector<T>& samples, double p) {
+    if (samples.empty()) return T{};
+    std::size_t rank = static_cast<std::size_t>(p / 100.0 * (samples.size() - 1) + 0.5);
+    rank = std::min(rank, samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+/**
+ * @brief Marks the points that no other point dominates.
+ * A point dominates another if it is at least as good in every objective and
+ * strictly better in one.
+ * @param points One objective vector per candidate.
+ * @param maximize Per objective: true if larger values are better, false if smaller are.
+ * @return One flag per candidate, true if it lies on the Pareto frontier.
+ */
+inline std::vector<bool> pareto_front(const std::vector<std::vector<double>>& points, const std::vector<bool>& maximize) {
+    std::vector<bool> on_front(points.size(), true);
+    for (std::size_t a = 0; a < points.size(); ++a) {
+        for (std::size_t b = 0; b < points.size() && on_front[a]; ++b) {
+            if (a == b) continue;
+            bool at_least_as_good = true;
+            bool strictly_better = false;
+            for (std::size_t k = 0; k < maximize.size(); ++k) {
+                const double better = maximize[k] ? points[b][k] - points[a][k] : points[a][k] - points[b][k];
+                if (better < 0) { at_least_as_good = false; break; }
+                if (better > 0) strictly_better = true;
+            }
+            if (at_least_as_good && strictly_better) on_front[a] = false;
+        }
+    }
+    return on_front;
+}
+
+} // namespace bench
+
+#endif // BAMBOO_BENCH_UTIL_H
@@ -0,0 +1,137 @@
+/**
+ * @file front_cache_bench.cpp
+ * @brief Measures FrontCachedFilter against a plain MyBambooFilter on skewed query
+ * streams: Zipf-distributed lookups of inserted items mixed with random misses.
+ *
+ * For each Zipf exponent both filters answer the same query stream through
+ * contains_hashed_batch(); the table reports throughput, the share of lookups the
+ * front answered, and whether the front's answers match its backing filter's.
+ *
+ * Usage:
+ *   BambooFrontCacheBench [--items N] [--queries N] [--negative-fraction F] [--front-bytes N]
+ *                         [--threshold N] [--batch N]
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bamboo_filter.h"
+#include "bench_util.h"
+#include "front_cached_filter.h"
+
+namespace {
+
+struct Options {
+    std::size_t items = 1u << 23;
+    std::size_t queries = 1u << 23;
+    double negative_fraction = 0.1;
+    std::size_t front_bytes = 1u << 20;
+    unsigned threshold = 2;
+    std::size_t batch = 1024;
+};
+
+/** @brief Draws `count` ranks in [0, n) with P(rank r) proportional to 1 / (r + 1)^s. */
+std::vector<std::size_t> zipf_ranks(std::size_t n, double s, std::size_t count, std::uint64_t seed) {
+    std::vector<double> cdf(n);
+    double total = 0.0;
+    for (std::size_t r = 0; r < n; ++r) cdf[r] = total += std::pow(static_cast<double>(r + 1), -s);
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, total);
+    std::vector<std::size_t> ranks(count);
+    for (auto& rank : ranks) {
+        rank = static_cast<std::size_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+        rank = std::min(rank, n - 1);
+    }
+    return ranks;
+}
+
+template <typename Filter>
+double run(Filter& filter, const std::vector<std::uint64_t>& queries, std::size_t batch, bool* results) {
+    bench::Stopwatch watch;
+    for (std::size_t i = 0; i < queries.size(); i += batch) {
+        filter.contains_hashed_batch(queries.data() + i, std::min(batch, queries.size() - i), results + i);
+    }
+    return queries.size() / watch.seconds() / 1e6;
+}
+
+void usage() {
+    std::cerr << "Usage: BambooFrontCacheBench [--items N] [--queries N] [--negative-fraction F] [--front-bytes N]\n"
+                 "                             [--threshold N] [--batch N]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (arg == "--items") opt.items = std::stoull(argv[++i]);
+        else if (arg == "--queries") opt.queries = std::stoull(argv[++i]);
+        else if (arg == "--negative-fraction") opt.negative_fraction = std::stod(argv[++i]);
+        else if (arg == "--front-bytes") opt.front_bytes = std::stoull(argv[++i]);
+        else if (arg == "--threshold") opt.threshold = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--batch") opt.batch = std::max<std::size_t>(1, std::stoull(argv[++i]));
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = std::max<std::size_t>(1, static_cast<std::size_t>(opt.items / (4 * 0.9)));
+    FrontCachedFilter::Options front;
+    front.front_bytes = opt.front_bytes;
+    front.admission_threshold = opt.threshold;
+
+    std::vector<std::uint64_t> items(opt.items);
+    for (std::size_t i = 0; i < opt.items; ++i) items[i] = MyBambooFilter::mix64(i);
+    MyBambooFilter plain(config);
+    FrontCachedFilter cached(config, front);
+    plain.insert_hashed_batch(items.data(), items.size());
+    for (std::uint64_t h : items) cached.insert_hashed(h);
+
+    std::printf("%zu items (%.1f MiB table), front %zu entries (%.1f MiB), %.0f%% misses, batch %zu\n", opt.items,
+                plain.memoryUsage() / (1024.0 * 1024.0), cached.front_capacity(),
+                (cached.memoryUsage() - cached.backing().memoryUsage()) / (1024.0 * 1024.0),
+                opt.negative_fraction * 100, opt.batch);
+    std::printf("%8s %12s %12s %10s %12s %10s\n", "zipf s", "plain Mops", "front Mops", "speedup", "front hits", "answers");
+
+    std::unique_ptr<bool[]> expected(new bool[opt.queries]);
+    std::unique_ptr<bool[]> actual(new bool[opt.queries]);
+    for (double s : {0.0, 0.6, 0.8, 0.99, 1.2}) {
+        // Rank r maps to a random item, so popular items are spread over the table.
+        std::vector<std::size_t> order(opt.items);
+        for (std::size_t i = 0; i < opt.items; ++i) order[i] = i;
+        std::mt19937_64 rng(static_cast<std::uint64_t>(s * 1000) + 1);
+        std::shuffle(order.begin(), order.end(), rng);
+        const std::vector<std::size_t> ranks = zipf_ranks(opt.items, s, opt.queries, 7);
+        std::bernoulli_distribution negative(opt.negative_fraction);
+        std::vector<std::uint64_t> queries(opt.queries);
+        for (std::size_t q = 0; q < opt.queries; ++q) {
+            queries[q] = negative(rng) ? MyBambooFilter::mix64(opt.items + rng() % (opt.items * 16)) : items[order[ranks[q]]];
+        }
+
+        // Warm the front on the first half of the stream, then time the second half on both filters.
+        const std::size_t half = opt.queries / 2;
+        cached.contains_hashed_batch(queries.data(), half, actual.get());
+        cached.reset_stats();
+        const std::vector<std::uint64_t> timed(queries.begin() + static_cast<std::ptrdiff_t>(half), queries.end());
+        const double plain_mops = run(plain, timed, opt.batch, expected.get());
+        const double front_mops = run(cached, timed, opt.batch, actual.get());
+        // The front must answer exactly like its own backing table (the plain filter places items differently).
+        cached.backing().contains_hashed_batch(timed.data(), timed.size(), expected.get());
+        const bool same = std::equal(expected.get(), expected.get() + timed.size(), actual.get());
+        const auto& stats = cached.stats();
+        std::printf("%8.2f %12.2f %12.2f %9.2fx %11.1f%% %10s\n", s, plain_mops, front_mops, front_mops / plain_mops,
+                    100.0 * stats.front_hits / std::max<std::size_t>(1, stats.lookups), same ? "same" : "DIFFER");
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file kmer_bench.cpp
+ * @brief End-to-end k-mer benchmark on a synthetic genome: builds a filter from
+ * all genome k-mers, then queries simulated reads (true positives with
+ * sequencing errors) and random reads (negatives).
+ *
+ * Everything is generated in memory from seeds, so runs at 10^9 k-mers need no
+ * input data; memory is dominated by the filter (see the printed estimate).
+ *
+ * Usage:
+ *   BambooKmerBench [--genome-length N[K|M|G]] [--reads N] [-k K] [--slots N] [--load F]
+ *                   [--partitions N --minimizer M] [--repeat-fraction F] [--seed N]
+ */
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "bamboo_filter.h"
+#include "bench_util.h"
+#include "minimizer_filter.h"
+#include "synthetic_genome.h"
+
+namespace {
+
+struct Options {
+    bench::GenomeOptions genome;
+    std::uint64_t reads = 1'000'000;
+    unsigned k = 31;
+    std::size_t partitions = 0;
+    unsigned minimizer = 15;
+    MyBambooFilter::Config config;
+};
+
+std::uint64_t parse_count(const std::string& text) {
+    std::size_t pos = 0;
+    double value = std::stod(text, &pos);
+    if (pos < text.size()) {
+        switch (text[pos]) {
+            case 'k': case 'K': value *= 1e3; break;
+            case 'm': case 'M': value *= 1e6; break;
+            case 'g': case 'G': value *= 1e9; break;
+            default: throw std::invalid_argument("Bad count suffix in " + text);
+        }
+    }
+    return static_cast<std::uint64_t>(value);
+}
+
+/** @brief Runs the benchmark against either a plain or a minimizer-partitioned filter. */
+template <typename Insert, typename Count, typename Stats>
+void run(const Options& opt, const std::string& genome, Insert insert, Count count, Stats stats) {
+    // Build: feed the genome in 1 Mb windows that overlap by k-1 bases, so every k-mer is seen once.
+    constexpr std::size_t kWindow = 1u << 20;
+    bench::Stopwatch watch;
+    std::size_t kmers = 0;
+    for (std::size_t pos = 0; pos < genome.size(); pos += kWindow) {
+        kmers += insert(std::string_view(genome).substr(pos, kWindow + opt.k - 1));
+    }
+    const double build_seconds = watch.seconds();
+    std::size_t memory = 0, items = 0;
+    stats(memory, items);
+    std::printf("build: %zu k-mers in %.2f s (%.2f M k-mers/s), items=%zu memory=%.1f MiB (%.1f bits/k-mer)\n", kmers,
+                build_seconds, kmers / build_seconds / 1e6, items, memory / (1024.0 * 1024.0),
+                8.0 * memory / std::max<std::size_t>(1, items));
+
+    // Query: simulated reads are generated in blocks outside the timed region.
+    bench::ReadOptions read_options;
+    read_options.seed = opt.genome.seed + 1;
+    bench::ReadSimulator simulator(genome, read_options);
+    bench::Xoshiro256 random_reads(opt.genome.seed + 2);
+    constexpr std::size_t kBlock = 65536;
+    std::vector<std::string> block(kBlock);
+    std::string quality;
+    double true_seconds = 0.0, random_seconds = 0.0;
+    std::size_t true_kmers = 0, true_hits = 0, random_kmers = 0, random_hits = 0;
+    for (std::uint64_t done = 0; done < opt.reads; done += kBlock) {
+        const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(kBlock, opt.reads - done));
+        for (std::size_t i = 0; i < n; ++i) simulator.next(block[i], quality);
+        watch.reset();
+        for (std::size_t i = 0; i < n; ++i) {
+            true_hits += count(block[i]);
+            true_kmers += block[i].size() >= opt.k ? block[i].size() - opt.k + 1 : 0;
+        }
+        true_seconds += watch.seconds();
+
+        for (std::size_t i = 0; i < n; ++i) {
+            block[i].resize(read_options.read_length);
+            for (auto& base : block[i]) base = "ACGT"[random_reads.next() & 3];
+        }
+        watch.reset();
+        for (std::size_t i = 0; i < n; ++i) {
+            random_hits += count(block[i]);
+            random_kmers += block[i].size() - opt.k + 1;
+        }
+        random_seconds += watch.seconds();
+    }
+    std::printf("query simulated reads: %.2f M k-mers/s, k-mer hit rate %.4f (errors lower it)\n",
+                true_kmers / true_seconds / 1e6, static_cast<double>(true_hits) / std::max<std::size_t>(1, true_kmers));
+    std::printf("query random reads:    %.2f M k-mers/s, k-mer false positive rate %.3g\n",
+                random_kmers / random_seconds / 1e6, static_cast<double>(random_hits) / std::max<std::size_t>(1, random_kmers));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--genome-length") opt.genome.length = parse_count(next());
+            else if (arg == "--reads") opt.reads = parse_count(next());
+            else if (arg == "-k") opt.k = static_cast<unsigned>(parse_count(next()));
+            else if (arg == "--slots") opt.config.slots_per_bucket = parse_count(next());
+            else if (arg == "--load") opt.config.load_factor_threshold = std::stof(next());
+            else if (arg == "--partitions") opt.partitions = parse_count(next());
+            else if (arg == "--minimizer") opt.minimizer = static_cast<unsigned>(parse_count(next()));
+            else if (arg == "--repeat-fraction") opt.genome.repeat_fraction = std::stod(next());
+            else if (arg == "--seed") opt.genome.seed = parse_count(next());
+            else throw std::invalid_argument("Unknown argument " + arg);
+        }
+
+        // Pre-size for the genome's k-mers so the build measures steady-state inserts, not rebuilds.
+        const std::size_t total_buckets = static_cast<std::size_t>(
+            opt.genome.length / (opt.config.slots_per_bucket * opt.config.load_factor_threshold)) + 1;
+        std::printf("genome=%llu bases k=%u reads=%llu, filter estimate %.1f GiB\n",
+                    static_cast<unsigned long long>(opt.genome.length), opt.k, static_cast<unsigned long long>(opt.reads),
+                    total_buckets * (sizeof(std::vector<MyBambooFilter::Slot>) +
+                                     opt.config.slots_per_bucket * sizeof(MyBambooFilter::Slot)) / (1024.0 * 1024.0 * 1024.0));
+
+        bench::Stopwatch watch;
+        const std::string genome = bench::generate_genome(opt.genome);
+        std::printf("genome generated in %.2f s\n", watch.seconds());
+
+        if (opt.partitions == 0) {
+            opt.config.initial_num_buckets = total_buckets;
+            MyBambooFilter filter(opt.config);
+            std::printf("\n-- MyBambooFilter --\n");
+            run(opt, genome, [&](std::string_view s) { return filter.insert_kmers(s, opt.k); },
+                [&](std::string_view s) { return filter.count_present_kmers(s, opt.k); },
+                [&](std::size_t& m, std::size_t& n) { m = filter.memoryUsage(); n = filter.size(); });
+        } else {
+            opt.config.initial_num_buckets = total_buckets / opt.partitions + 1;
+            MinimizerPartitionedFilter filter(opt.partitions, opt.k, opt.minimizer, opt.config);
+            std::printf("\n-- MinimizerPartitionedFilter (%zu partitions, m=%u) --\n", opt.partitions, opt.minimizer);
+            run(opt, genome, [&](std::string_view s) { return filter.insert_kmers(s); },
+                [&](std::string_view s) { return filter.count_present_kmers(s); },
+                [&](std::size_t& m, std::size_t& n) { m = filter.memoryUsage(); n = filter.size(); });
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "Usage: BambooKmerBench [--genome-length N[K|M|G]] [--reads N] [-k K] [--slots N] [--load F]\n"
+                     "                       [--partitions N --minimizer M] [--repeat-fraction F] [--seed N]\n";
+        return 1;
+    }
+    return 0;
+}
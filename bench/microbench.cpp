@@ -0,0 +1,293 @@
+/**
+ * @file microbench.cpp
+ * @brief Isolated microbenchmarks for the filter's primitives: key hashing,
+ * fingerprint/index derivation, single-bucket probes, the Cuckoo kick loop and
+ * integer-key lookups against their string-key equivalent.
+ *
+ * Every measurement uses fixed seeds and reports the median of several repeats,
+ * so a change to one primitive yields a directly comparable number.
+ *
+ * Usage:
+ *   BambooMicrobench [--repeats N] [--buckets N] [--slots N]
+ */
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bamboo_filter.h"
+#include "bench_util.h"
+
+/** @brief Forwards to MyBambooFilter internals; declared a friend in bamboo_filter.h. */
+struct MyBambooFilterBenchAccess {
+    static std::uint64_t fnv1a(const void* data, std::size_t len) { return MyBambooFilter::fnv1a_hash_str(data, len); }
+    static std::uint64_t word_mix(const void* data, std::size_t len) { return MyBambooFilter::word_mix_hash(data, len); }
+    static MyBambooFilter::Fp fingerprint(std::uint64_t h) { return MyBambooFilter::fingerprint_from_hash_val(h); }
+    static std::size_t index(std::uint64_t h, std::size_t n) { return MyBambooFilter::index_from_hash_val(h, n); }
+    static std::size_t alt_index(std::size_t i, MyBambooFilter::Fp fp, std::size_t n) {
+        return MyBambooFilter::alt_index_from_fp_val(i, fp, n);
+    }
+    static std::vector<MyBambooFilter::Slot>& bucket(MyBambooFilter& f, std::size_t i) { return f.mutable_bucket(i); }
+    static bool probe(const MyBambooFilter& f, std::size_t i, MyBambooFilter::Fp fp) {
+        for (const auto& slot : f.bucket(i)) {
+            if (slot.first == fp) return true;
+        }
+        return false;
+    }
+    static bool insert_hash(MyBambooFilter& f, std::uint64_t h) {
+        const bool placed = f._attempt_insert_or_kick(h);
+        f.current_items_count_++;
+        return placed;
+    }
+};
+
+using Access = MyBambooFilterBenchAccess;
+
+namespace {
+
+struct Options {
+    std::size_t repeats = 5;
+    std::size_t buckets = 1u << 20;
+    std::size_t slots = 4;
+};
+
+std::vector<std::uint64_t> random_hashes(std::size_t count, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::uint64_t> hashes(count);
+    for (auto& h : hashes) h = rng();
+    return hashes;
+}
+
+/** @brief Runs `body` `repeats` times and returns the median nanoseconds per operation. */
+template <typename Body>
+double median_ns_per_op(std::size_t repeats, std::size_t ops, Body body) {
+    std::vector<double> samples;
+    body(); // Warm-up
+    for (std::size_t r = 0; r < repeats; ++r) {
+        bench::Stopwatch watch;
+        body();
+        samples.push_back(watch.seconds() * 1e9 / ops);
+    }
+    return bench::percentile(samples, 50.0);
+}
+
+void bench_hash(const Options& opt) {
+    std::printf("\n== Key hashing ==\n%8s %12s %10s %12s %10s\n", "key len", "fnv1a ns", "fnv1a GB/s", "word_mix ns", "wm GB/s");
+    for (std::size_t len : {4, 8, 16, 32, 64, 128, 256, 1024}) {
+        const std::size_t num_keys = 4096;
+        std::mt19937_64 rng(len);
+        std::vector<std::string> keys(num_keys);
+        for (auto& key : keys) {
+            key.resize(len);
+            for (auto& c : key) c = static_cast<char>('A' + rng() % 26);
+        }
+        const std::size_t rounds = std::max<std::size_t>(1, (1u << 24) / (num_keys * len));
+        const std::size_t ops = rounds * num_keys;
+
+        const double fnv_ns = median_ns_per_op(opt.repeats, ops, [&] {
+            std::uint64_t acc = 0;
+            for (std::size_t r = 0; r < rounds; ++r)
+                for (const auto& key : keys) acc ^= Access::fnv1a(key.data(), key.size());
+            bench::consume(acc);
+        });
+        const double wm_ns = median_ns_per_op(opt.repeats, ops, [&] {
+            std::uint64_t acc = 0;
+            for (std::size_t r = 0; r < rounds; ++r)
+                for (const auto& key : keys) acc ^= Access::word_mix(key.data(), key.size());
+            bench::consume(acc);
+        });
+        std::printf("%8zu %12.2f %10.2f %12.2f %10.2f\n", len, fnv_ns, len / fnv_ns, wm_ns, len / wm_ns);
+    }
+}
+
+void bench_index(const Options& opt) {
+    const std::vector<std::uint64_t> hashes = random_hashes(1u << 16, 7);
+    const std::size_t rounds = 64;
+    const std::size_t ops = rounds * hashes.size();
+    const std::size_t n = opt.buckets;
+
+    const double fp_ns = median_ns_per_op(opt.repeats, ops, [&] {
+        std::uint64_t acc = 0;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::uint64_t h : hashes) acc += Access::fingerprint(h ^ r);
+        bench::consume(acc);
+    });
+    const double idx_ns = median_ns_per_op(opt.repeats, ops, [&] {
+        std::uint64_t acc = 0;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::uint64_t h : hashes) acc += Access::index(h ^ r, n);
+        bench::consume(acc);
+    });
+    const double all_ns = median_ns_per_op(opt.repeats, ops, [&] {
+        std::uint64_t acc = 0;
+        for (std::size_t r = 0; r < rounds; ++r) {
+            for (std::uint64_t h : hashes) {
+                const auto fp = Access::fingerprint(h ^ r);
+                const std::size_t i1 = Access::index(h ^ r, n);
+                acc += Access::alt_index(i1, fp, n);
+            }
+        }
+        bench::consume(acc);
+    });
+    std::printf("\n== Fingerprint and index derivation (%zu buckets) ==\n", n);
+    std::printf("%-44s %8.2f ns\n", "fingerprint_from_hash_val", fp_ns);
+    std::printf("%-44s %8.2f ns\n", "index_from_hash_val", idx_ns);
+    std::printf("%-44s %8.2f ns\n", "fingerprint + index + alt_index_from_fp_val", all_ns);
+}
+
+void bench_probe(const Options& opt) {
+    std::printf("\n== Single-bucket probe (%zu buckets, random buckets) ==\n", opt.buckets);
+    std::printf("%10s %10s %10s\n", "occupancy", "miss ns", "hit ns");
+    const std::vector<std::uint64_t> queries = random_hashes(1u << 20, 11);
+    for (std::size_t occupancy = 0; occupancy <= opt.slots; ++occupancy) {
+        MyBambooFilter filter(opt.buckets, opt.slots, 2.0f, 0);
+        // Fingerprint 0 never comes out of fingerprint_from_hash_val, so it is a guaranteed miss;
+        // fingerprint 1 sits in the last occupied slot, so a hit scans the whole bucket too.
+        for (std::size_t b = 0; b < opt.buckets; ++b) {
+            auto& bucket = Access::bucket(filter, b);
+            for (std::size_t s = 0; s < occupancy; ++s) bucket.push_back({static_cast<MyBambooFilter::Fp>(occupancy - s), b});
+        }
+        const double miss_ns = median_ns_per_op(opt.repeats, queries.size(), [&] {
+            std::size_t found = 0;
+            for (std::uint64_t q : queries) found += Access::probe(filter, q % opt.buckets, 0);
+            bench::consume(found);
+        });
+        double hit_ns = 0.0;
+        if (occupancy > 0) {
+            hit_ns = median_ns_per_op(opt.repeats, queries.size(), [&] {
+                std::size_t found = 0;
+                for (std::uint64_t q : queries) found += Access::probe(filter, q % opt.buckets, 1);
+                bench::consume(found);
+            });
+        }
+        std::printf("%10zu %10.2f %10.2f\n", occupancy, miss_ns, hit_ns);
+    }
+}
+
+void bench_kick(const Options& opt) {
+    std::printf("\n== Insert / kick loop near target load (%zu buckets x %zu slots, 500 kicks) ==\n", opt.buckets, opt.slots);
+    std::printf("%8s %12s %12s\n", "load", "ns/insert", "stash rate");
+    const std::size_t total_slots = opt.buckets * opt.slots;
+    const std::size_t batch = std::max<std::size_t>(1, total_slots / 200); // 0.5% of the table
+    for (double load : {0.80, 0.90, 0.95, 0.98}) {
+        std::vector<double> samples;
+        std::size_t stashed = 0;
+        for (std::size_t r = 0; r < opt.repeats; ++r) {
+            MyBambooFilter::ExpansionPolicy no_pressure_expansion;
+            no_pressure_expansion.max_kick_failures = 0;
+            no_pressure_expansion.max_stash_fraction = 0.0f;
+            MyBambooFilter filter(opt.buckets, opt.slots, 2.0f, 500, no_pressure_expansion);
+            const std::vector<std::uint64_t> fill = random_hashes(static_cast<std::size_t>(load * total_slots), 100 + r);
+            for (std::uint64_t h : fill) Access::insert_hash(filter, h);
+            const std::vector<std::uint64_t> extra = random_hashes(batch, 200 + r);
+
+            bench::Stopwatch watch;
+            for (std::uint64_t h : extra) stashed += !Access::insert_hash(filter, h);
+            samples.push_back(watch.seconds() * 1e9 / batch);
+        }
+        std::printf("%7.0f%% %12.1f %12.4f\n", load * 100, bench::percentile(samples, 50.0),
+                    static_cast<double>(stashed) / (batch * opt.repeats));
+    }
+}
+
+void bench_integer_keys(const Options& opt) {
+    std::printf("\n== Integer keys vs decimal string keys (%zu buckets x %zu slots, half full) ==\n", opt.buckets, opt.slots);
+    const std::size_t n = opt.buckets * opt.slots / 2;
+    const std::vector<std::uint64_t> ids = random_hashes(n, 21);
+    std::vector<std::string> strings;
+    strings.reserve(n);
+    for (std::uint64_t id : ids) strings.push_back(std::to_string(id));
+
+    MyBambooFilter int_filter(opt.buckets, opt.slots, 0.95f, 500);
+    MyBambooFilter str_filter(opt.buckets, opt.slots, 0.95f, 500);
+    int_filter.insert_batch(ids.data(), ids.size());
+    for (const auto& key : strings) str_filter.insert(key);
+
+    std::unique_ptr<bool[]> results(new bool[n]);
+    const double str_ns = median_ns_per_op(opt.repeats, n, [&] {
+        std::size_t found = 0;
+        for (const auto& key : strings) found += str_filter.contains(key);
+        bench::consume(found);
+    });
+    const double int_ns = median_ns_per_op(opt.repeats, n, [&] {
+        std::size_t found = 0;
+        for (std::uint64_t id : ids) found += int_filter.contains(id);
+        bench::consume(found);
+    });
+    const double batch_ns = median_ns_per_op(opt.repeats, n, [&] {
+        int_filter.contains_batch(ids.data(), ids.size(), results.get());
+        bench::consume(static_cast<std::size_t>(results[n / 2]));
+    });
+    std::printf("%-44s %8.2f ns\n", "contains(std::string)", str_ns);
+    std::printf("%-44s %8.2f ns\n", "contains(std::uint64_t)", int_ns);
+    std::printf("%-44s %8.2f ns\n", "contains_batch(const std::uint64_t*)", batch_ns);
+}
+
+void bench_batch_order(const Options& opt) {
+    std::printf("\n== Batched lookups: input order vs bucket-sorted (%zu buckets x %zu slots, half full) ==\n",
+                opt.buckets, opt.slots);
+    std::printf("%-12s %10s %12s %12s %10s\n", "alternates", "batch", "input ns", "sorted ns", "speedup");
+    const std::vector<std::uint64_t> fill = random_hashes(opt.buckets * opt.slots / 2, 31);
+    // Half of the queries hit, half miss.
+    const std::size_t total = std::max<std::size_t>(1u << 22, opt.buckets);
+    std::vector<std::uint64_t> queries = random_hashes(total, 32);
+    for (std::size_t i = 0; i < total; i += 2) queries[i] = fill[queries[i] % fill.size()];
+    std::unique_ptr<bool[]> results(new bool[total]);
+
+    for (std::size_t window : {std::size_t{0}, std::size_t{4096}}) {
+        MyBambooFilter::Config config;
+        config.initial_num_buckets = opt.buckets;
+        config.slots_per_bucket = opt.slots;
+        config.alternate_window_bytes = window;
+        MyBambooFilter filter(config);
+        filter.insert_hashed_batch(fill.data(), fill.size());
+        std::vector<std::size_t> batches{opt.buckets / 4, opt.buckets};
+        if (total != opt.buckets) batches.push_back(total);
+        for (std::size_t batch : batches) {
+            if (batch == 0) continue;
+            auto run = [&](MyBambooFilter::BatchOrder order) {
+                return median_ns_per_op(opt.repeats, total, [&] {
+                    for (std::size_t base = 0; base < total; base += batch) {
+                        filter.contains_hashed_batch(queries.data() + base, std::min(batch, total - base),
+                                                     results.get() + base, order);
+                    }
+                    bench::consume(static_cast<std::size_t>(results[total / 2]));
+                });
+            };
+            const double input_ns = run(MyBambooFilter::BatchOrder::Input);
+            const double sorted_ns = run(MyBambooFilter::BatchOrder::BucketSorted);
+            std::printf("%-12s %10zu %12.2f %12.2f %9.2fx\n", window == 0 ? "table-wide" : "4 KiB window", batch,
+                        input_ns, sorted_ns, input_ns / sorted_ns);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--repeats") opt.repeats = std::max(1, std::stoi(argv[++i]));
+        else if (i + 1 < argc && arg == "--buckets") opt.buckets = std::stoull(argv[++i]);
+        else if (i + 1 < argc && arg == "--slots") opt.slots = std::stoull(argv[++i]);
+        else {
+            std::cerr << "Usage: BambooMicrobench [--repeats N] [--buckets N] [--slots N]\n";
+            return 1;
+        }
+    }
+    if (opt.buckets == 0 || opt.slots == 0) {
+        std::cerr << "Buckets and slots must be greater than 0.\n";
+        return 1;
+    }
+
+    bench_hash(opt);
+    bench_index(opt);
+    bench_probe(opt);
+    bench_kick(opt);
+    bench_integer_keys(opt);
+    bench_batch_order(opt);
+    return 0;
+}
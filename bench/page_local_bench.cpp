@@ -0,0 +1,143 @@
+/**
+ * @file page_local_bench.cpp
+ * @brief Compares table-wide alternate buckets against alternates kept in the same
+ * 4 KiB or 2 MiB window as the primary bucket (Config::alternate_window_bytes).
+ *
+ * For each window the table is filled with random hashes at a fixed size until the
+ * first kick chain fails, which gives the achievable load factor. At that load the
+ * benchmark measures the false positive rate and the time per positive and negative
+ * lookup through contains_hashed_batch(). Use a table well beyond the TLB reach (the
+ * default is about 2^22 buckets) so the page translation cost shows.
+ *
+ * Usage:
+ *   BambooPageLocalBench [--buckets N] [--slots N] [--fingerprint-bits N] [--queries N] [--repeats N]
+ */
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bamboo_filter.h"
+#include "bench_util.h"
+
+/** @brief Forwards to MyBambooFilter internals; declared a friend in bamboo_filter.h. */
+struct MyBambooFilterBenchAccess {
+    static bool insert_hash(MyBambooFilter& f, std::uint64_t h) {
+        const bool placed = f._attempt_insert_or_kick(h);
+        f.current_items_count_++;
+        return placed;
+    }
+};
+
+using Access = MyBambooFilterBenchAccess;
+
+namespace {
+
+struct Options {
+    std::size_t buckets = 1u << 22;
+    std::size_t slots = 4;
+    unsigned fingerprint_bits = 16;
+    std::size_t queries = 1u << 22;
+    std::size_t repeats = 3;
+};
+
+struct Sample {
+    std::size_t window_buckets;
+    double max_load;
+    double insert_ns;
+    double fpr;
+    double positive_ns;
+    double negative_ns;
+};
+
+Sample run_once(const Options& opt, std::size_t window_bytes, std::uint64_t seed) {
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = opt.buckets;
+    config.slots_per_bucket = opt.slots;
+    config.fingerprint_bits = opt.fingerprint_bits;
+    config.load_factor_threshold = 2.0f; // The table never grows; the fill stops at the first failed kick chain
+    config.alternate_window_bytes = window_bytes;
+    MyBambooFilter filter(config);
+
+    std::mt19937_64 rng(seed);
+    std::vector<std::uint64_t> inserted;
+    inserted.reserve(opt.buckets * opt.slots);
+    bench::Stopwatch watch;
+    for (;;) {
+        const std::uint64_t h = rng();
+        inserted.push_back(h);
+        if (!Access::insert_hash(filter, h)) break;
+    }
+    Sample sample{};
+    sample.window_buckets = filter.alternate_window_buckets();
+    sample.insert_ns = watch.seconds() * 1e9 / inserted.size();
+    sample.max_load = static_cast<double>(inserted.size() - 1) / (opt.buckets * opt.slots);
+
+    std::vector<std::uint64_t> positives(opt.queries), negatives(opt.queries);
+    for (auto& h : positives) h = inserted[rng() % inserted.size()];
+    for (auto& h : negatives) h = rng(); // Collides with an inserted hash with probability ~2^-40
+    std::unique_ptr<bool[]> results(new bool[opt.queries]);
+
+    watch.reset();
+    filter.contains_hashed_batch(positives.data(), positives.size(), results.get());
+    sample.positive_ns = watch.seconds() * 1e9 / opt.queries;
+
+    watch.reset();
+    filter.contains_hashed_batch(negatives.data(), negatives.size(), results.get());
+    sample.negative_ns = watch.seconds() * 1e9 / opt.queries;
+    std::size_t false_positives = 0;
+    for (std::size_t i = 0; i < opt.queries; ++i) false_positives += results[i];
+    sample.fpr = static_cast<double>(false_positives) / opt.queries;
+    return sample;
+}
+
+void usage() {
+    std::cerr << "Usage: BambooPageLocalBench [--buckets N] [--slots N] [--fingerprint-bits N] [--queries N] [--repeats N]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (arg == "--buckets") opt.buckets = std::stoull(argv[++i]);
+        else if (arg == "--slots") opt.slots = std::stoull(argv[++i]);
+        else if (arg == "--fingerprint-bits") opt.fingerprint_bits = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--queries") opt.queries = std::stoull(argv[++i]);
+        else if (arg == "--repeats") opt.repeats = std::max<std::size_t>(1, std::stoull(argv[++i]));
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::printf("%zu buckets x %zu slots, %u-bit fingerprints, %zu queries, median of %zu runs\n", opt.buckets,
+                opt.slots, opt.fingerprint_bits, opt.queries, opt.repeats);
+    std::printf("%-8s %10s %10s %12s %12s %12s %12s\n", "window", "buckets", "max load", "insert ns", "FPR",
+                "hit ns", "miss ns");
+    const std::pair<const char*, std::size_t> windows[] = {
+        {"table", 0}, {"4 KiB", 4096}, {"64 KiB", 64 * 1024}, {"2 MiB", 2 * 1024 * 1024}};
+    for (const auto& [label, bytes] : windows) {
+        std::vector<double> load, insert_ns, fpr, positive_ns, negative_ns;
+        std::size_t window_buckets = 0;
+        for (std::size_t r = 0; r < opt.repeats; ++r) {
+            const Sample s = run_once(opt, bytes, 1000 + r);
+            window_buckets = s.window_buckets;
+            load.push_back(s.max_load);
+            insert_ns.push_back(s.insert_ns);
+            fpr.push_back(s.fpr);
+            positive_ns.push_back(s.positive_ns);
+            negative_ns.push_back(s.negative_ns);
+        }
+        std::printf("%-8s %10zu %10.4f %12.1f %12.3g %12.1f %12.1f\n", label, window_buckets,
+                    bench::percentile(load, 50.0), bench::percentile(insert_ns, 50.0), bench::percentile(fpr, 50.0),
+                    bench::percentile(positive_ns, 50.0), bench::percentile(negative_ns, 50.0));
+    }
+    return 0;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file pareto_bench.cpp
+ * @brief Places filter backends and configurations on one memory / FPR / throughput map
+ * for a fixed item count, and marks the Pareto frontier.
+ *
+ * Backends:
+ *   bamboo         MyBambooFilter (bucket vectors of 16-byte slots)
+ *   bamboo-page4k  MyBambooFilter with alternate buckets kept in the same 4 KiB window
+ *   shm            SharedMemoryBambooFilter (flat array of 16-bit fingerprints)
+ *
+ * Every backend is swept over fingerprint bits, slots per bucket and target load; the
+ * table is sized so that --items items reach the target load. The report gives, per run:
+ *
+ *   load        stored items divided by table slots
+ *   skipped     items accepted but not stored: MyBambooFilter drops an item whose fingerprint
+ *               already sits in one of its buckets
+ *   bits/item   memoryUsage() in bits divided by the stored item count, i.e. what the design costs today
+ *   fp bits     fingerprint bits times table slots divided by the stored item count, i.e. what a
+ *               bit-packed table of the same geometry would cost
+ *   bound       log2(1 / FPR), the fewest bits per item any filter with this FPR can use
+ *               (0 if no false positive was seen)
+ *   FPR, insert and lookup throughput (pre-hashed items, one at a time)
+ *
+ * The frontier is taken over bits/item, FPR, insert and lookup throughput. A shm run
+ * whose table fills up before all items are inserted is reported as failed and left off
+ * the frontier. shm tables have a power-of-two bucket count, so target loads that round
+ * to the same table are run once; MyBambooFilter may grow past its target when kicks
+ * fail. The load column shows the load actually reached.
+ *
+ * Usage:
+ *   BambooParetoBench [--items N] [--queries N] [--quick] [--csv]
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "bamboo_filter.h"
+#include "bench_util.h"
+#include "shm_filter.h"
+
+namespace {
+
+struct Options {
+    std::size_t items = 1u << 20;
+    std::size_t queries = 1u << 21;
+    bool quick = false;
+    bool csv = false;
+};
+
+enum class Backend { Bamboo, BambooPage4k, Shm };
+
+const char* backend_name(Backend backend) {
+    switch (backend) {
+        case Backend::Bamboo: return "bamboo";
+        case Backend::BambooPage4k: return "bamboo-page4k";
+        case Backend::Shm: return "shm";
+    }
+    return "?";
+}
+
+struct Result {
+    Backend backend;
+    unsigned fingerprint_bits;
+    std::size_t slots_per_bucket;
+    float target_load;
+    double load;           ///< Stored items divided by table slots after inserting
+    std::size_t skipped;   ///< Items accepted but not stored, e.g. fingerprint collisions
+    bool failed;           ///< Some items did not fit
+    double bits_per_item;
+    double fp_bits_per_item;
+    double fpr;
+    double insert_mops;
+    double lookup_mops;
+};
+
+/** @brief Inserts one item; returns false if the table is full. */
+bool insert_item(MyBambooFilter& filter, std::uint64_t h) {
+    filter.insert_hashed(h); // Grows or stashes instead of failing
+    return true;
+}
+
+bool insert_item(SharedMemoryBambooFilter& filter, std::uint64_t h) {
+    return filter.insert_hashed(h);
+}
+
+/**
+ * @brief Inserts `items`, then answers `queries` (alternating present and absent items) and
+ * fills in the measured part of `result`.
+ */
+template <typename Filter>
+void measure(Filter& filter, const std::vector<std::uint64_t>& items, const std::vector<std::uint64_t>& queries,
+             Result& result) {
+    bench::Stopwatch watch;
+    std::size_t inserted = 0;
+    for (std::uint64_t h : items) inserted += insert_item(filter, h);
+    result.insert_mops = items.size() / watch.seconds() / 1e6;
+    result.failed = inserted != items.size();
+    result.skipped = inserted - filter.size();
+
+    std::size_t hits = 0, false_positives = 0;
+    watch.reset();
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        const bool found = filter.contains_hashed(queries[i]);
+        hits += found;
+        if (i & 1) false_positives += found;
+    }
+    result.lookup_mops = queries.size() / watch.seconds() / 1e6;
+    bench::consume(hits);
+    result.fpr = static_cast<double>(false_positives) / std::max<std::size_t>(1, queries.size() / 2);
+    result.bits_per_item = 8.0 * filter.memoryUsage() / std::max<std::size_t>(1, filter.size());
+}
+
+Result evaluate(Backend backend, unsigned fp_bits, std::size_t slots, float load,
+                const std::vector<std::uint64_t>& items, const std::vector<std::uint64_t>& queries) {
+    Result result{backend, fp_bits, slots, load, 0.0, 0, false, 0.0, 0.0, 0.0, 0.0, 0.0};
+    const std::size_t buckets = static_cast<std::size_t>(std::ceil(items.size() / (slots * static_cast<double>(load))));
+    std::size_t table_slots = 0, stored = 0;
+    if (backend == Backend::Shm) {
+        SharedMemoryBambooFilter::Options options;
+        options.num_buckets = buckets;
+        options.slots_per_bucket = slots;
+        options.fingerprint_bits = fp_bits;
+        const std::string name = "/bamboo-pareto-" + std::to_string(getpid());
+        SharedMemoryBambooFilter filter = SharedMemoryBambooFilter::create(name, options);
+        SharedMemoryBambooFilter::unlink(name); // The mapping stays valid until the filter is destroyed
+        measure(filter, items, queries, result);
+        table_slots = filter.capacity_buckets() * slots;
+        stored = filter.size();
+    } else {
+        MyBambooFilter::Config config;
+        config.initial_num_buckets = buckets + 1; // Stay just below the rebuild threshold
+        config.slots_per_bucket = slots;
+        config.fingerprint_bits = fp_bits;
+        // The threshold must stay above the target load, or the last inserts would trigger a rebuild.
+        config.load_factor_threshold = std::min(1.0f, load + 0.02f);
+        if (backend == Backend::BambooPage4k) config.alternate_window_bytes = 4096;
+        MyBambooFilter filter(config);
+        measure(filter, items, queries, result);
+        table_slots = filter.capacity_buckets() * slots;
+        stored = filter.size();
+    }
+    result.load = static_cast<double>(stored) / table_slots;
+    result.fp_bits_per_item = static_cast<double>(fp_bits) * table_slots / std::max<std::size_t>(1, stored);
+    return result;
+}
+
+std::size_t round_up_pow2(std::size_t x) {
+    std::size_t p = 1;
+    while (p < x) p <<= 1;
+    return p;
+}
+
+void usage() {
+    std::cerr << "Usage: BambooParetoBench [--items N] [--queries N] [--quick] [--csv]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--quick") opt.quick = true;
+        else if (arg == "--csv") opt.csv = true;
+        else if (i + 1 < argc && arg == "--items") opt.items = std::max<std::size_t>(1, std::stoull(argv[++i]));
+        else if (i + 1 < argc && arg == "--queries") opt.queries = std::max<std::size_t>(2, std::stoull(argv[++i]));
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    // Odd queries ask for items that were never inserted; even ones ask for inserted items.
+    std::vector<std::uint64_t> items(opt.items);
+    for (std::size_t i = 0; i < opt.items; ++i) items[i] = MyBambooFilter::mix64(i);
+    std::vector<std::uint64_t> queries(opt.queries);
+    for (std::size_t i = 0; i < opt.queries; ++i) {
+        queries[i] = (i & 1) ? MyBambooFilter::mix64(opt.items + i) : items[MyBambooFilter::mix64(i) % opt.items];
+    }
+
+    const std::vector<Backend> backends = {Backend::Bamboo, Backend::BambooPage4k, Backend::Shm};
+    const std::vector<unsigned> fp_options = opt.quick ? std::vector<unsigned>{8, 16} : std::vector<unsigned>{8, 12, 16};
+    const std::vector<std::size_t> slot_options = opt.quick ? std::vector<std::size_t>{4} : std::vector<std::size_t>{2, 4, 8};
+    const std::vector<float> load_options = opt.quick ? std::vector<float>{0.9f} : std::vector<float>{0.8f, 0.9f, 0.95f};
+
+    std::vector<Result> results;
+    try {
+        for (Backend backend : backends) {
+            for (unsigned fp_bits : fp_options) {
+                for (std::size_t slots : slot_options) {
+                    std::size_t previous_buckets = 0;
+                    for (float load : load_options) {
+                        // shm rounds the bucket count up to a power of two, so several targets can share a table.
+                        const std::size_t buckets = static_cast<std::size_t>(std::ceil(opt.items / (slots * static_cast<double>(load))));
+                        if (backend == Backend::Shm && round_up_pow2(buckets) == previous_buckets) continue;
+                        previous_buckets = round_up_pow2(buckets);
+                        results.push_back(evaluate(backend, fp_bits, slots, load, items, queries));
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    // Failed runs get the worst possible point, so they never dominate or join the frontier.
+    std::vector<std::vector<double>> points;
+    for (const auto& r : results) {
+        if (r.failed) points.push_back({HUGE_VAL, 1.0, 0.0, 0.0});
+        else points.push_back({r.bits_per_item, r.fpr, r.insert_mops, r.lookup_mops});
+    }
+    std::vector<bool> on_front = bench::pareto_front(points, {false, false, true, true});
+    for (std::size_t i = 0; i < results.size(); ++i) on_front[i] = on_front[i] && !results[i].failed;
+
+    if (opt.csv) {
+        std::cout << "pareto,backend,fingerprint_bits,slots_per_bucket,target_load,load,skipped,failed,bits_per_item,"
+                     "fp_bits_per_item,bound_bits_per_item,fpr,insert_mops,lookup_mops\n";
+    } else {
+        std::printf("%zu items, %zu queries (half absent); * marks the Pareto frontier\n\n", opt.items, opt.queries);
+        std::printf("%-1s %-13s %3s %5s %6s %6s %7s %9s %8s %6s %10s %9s %9s\n", "", "backend", "fp", "slots",
+                    "target", "load", "skipped", "bits/item", "fp bits", "bound", "fpr", "ins Mop/s", "qry Mop/s");
+    }
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        const double bound = r.fpr > 0.0 ? std::log2(1.0 / r.fpr) : 0.0;
+        if (opt.csv) {
+            std::printf("%d,%s,%u,%zu,%.2f,%.4f,%zu,%d,%.2f,%.2f,%.2f,%.6g,%.3f,%.3f\n", on_front[i] ? 1 : 0,
+                        backend_name(r.backend), r.fingerprint_bits, r.slots_per_bucket, r.target_load, r.load,
+                        r.skipped, r.failed ? 1 : 0, r.bits_per_item, r.fp_bits_per_item, bound, r.fpr, r.insert_mops,
+                        r.lookup_mops);
+        } else if (r.failed) {
+            std::printf("%-1s %-13s %3u %5zu %6.2f %6.3f %7zu %9s\n", "", backend_name(r.backend),
+                        r.fingerprint_bits, r.slots_per_bucket, r.target_load, r.load, r.skipped, "full");
+        } else {
+            std::printf("%-1s %-13s %3u %5zu %6.2f %6.3f %7zu %9.2f %8.2f %6.2f %10.3g %9.2f %9.2f\n",
+                        on_front[i] ? "*" : "", backend_name(r.backend), r.fingerprint_bits, r.slots_per_bucket,
+                        r.target_load, r.load, r.skipped, r.bits_per_item, r.fp_bits_per_item, bound, r.fpr, r.insert_mops, r.lookup_mops);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,191 @@
+#ifndef BAMBOO_SYNTHETIC_GENOME_H
+#define BAMBOO_SYNTHETIC_GENOME_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file synthetic_genome.h
+ * @brief Reproducible random reference genomes with repeat content and
+ * simulated sequencing reads with a position-dependent error profile.
+ *
+ * Everything is driven by explicit seeds, so the same options always produce
+ * the same genome and reads on any machine, without shipping real data.
+ */
+namespace bench {
+
+/** @brief xoshiro256** generator: fast, 64-bit output, fully determined by its seed. */
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(std::uint64_t seed) {
+        for (auto& word : state_) { // Seed the state with splitmix64, as recommended by the authors
+            std::uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    std::uint64_t next() {
+        const std::uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        const std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    /** @brief Uniform double in [0, 1). */
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    /** @brief Uniform integer in [0, bound). */
+    std::uint64_t below(std::uint64_t bound) { return static_cast<std::uint64_t>(uniform() * bound); }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    std::uint64_t state_[4];
+};
+
+/** @brief Parameters of a synthetic reference genome. */
+struct GenomeOptions {
+    std::uint64_t length = 10'000'000;
+    /** @brief Fraction of the genome covered by copies of repeat families. */
+    double repeat_fraction = 0.1;
+    std::size_t repeat_families = 100;
+    /** @brief Length of each repeat family consensus. */
+    std::size_t repeat_length = 300;
+    /** @brief Per-base substitution rate between a repeat copy and its consensus. */
+    double repeat_divergence = 0.02;
+    double gc_content = 0.5;
+    std::uint64_t seed = 1;
+};
+
+/** @brief Parameters of simulated reads. */
+struct ReadOptions {
+    std::size_t read_length = 150;
+    /** @brief Substitution rate at the start of a read; it rises linearly to 3x at the end. */
+    double substitution_rate = 0.002;
+    double insertion_rate = 0.0001;
+    double deletion_rate = 0.0001;
+    double n_rate = 0.0001;
+    std::uint64_t seed = 2;
+};
+
+namespace detail {
+inline char random_base(Xoshiro256& rng, double gc_content) {
+    const double u = rng.uniform();
+    if (u < gc_content) return u < gc_content / 2 ? 'C' : 'G';
+    return u < gc_content + (1 - gc_content) / 2 ? 'A' : 'T';
+}
+
+inline char substitute(Xoshiro256& rng, char base) {
+    static const char others[4][3] = {{'C', 'G', 'T'}, {'A', 'G', 'T'}, {'A', 'C', 'T'}, {'A', 'C', 'G'}};
+    const int index = base == 'A' ? 0 : base == 'C' ? 1 : base == 'G' ? 2 : 3;
+    return others[index][rng.below(3)];
+}
+} // namespace detail
+
+/**
+ * @brief Generates a random genome with interspersed, diverged repeat copies.
+ * @param options Genome parameters.
+ * @return The genome as an upper-case ACGT string.
+ */
+inline std::string generate_genome(const GenomeOptions& options) {
+    Xoshiro256 rng(options.seed);
+    std::string genome(options.length, 'A');
+    if (options.gc_content == 0.5) {
+        // Fast path: 32 uniform bases per 64-bit draw.
+        for (std::uint64_t i = 0; i < options.length;) {
+            std::uint64_t bits = rng.next();
+            for (int j = 0; j < 32 && i < options.length; ++j, ++i, bits >>= 2) genome[i] = "ACGT"[bits & 3];
+        }
+    } else {
+        for (auto& base : genome) base = detail::random_base(rng, options.gc_content);
+    }
+
+    if (options.repeat_families == 0 || options.repeat_length == 0 || options.length <= options.repeat_length) {
+        return genome;
+    }
+    std::vector<std::string> families(options.repeat_families);
+    for (auto& family : families) {
+        family.resize(options.repeat_length);
+        for (auto& base : family) base = detail::random_base(rng, options.gc_content);
+    }
+    const std::uint64_t repeat_bases = static_cast<std::uint64_t>(options.repeat_fraction * options.length);
+    for (std::uint64_t placed = 0; placed < repeat_bases; placed += options.repeat_length) {
+        const std::string& family = families[rng.below(families.size())];
+        const std::uint64_t pos = rng.below(options.length - options.repeat_length);
+        for (std::size_t j = 0; j < family.size(); ++j) {
+            genome[pos + j] = rng.uniform() < options.repeat_divergence ? detail::substitute(rng, family[j]) : family[j];
+        }
+    }
+    return genome;
+}
+
+/** @brief Samples reads from a genome, from either strand, with sequencing errors. */
+class ReadSimulator {
+public:
+    ReadSimulator(const std::string& genome, const ReadOptions& options)
+      : genome_(genome), options_(options), rng_(options.seed) {}
+
+    /**
+     * @brief Produces the next read.
+     * @param sequence Receives the read bases.
+     * @param quality Receives Phred+33 qualities matching the error profile.
+     * @return The genome position the read was sampled from.
+     */
+    std::uint64_t next(std::string& sequence, std::string& quality) {
+        const std::size_t len = options_.read_length;
+        // Room for deletions, clamped so [pos, pos + span) always lies inside the genome;
+        // a genome shorter than a read yields shorter reads.
+        const std::uint64_t span = std::min<std::uint64_t>(len + len / 10 + 1, genome_.size());
+        const std::uint64_t pos = rng_.below(genome_.size() > span ? genome_.size() - span : 1);
+        const bool reverse = rng_.next() & 1;
+
+        sequence.clear();
+        quality.clear();
+        std::uint64_t g = 0;
+        while (sequence.size() < len && g < span) { // Both strands read only inside the span
+            char base = genome_[reverse ? pos + span - 1 - g : pos + g];
+            if (reverse) base = base == 'A' ? 'T' : base == 'C' ? 'G' : base == 'G' ? 'C' : 'A';
+            ++g;
+
+            const double sub_rate = options_.substitution_rate * (1.0 + 2.0 * sequence.size() / len);
+            const double u = rng_.uniform();
+            if (u < options_.deletion_rate) continue;
+            if (u < options_.deletion_rate + options_.insertion_rate) {
+                sequence.push_back("ACGT"[rng_.next() & 3]);
+                quality.push_back(phred(sub_rate));
+            }
+            if (sequence.size() == len) break;
+            if (rng_.uniform() < options_.n_rate) {
+                sequence.push_back('N');
+                quality.push_back('#');
+            } else {
+                sequence.push_back(rng_.uniform() < sub_rate ? detail::substitute(rng_, base) : base);
+                quality.push_back(phred(sub_rate));
+            }
+        }
+        return pos;
+    }
+
+private:
+    static char phred(double error_rate) {
+        int q = 0;
+        for (double p = error_rate; p < 1.0 && q < 41; p *= 1.2589254117941673) ++q; // 10^(1/10) per Phred step
+        return static_cast<char>(33 + q);
+    }
+
+    const std::string& genome_;
+    ReadOptions options_;
+    Xoshiro256 rng_;
+};
+
+} // namespace bench
+
+#endif // BAMBOO_SYNTHETIC_GENOME_H
@@ -0,0 +1,300 @@
+/**
+ * @file thread_scaling_bench.cpp
+ * @brief Measures how the thread-safe filter variants scale with the number of threads.
+ *
+ * Variants:
+ *   global-mutex   MyBambooFilter behind one std::mutex (the baseline)
+ *   shared-mutex   MyBambooFilter behind one std::shared_mutex; lookups take it shared
+ *   sharded        independent MyBambooFilters selected by hash, each behind its own mutex
+ *   shm-seqlock    SharedMemoryBambooFilter: lock-free seqlock lookups, inserts behind one mutex
+ *                  (the filter allows a single writer)
+ *
+ * Workloads are insert-only, read-only and mixes of lookups and inserts (50/50, 90/10
+ * and 99/1). Every run starts from a filter prefilled with --prefill items;
+ * half of the lookups ask for prefilled items and half for absent ones. The operations
+ * are split evenly over the threads, which start together after a barrier.
+ *
+ * For each thread count the table reports throughput, scaling efficiency (throughput
+ * divided by thread count times the 1-thread throughput) and the p50 / p99 / p99.9
+ * latency of single operations. Latency is sampled on every --sample-every-th operation,
+ * because reading the clock around every operation would distort short lookups.
+ *
+ * Usage:
+ *   BambooThreadScalingBench [--max-threads N] [--ops N] [--prefill N] [--shards N] [--sample-every N]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "bamboo_filter.h"
+#include "bench_util.h"
+#include "shm_filter.h"
+
+namespace {
+
+struct Options {
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t ops = 1u << 22;
+    std::size_t prefill = 1u << 22;
+    std::size_t shards = 64;
+    std::size_t sample_every = 16;
+};
+
+/** @brief A workload: the share of operations that are lookups (the rest are inserts). */
+struct Workload {
+    const char* name;
+    double lookup_fraction;
+};
+
+constexpr Workload kWorkloads[] = {
+    {"insert-only", 0.0}, {"read-only", 1.0}, {"mixed 50/50", 0.5}, {"mixed 90/10", 0.9}, {"mixed 99/1", 0.99},
+};
+
+MyBambooFilter::Config config_for(std::size_t items) {
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = std::max<std::size_t>(1, static_cast<std::size_t>(items / (4 * 0.9)));
+    return config;
+}
+
+class GlobalMutexFilter {
+public:
+    explicit GlobalMutexFilter(const Options& opt) : filter_(config_for(opt.prefill)) {}
+    void insert(std::uint64_t h) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        filter_.insert_hashed(h);
+    }
+    bool contains(std::uint64_t h) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return filter_.contains_hashed(h);
+    }
+
+private:
+    std::mutex mutex_;
+    MyBambooFilter filter_;
+};
+
+class SharedMutexFilter {
+public:
+    explicit SharedMutexFilter(const Options& opt) : filter_(config_for(opt.prefill)) {}
+    void insert(std::uint64_t h) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        filter_.insert_hashed(h);
+    }
+    bool contains(std::uint64_t h) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return filter_.contains_hashed(h);
+    }
+
+private:
+    std::shared_mutex mutex_;
+    MyBambooFilter filter_;
+};
+
+class ShardedFilter {
+public:
+    explicit ShardedFilter(const Options& opt) : shards_(opt.shards) {
+        // Shards are chosen by a multiplicative hash, so they do not follow the bucket index bits.
+        shift_ = 64 - static_cast<unsigned>(__builtin_ctzll(opt.shards));
+        for (auto& shard : shards_) shard.filter = std::make_unique<MyBambooFilter>(config_for(opt.prefill / opt.shards));
+    }
+    void insert(std::uint64_t h) {
+        Shard& shard = shard_of(h);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.filter->insert_hashed(h);
+    }
+    bool contains(std::uint64_t h) {
+        Shard& shard = shard_of(h);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.filter->contains_hashed(h);
+    }
+
+private:
+    /** @brief One shard on its own cache lines, so neighbouring locks do not share a line. */
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unique_ptr<MyBambooFilter> filter;
+    };
+
+    Shard& shard_of(std::uint64_t h) {
+        return shift_ == 64 ? shards_[0] : shards_[(h * 0x9e3779b97f4a7c15ULL) >> shift_];
+    }
+
+    std::vector<Shard> shards_;
+    unsigned shift_;
+};
+
+class ShmSeqlockFilter {
+public:
+    explicit ShmSeqlockFilter(const Options& opt) : filter_(make(opt)) {}
+    void insert(std::uint64_t h) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        filter_.insert_hashed(h);
+    }
+    bool contains(std::uint64_t h) { return filter_.contains_hashed(h); }
+
+private:
+    static SharedMemoryBambooFilter make(const Options& opt) {
+        // The shared table cannot grow, so it is sized for every insert a run can make.
+        SharedMemoryBambooFilter::Options geometry;
+        geometry.num_buckets = std::max<std::size_t>(1, static_cast<std::size_t>((opt.prefill + opt.ops) / (4 * 0.9)));
+        const std::string name = "/bamboo-scaling-" + std::to_string(getpid());
+        SharedMemoryBambooFilter filter = SharedMemoryBambooFilter::create(name, geometry);
+        SharedMemoryBambooFilter::unlink(name); // The mapping stays valid until the filter is destroyed
+        return filter;
+    }
+
+    std::mutex writer_mutex_;
+    SharedMemoryBambooFilter filter_;
+};
+
+/** @brief One thread's operations, generated before the timed section. */
+struct OpStream {
+    std::vector<std::uint64_t> hashes;
+    std::vector<bool> is_lookup;
+};
+
+struct Result {
+    double mops;
+    double p50_ns, p99_ns, p999_ns;
+};
+
+template <typename Filter>
+Result run(const Options& opt, const Workload& workload, std::size_t threads) {
+    Filter filter(opt);
+    for (std::size_t i = 0; i < opt.prefill; ++i) filter.insert(MyBambooFilter::mix64(i));
+
+    std::vector<OpStream> streams(threads);
+    const std::size_t per_thread = opt.ops / threads;
+    for (std::size_t t = 0; t < threads; ++t) {
+        std::mt19937_64 rng(t + 1);
+        std::bernoulli_distribution lookup(workload.lookup_fraction);
+        OpStream& stream = streams[t];
+        stream.hashes.resize(per_thread);
+        stream.is_lookup.resize(per_thread);
+        for (std::size_t i = 0; i < per_thread; ++i) {
+            stream.is_lookup[i] = lookup(rng);
+            if (!stream.is_lookup[i]) {
+                // Each thread inserts its own fresh keys.
+                stream.hashes[i] = MyBambooFilter::mix64(opt.prefill + opt.ops * (t + 1) + i);
+            } else {
+                const std::uint64_t present = rng() % std::max<std::size_t>(1, opt.prefill);
+                stream.hashes[i] = MyBambooFilter::mix64((rng() & 1) ? present : opt.prefill + opt.ops * (threads + 1) + rng());
+            }
+        }
+    }
+
+    std::vector<std::vector<double>> latencies(threads);
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            const OpStream& stream = streams[t];
+            std::vector<double>& samples = latencies[t];
+            samples.reserve(per_thread / opt.sample_every + 1);
+            std::size_t found = 0;
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (std::size_t i = 0; i < per_thread; ++i) {
+                const bool sampled = i % opt.sample_every == 0;
+                std::chrono::steady_clock::time_point start;
+                if (sampled) start = std::chrono::steady_clock::now();
+                if (stream.is_lookup[i]) found += filter.contains(stream.hashes[i]);
+                else filter.insert(stream.hashes[i]);
+                if (sampled) {
+                    samples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+                }
+            }
+            bench::consume(found);
+        });
+    }
+    while (ready.load() != threads) std::this_thread::yield();
+    bench::Stopwatch watch;
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) worker.join();
+    const double seconds = watch.seconds();
+
+    std::vector<double> all;
+    for (const auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    Result result;
+    result.mops = per_thread * threads / seconds / 1e6;
+    result.p50_ns = bench::percentile(all, 50.0);
+    result.p99_ns = bench::percentile(all, 99.0);
+    result.p999_ns = bench::percentile(all, 99.9);
+    return result;
+}
+
+std::vector<std::size_t> thread_counts(std::size_t max_threads) {
+    std::vector<std::size_t> counts;
+    for (std::size_t t = 1; t < max_threads; t *= 2) counts.push_back(t);
+    counts.push_back(max_threads);
+    return counts;
+}
+
+template <typename Filter>
+void bench_variant(const char* name, const Options& opt) {
+    for (const Workload& workload : kWorkloads) {
+        std::printf("\n%s, %s\n", name, workload.name);
+        std::printf("%8s %12s %12s %10s %10s %10s\n", "threads", "Mops", "efficiency", "p50 ns", "p99 ns", "p99.9 ns");
+        double single = 0.0;
+        for (std::size_t threads : thread_counts(opt.max_threads)) {
+            const Result r = run<Filter>(opt, workload, threads);
+            if (threads == 1) single = r.mops;
+            std::printf("%8zu %12.2f %11.0f%% %10.0f %10.0f %10.0f\n", threads, r.mops,
+                        100.0 * r.mops / (threads * single), r.p50_ns, r.p99_ns, r.p999_ns);
+        }
+    }
+}
+
+void usage() {
+    std::cerr << "Usage: BambooThreadScalingBench [--max-threads N] [--ops N] [--prefill N] [--shards N]\n"
+                 "                                [--sample-every N]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (arg == "--max-threads") opt.max_threads = std::max<std::size_t>(1, std::stoull(argv[++i]));
+        else if (arg == "--ops") opt.ops = std::stoull(argv[++i]);
+        else if (arg == "--prefill") opt.prefill = std::stoull(argv[++i]);
+        else if (arg == "--shards") opt.shards = std::stoull(argv[++i]);
+        else if (arg == "--sample-every") opt.sample_every = std::max<std::size_t>(1, std::stoull(argv[++i]));
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (opt.shards == 0 || (opt.shards & (opt.shards - 1)) != 0) {
+        std::cerr << "--shards must be a power of two\n";
+        return 1;
+    }
+
+    std::printf("%zu prefilled items, %zu operations per run, %zu shards, latency sampled every %zu operations\n",
+                opt.prefill, opt.ops, opt.shards, opt.sample_every);
+    try {
+        bench_variant<GlobalMutexFilter>("global-mutex", opt);
+        bench_variant<SharedMutexFilter>("shared-mutex", opt);
+        bench_variant<ShardedFilter>("sharded", opt);
+        bench_variant<ShmSeqlockFilter>("shm-seqlock", opt);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * @file trace_replay.cpp
+ * @brief Replays a recorded operation trace against MyBambooFilter and reports
+ * throughput and latency percentiles.
+ *
+ * Trace format: one operation per line, whitespace separated:
+ *   <op> <key> [timestamp_ns]
+ * where <op> is one of
+ *   insert | contains | erase                   (I, C, E)   - <key> is hashed with the filter's hash policy
+ *   insert_hash | contains_hash | erase_hash    (IH, CH, EH) - <key> is a pre-computed 64-bit hash in hex
+ * Timestamps are optional; only their differences matter. Empty lines and lines
+ * starting with '#' are ignored.
+ *
+ * Closed-loop mode issues operations back to back. Open-loop mode issues each
+ * operation at its recorded time (scaled by --speed) or at a fixed --rate, and
+ * measures latency from the intended start time, so stalls show up as queueing
+ * delay instead of silently slowing the load down.
+ *
+ * Usage:
+ *   BambooTraceReplay TRACE [--mode closed|open] [--speed X] [--rate OPS]
+ *                     [--buckets N] [--slots N] [--load F] [--kicks N]
+ *                     [--hash fnv1a|fnv1a_mix|word_mix] [--repeats N]
+ */
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bamboo_filter.h"
+#include "bench_util.h"
+
+namespace {
+
+enum class OpType { Insert, Contains, Erase };
+
+struct TraceOp {
+    OpType type;
+    bool prehashed;
+    std::uint64_t hash;     // Valid if prehashed
+    std::string key;        // Valid otherwise
+    std::int64_t timestamp; // -1 if absent
+};
+
+struct Options {
+    std::string trace_path;
+    bool open_loop = false;
+    double speed = 1.0;
+    double rate = 0.0;
+    MyBambooFilter::Config config;
+    std::size_t repeats = 1;
+};
+
+bool parse_op(const std::string& token, OpType& type, bool& prehashed) {
+    static const struct { const char* name; OpType type; bool prehashed; } ops[] = {
+        {"insert", OpType::Insert, false},         {"I", OpType::Insert, false},
+        {"contains", OpType::Contains, false},     {"C", OpType::Contains, false},
+        {"erase", OpType::Erase, false},           {"E", OpType::Erase, false},
+        {"insert_hash", OpType::Insert, true},     {"IH", OpType::Insert, true},
+        {"contains_hash", OpType::Contains, true}, {"CH", OpType::Contains, true},
+        {"erase_hash", OpType::Erase, true},       {"EH", OpType::Erase, true},
+    };
+    for (const auto& op : ops) {
+        if (token == op.name) {
+            type = op.type;
+            prehashed = op.prehashed;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<TraceOp> load_trace(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open trace " + path);
+    std::vector<TraceOp> ops;
+    std::string line;
+    std::size_t line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string op_token, key, ts_token;
+        if (!(fields >> op_token >> key)) {
+            throw std::runtime_error("Malformed trace line " + std::to_string(line_no));
+        }
+        TraceOp op{OpType::Insert, false, 0, {}, -1};
+        if (!parse_op(op_token, op.type, op.prehashed)) {
+            throw std::runtime_error("Unknown operation '" + op_token + "' on line " + std::to_string(line_no));
+        }
+        if (op.prehashed) op.hash = std::stoull(key, nullptr, 16);
+        else op.key = std::move(key);
+        if (fields >> ts_token) op.timestamp = std::stoll(ts_token);
+        ops.push_back(std::move(op));
+    }
+    return ops;
+}
+
+bool apply(MyBambooFilter& filter, const TraceOp& op) {
+    switch (op.type) {
+        case OpType::Insert:
+            if (op.prehashed) filter.insert_hashed(op.hash);
+            else filter.insert(op.key);
+            return true;
+        case OpType::Contains:
+            return op.prehashed ? filter.contains_hashed(op.hash) : filter.contains(op.key);
+        case OpType::Erase:
+            return op.prehashed ? filter.erase_hashed(op.hash) : filter.erase(op.key);
+    }
+    return false;
+}
+
+void print_latencies(const char* label, std::vector<std::uint64_t>& ns) {
+    if (ns.empty()) return;
+    std::printf("%-10s %10zu %9llu %9llu %9llu %9llu %11llu\n", label, ns.size(),
+                static_cast<unsigned long long>(bench::percentile(ns, 50.0)),
+                static_cast<unsigned long long>(bench::percentile(ns, 90.0)),
+                static_cast<unsigned long long>(bench::percentile(ns, 99.0)),
+                static_cast<unsigned long long>(bench::percentile(ns, 99.9)),
+                static_cast<unsigned long long>(*std::max_element(ns.begin(), ns.end())));
+}
+
+void replay(const Options& opt, const std::vector<TraceOp>& ops) {
+    using clock = std::chrono::steady_clock;
+    MyBambooFilter filter(opt.config);
+    std::vector<std::uint64_t> latency[3];
+    for (auto& l : latency) l.reserve(ops.size());
+    std::size_t positives = 0;
+
+    const std::int64_t first_ts = ops.front().timestamp;
+    const clock::time_point start = clock::now();
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        const TraceOp& op = ops[i];
+        clock::time_point issued = clock::now();
+        if (opt.open_loop) {
+            double offset_ns;
+            if (opt.rate > 0.0) offset_ns = i * 1e9 / opt.rate;
+            else offset_ns = static_cast<double>(op.timestamp - first_ts) / opt.speed;
+            const clock::time_point intended = start + std::chrono::nanoseconds(static_cast<std::int64_t>(offset_ns));
+            if (intended > issued) {
+                // Sleep for long gaps, spin for the final stretch to keep the schedule precise.
+                if (intended - issued > std::chrono::microseconds(200)) {
+                    std::this_thread::sleep_until(intended - std::chrono::microseconds(100));
+                }
+                while (clock::now() < intended) {}
+            }
+            issued = intended;
+        }
+        positives += apply(filter, op);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - issued).count();
+        latency[static_cast<int>(op.type)].push_back(static_cast<std::uint64_t>(elapsed));
+    }
+    const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::printf("\nmode=%s ops=%zu time=%.3f s throughput=%.3f Mops/s\n", opt.open_loop ? "open" : "closed",
+                ops.size(), seconds, ops.size() / seconds / 1e6);
+    std::printf("final: items=%zu buckets=%zu load=%.3f stashed=%zu expansions=%zu memory=%zu B true_results=%zu\n",
+                filter.size(), filter.capacity_buckets(), filter.loadFactor(), filter.stashed_items(),
+                filter.expansion_history().size(), filter.memoryUsage(), positives);
+    std::printf("%-10s %10s %9s %9s %9s %9s %11s\n", "latency ns", "count", "p50", "p90", "p99", "p99.9", "max");
+    std::vector<std::uint64_t> all;
+    for (const auto& l : latency) all.insert(all.end(), l.begin(), l.end());
+    print_latencies("insert", latency[static_cast<int>(OpType::Insert)]);
+    print_latencies("contains", latency[static_cast<int>(OpType::Contains)]);
+    print_latencies("erase", latency[static_cast<int>(OpType::Erase)]);
+    print_latencies("all", all);
+}
+
+void usage() {
+    std::cerr << "Usage: BambooTraceReplay TRACE [--mode closed|open] [--speed X] [--rate OPS]\n"
+                 "                         [--buckets N] [--slots N] [--load F] [--kicks N]\n"
+                 "                         [--hash fnv1a|fnv1a_mix|word_mix] [--repeats N]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--mode") {
+                const std::string mode = next();
+                if (mode != "open" && mode != "closed") throw std::invalid_argument("Unknown mode " + mode);
+                opt.open_loop = mode == "open";
+            } else if (arg == "--speed") opt.speed = std::stod(next());
+            else if (arg == "--rate") opt.rate = std::stod(next());
+            else if (arg == "--buckets") opt.config.initial_num_buckets = std::stoull(next());
+            else if (arg == "--slots") opt.config.slots_per_bucket = std::stoull(next());
+            else if (arg == "--load") opt.config.load_factor_threshold = std::stof(next());
+            else if (arg == "--kicks") opt.config.max_cuckoo_kicks = std::stoull(next());
+            else if (arg == "--repeats") opt.repeats = std::max(1, std::stoi(next()));
+            else if (arg == "--hash") {
+                const std::string name = next();
+                bool known = false;
+                for (auto policy : {MyBambooFilter::HashPolicy::Fnv1a, MyBambooFilter::HashPolicy::Fnv1aMix,
+                                    MyBambooFilter::HashPolicy::WordMix}) {
+                    if (name == MyBambooFilter::hash_policy_name(policy)) {
+                        opt.config.hash_policy = policy;
+                        known = true;
+                    }
+                }
+                if (!known) throw std::invalid_argument("Unknown hash policy " + name);
+            } else if (opt.trace_path.empty() && arg[0] != '-') opt.trace_path = arg;
+            else throw std::invalid_argument("Unknown argument " + arg);
+        }
+        if (opt.trace_path.empty()) throw std::invalid_argument("Missing trace file");
+        if (opt.speed <= 0.0) throw std::invalid_argument("--speed must be positive");
+
+        const std::vector<TraceOp> ops = load_trace(opt.trace_path);
+        if (ops.empty()) throw std::runtime_error("Trace is empty");
+        if (opt.open_loop && opt.rate <= 0.0) {
+            for (const auto& op : ops) {
+                if (op.timestamp < 0) throw std::runtime_error("Open-loop replay needs timestamps on every line or --rate");
+            }
+        }
+        for (std::size_t r = 0; r < opt.repeats; ++r) replay(opt, ops);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        usage();
+        return 1;
+    }
+    return 0;
+}
@@ -1,7 +1,18 @@
 #include "bamboo_filter.h"
+#include "bamboo_trace.h"
+#include "kmer.h"
 #include <random>
 #include <algorithm>
 #include <stdexcept>    // For std::invalid_argument
+#include <cstring>      // For std::memcpy
+#include <cmath>        // For std::ceil
+#include <exception>
+#include <mutex>
+#include <utility>     // For std::exchange
+#include <thread>
+#if defined(__GLIBC__)
+#include <malloc.h>     // For malloc_trim
+#endif
 
 // FNV-1a constants for 64-bit hash
 constexpr std::uint64_t FNV_PRIME_64 = 0x100000001b3ULL;
@@ -20,8 +31,49 @@ std::uint64_t MyBambooFilter::fnv1a_hash_str(const void* data, std::size_t len)
     return h;
 }
 
-MyBambooFilter::Fp MyBambooFilter::fingerprint_from_hash_val(std::uint64_t h) {
-    Fp fp = h & 0xFFFF; // Use lower 16 bits for fingerprint
+std::uint64_t MyBambooFilter::mix64(std::uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+std::uint64_t MyBambooFilter::word_mix_hash(const void* data, std::size_t len) {
+    auto p = static_cast<const unsigned char*>(data);
+    std::uint64_t h = FNV_OFFSET_BASIS_64 ^ (len * 0x9e3779b97f4a7c15ULL);
+    std::size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w)); // Unaligned-safe load
+        h = (h ^ w) * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 32;
+    }
+    std::uint64_t tail = 0;
+    for (std::size_t shift = 0; i < len; ++i, shift += 8) {
+        tail |= static_cast<std::uint64_t>(p[i]) << shift;
+    }
+    return mix64(h ^ tail);
+}
+
+std::uint64_t MyBambooFilter::hash_key(const void* data, std::size_t len) const {
+    return hash_with_policy(hash_policy_, std::string_view(static_cast<const char*>(data), len));
+}
+
+std::uint64_t MyBambooFilter::hash_with_policy(HashPolicy policy, std::string_view key) {
+    const void* data = key.data();
+    const std::size_t len = key.size();
+    switch (policy) {
+        case HashPolicy::Fnv1aMix: return mix64(fnv1a_hash_str(data, len));
+        case HashPolicy::WordMix:  return word_mix_hash(data, len);
+        case HashPolicy::Fnv1a:    break;
+    }
+    return fnv1a_hash_str(data, len);
+}
+
+MyBambooFilter::Fp MyBambooFilter::fingerprint_from_hash_val(std::uint64_t h, unsigned bits) {
+    Fp fp = static_cast<Fp>(h & ((1u << bits) - 1)); // Use the lowest `bits` bits for the fingerprint
     // Ensure fingerprint is non-zero, as 0 might indicate an empty slot (though not explicitly used this way here)
     return fp == 0 ? 1 : fp;
 }
@@ -37,21 +89,146 @@ std::size_t MyBambooFilter::alt_index_from_fp_val(std::size_t primary_idx, Fp fp
     return (primary_idx ^ fp_intermediate_hash) % num_buckets_param;
 }
 
+std::size_t MyBambooFilter::alt_index_in_window(std::size_t primary_idx, Fp fp, std::size_t num_buckets_param,
+                                                std::size_t window) {
+    // Same mixing as alt_index_from_fp_val, applied to the offset within the primary's window.
+    // The last window is shorter when the bucket count is not a multiple of the window.
+    const std::size_t start = primary_idx & ~(window - 1);
+    const std::size_t width = std::min(window, num_buckets_param - start);
+    std::uint64_t fp_intermediate_hash = static_cast<std::uint64_t>(fp) * 0x5bd1e995ULL;
+    return start + ((primary_idx - start) ^ fp_intermediate_hash) % width;
+}
+
 //================================================================================
 // Constructor
 //================================================================================
 
 MyBambooFilter::MyBambooFilter(std::size_t initial_num_buckets_param, std::size_t slots_per_bucket_param,
                                float load_factor_threshold, std::size_t max_cuckoo_kicks_param)
-  : num_buckets_(initial_num_buckets_param),
-    slots_per_bucket_(slots_per_bucket_param),
-    max_load_factor_(load_factor_threshold),
-    max_cuckoo_kicks_(max_cuckoo_kicks_param),
-    current_items_count_(0) {
+  : MyBambooFilter(initial_num_buckets_param, slots_per_bucket_param, load_factor_threshold, max_cuckoo_kicks_param,
+                   ExpansionPolicy()) {
+}
+
+MyBambooFilter::MyBambooFilter(std::size_t initial_num_buckets_param, std::size_t slots_per_bucket_param,
+                               float load_factor_threshold, std::size_t max_cuckoo_kicks_param,
+                               const ExpansionPolicy& expansion_policy_param)
+  : MyBambooFilter(Config{initial_num_buckets_param, slots_per_bucket_param, load_factor_threshold,
+                          max_cuckoo_kicks_param, 16, HashPolicy::Fnv1a, expansion_policy_param}) {
+}
+
+MyBambooFilter::MyBambooFilter(const Config& config)
+  : num_buckets_(config.initial_num_buckets),
+    slots_per_bucket_(config.slots_per_bucket),
+    max_load_factor_(config.load_factor_threshold),
+    max_cuckoo_kicks_(config.max_cuckoo_kicks),
+    fingerprint_bits_(config.fingerprint_bits),
+    hash_policy_(config.hash_policy),
+    current_items_count_(0),
+    expansion_policy_(config.expansion_policy) {
     if (num_buckets_ == 0 || slots_per_bucket_ == 0) {
         throw std::invalid_argument("Number of buckets and slots per bucket must be greater than 0.");
     }
-    table_.resize(num_buckets_); // Initialize the outer vector with num_buckets_ empty inner vectors
+    if (fingerprint_bits_ == 0 || fingerprint_bits_ > 16) {
+        throw std::invalid_argument("Fingerprint width must be between 1 and 16 bits.");
+    }
+    if (config.alternate_window_bytes != 0) {
+        const std::size_t window = config.alternate_window_bytes / sizeof(Bucket);
+        if (window < 2) throw std::invalid_argument("Alternate-bucket window must hold at least 2 buckets.");
+        alt_window_ = std::size_t{1} << (63 - __builtin_clzll(window)); // Aligned windows tile the segments
+    }
+    reset_segments(num_buckets_);
+}
+
+MyBambooFilter::MyBambooFilter(const MyBambooFilter& other, CloneTag)
+  : segments_(other.segments_), // Shares every segment; mutable_bucket() unshares on first write
+    num_buckets_(other.num_buckets_),
+    slots_per_bucket_(other.slots_per_bucket_),
+    max_load_factor_(other.max_load_factor_),
+    max_cuckoo_kicks_(other.max_cuckoo_kicks_),
+    fingerprint_bits_(other.fingerprint_bits_),
+    hash_policy_(other.hash_policy_),
+    alt_window_(other.alt_window_),
+    current_items_count_(other.current_items_count_),
+    stashed_items_count_(other.stashed_items_count_),
+    kick_failures_since_rebuild_(other.kick_failures_since_rebuild_),
+    expansion_policy_(other.expansion_policy_),
+    expansion_history_(other.expansion_history_),
+    compact_cursor_(other.compact_cursor_),
+    relocations_(other.relocations_) {}
+
+//================================================================================
+// Public Methods: clone and swap
+//================================================================================
+
+MyBambooFilter::MyBambooFilter(MyBambooFilter&& other) noexcept
+  : segments_(std::move(other.segments_)),
+    num_buckets_(std::exchange(other.num_buckets_, 0)), // Zero buckets makes the source an empty filter
+    slots_per_bucket_(other.slots_per_bucket_),
+    max_load_factor_(other.max_load_factor_),
+    max_cuckoo_kicks_(other.max_cuckoo_kicks_),
+    fingerprint_bits_(other.fingerprint_bits_),
+    hash_policy_(other.hash_policy_),
+    alt_window_(other.alt_window_),
+    current_items_count_(std::exchange(other.current_items_count_, 0)),
+    stashed_items_count_(std::exchange(other.stashed_items_count_, 0)),
+    kick_failures_since_rebuild_(std::exchange(other.kick_failures_since_rebuild_, 0)),
+    expansion_policy_(other.expansion_policy_),
+    expansion_history_(std::move(other.expansion_history_)),
+    compact_cursor_(std::exchange(other.compact_cursor_, 0)),
+    relocations_(std::exchange(other.relocations_, 0)),
+    snapshots_(std::move(other.snapshots_)),
+    next_snapshot_id_(other.next_snapshot_id_) {
+    other.segments_.clear();
+    other.expansion_history_.clear();
+    other.snapshots_.clear();
+}
+
+MyBambooFilter& MyBambooFilter::operator=(MyBambooFilter&& other) noexcept {
+    if (this != &other) {
+        MyBambooFilter moved(std::move(other));
+        swap(moved); // Our old table is released with `moved`
+    }
+    return *this;
+}
+
+MyBambooFilter MyBambooFilter::clone() const {
+    return MyBambooFilter(*this, CloneTag{});
+}
+
+void MyBambooFilter::swap(MyBambooFilter& other) noexcept {
+    using std::swap;
+    swap(segments_, other.segments_);
+    swap(num_buckets_, other.num_buckets_);
+    swap(slots_per_bucket_, other.slots_per_bucket_);
+    swap(max_load_factor_, other.max_load_factor_);
+    swap(max_cuckoo_kicks_, other.max_cuckoo_kicks_);
+    swap(fingerprint_bits_, other.fingerprint_bits_);
+    swap(hash_policy_, other.hash_policy_);
+    swap(alt_window_, other.alt_window_);
+    swap(current_items_count_, other.current_items_count_);
+    swap(stashed_items_count_, other.stashed_items_count_);
+    swap(kick_failures_since_rebuild_, other.kick_failures_since_rebuild_);
+    swap(expansion_policy_, other.expansion_policy_);
+    swap(expansion_history_, other.expansion_history_);
+    swap(compact_cursor_, other.compact_cursor_);
+    swap(relocations_, other.relocations_);
+    swap(snapshots_, other.snapshots_);
+    swap(next_snapshot_id_, other.next_snapshot_id_);
+}
+
+//================================================================================
+// Private Method: reset_segments
+//================================================================================
+
+void MyBambooFilter::reset_segments(std::size_t num_buckets) {
+    static_assert((std::size_t{1} << kSegmentShift) == kSegmentBuckets, "Segment shift and size disagree.");
+    segments_.clear();
+    segments_.reserve((num_buckets + kSegmentBuckets - 1) / kSegmentBuckets);
+    for (std::size_t first = 0; first < num_buckets; first += kSegmentBuckets) {
+        auto segment = std::make_shared<Segment>();
+        segment->buckets.resize(std::min(kSegmentBuckets, num_buckets - first));
+        segments_.push_back(std::move(segment));
+    }
 }
 
 //================================================================================
@@ -59,30 +236,39 @@ MyBambooFilter::MyBambooFilter(std::size_t initial_num_buckets_param, std::size_
 //================================================================================
 
 bool MyBambooFilter::contains(const std::string& key) const {
-    if (num_buckets_ == 0) return false; // Should not happen if constructor validation works
+    return contains_hashed(hash_key(key.data(), key.length()));
+}
 
-    const std::uint64_t h = fnv1a_hash_str(key.data(), key.length());
-    const Fp fp_to_find = fingerprint_from_hash_val(h);
-    const std::size_t i1 = index_from_hash_val(h, num_buckets_);
+bool MyBambooFilter::contains_hashed(std::uint64_t h) const {
+    if (num_buckets_ == 0) return false; // Moved-from
 
-    // Defensive check for index bounds, though modulo should prevent this.
-    if (i1 >= table_.size()) return false;
+    const Fp fp_to_find = fingerprint_from_hash_val(h, fingerprint_bits_);
+    const std::size_t i1 = index_from_hash_val(h, num_buckets_);
 
-    for (const auto& slot : table_[i1]) {
-        if (slot.first == fp_to_find) return true;
+    for (const auto& slot : bucket(i1)) {
+        if (slot.first == fp_to_find) {
+            BAMBOO_TRACE_CONTAINS(h, true);
+            return true;
+        }
     }
 
-    const std::size_t i2 = alt_index_from_fp_val(i1, fp_to_find, num_buckets_);
-    if (i2 >= table_.size()) return false; // Defensive check
-
-    for (const auto& slot : table_[i2]) {
-        if (slot.first == fp_to_find) return true;
+    const std::size_t i2 = alt_index(i1, fp_to_find);
+    for (const auto& slot : bucket(i2)) {
+        if (slot.first == fp_to_find) {
+            BAMBOO_TRACE_CONTAINS(h, true);
+            return true;
+        }
     }
+    BAMBOO_TRACE_CONTAINS(h, false);
     return false;
 }
 
 void MyBambooFilter::insert(const std::string& key) {
-    if (contains(key)) {
+    insert_hashed(hash_key(key.data(), key.length()));
+}
+
+void MyBambooFilter::insert_hashed(std::uint64_t h) {
+    if (contains_hashed(h)) {
         return;
     }
 
@@ -90,29 +276,386 @@ void MyBambooFilter::insert(const std::string& key) {
 
     // The actual insertion logic handles Cuckoo hashing and stashing.
     // current_items_count_ is incremented because a new unique item is being added.
-    _attempt_insert_or_kick(fnv1a_hash_str(key.data(), key.length()));
+    _attempt_insert_or_kick(h);
     current_items_count_++;
 }
 
+std::uint64_t MyBambooFilter::hash_of(std::string_view key) const {
+    return hash_key(key.data(), key.length());
+}
+
+//================================================================================
+// Public Methods: batched and k-mer operations
+//================================================================================
+
+namespace {
+// Number of items whose buckets are prefetched together in batched lookups.
+constexpr std::size_t kBatchPrefetchGroup = 16;
+// Number of k-mer or integer-key hashes buffered before they are handed to the batched operations.
+constexpr std::size_t kKmerBatchSize = 256;
+// Smallest batch worth bucket-sorting, and the largest sorted in one piece (bounds scratch memory).
+constexpr std::size_t kSortedBatchMin = 4096;
+constexpr std::size_t kSortedBatchMax = std::size_t{1} << 22;
+// Bucket-sorting pays off only when a batch holds at least 1/kSortedDensity items per bucket.
+constexpr std::size_t kSortedDensity = 2;
+// Bucket-sorted lookups group items by this many top bits of their primary bucket.
+constexpr unsigned kSortGroupBits = 11;
+
+unsigned bit_width(std::uint64_t x) {
+    return x == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(x));
+}
+} // namespace
+
+void MyBambooFilter::insert(std::uint64_t key) {
+    insert_hashed(mix64(key));
+}
+
+bool MyBambooFilter::contains(std::uint64_t key) const {
+    return contains_hashed(mix64(key));
+}
+
+bool MyBambooFilter::erase(std::uint64_t key) {
+    return erase_hashed(mix64(key));
+}
+
+void MyBambooFilter::insert_batch(const std::uint64_t* keys, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        insert_hashed(mix64(keys[i]));
+    }
+}
+
+void MyBambooFilter::contains_batch(const std::uint64_t* keys, std::size_t count, bool* results) const {
+    std::uint64_t hashes[kKmerBatchSize];
+    for (std::size_t base = 0; base < count; base += kKmerBatchSize) {
+        const std::size_t n = std::min(kKmerBatchSize, count - base);
+        for (std::size_t i = 0; i < n; ++i) hashes[i] = mix64(keys[base + i]);
+        contains_hashed_batch(hashes, n, results + base);
+    }
+}
+
+void MyBambooFilter::contains_batch(const std::uint64_t* keys, std::size_t count, bool* results, BatchOrder order) const {
+    if (order == BatchOrder::Input) {
+        contains_batch(keys, count, results);
+        return;
+    }
+    std::vector<std::uint64_t> hashes(std::min(count, kSortedBatchMax));
+    for (std::size_t base = 0; base < count; base += kSortedBatchMax) {
+        const std::size_t n = std::min(kSortedBatchMax, count - base);
+        for (std::size_t i = 0; i < n; ++i) hashes[i] = mix64(keys[base + i]);
+        contains_hashed_batch(hashes.data(), n, results + base, order);
+    }
+}
+
+void MyBambooFilter::insert_hashed_batch(const std::uint64_t* hashes, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        insert_hashed(hashes[i]);
+    }
+}
+
+bool MyBambooFilter::insert_distinct_hashed(std::uint64_t h) {
+    const Fp fp = fingerprint_from_hash_val(h, fingerprint_bits_);
+    const std::size_t i1 = index_from_hash_val(h, num_buckets_);
+    // Like erase_hashed(): an item always sits in one of the two buckets of its own hash.
+    for (std::size_t bucket_idx : {i1, alt_index(i1, fp)}) {
+        for (const auto& slot : bucket(bucket_idx)) {
+            if (slot.second == h) return false;
+        }
+    }
+    maybe_expand();
+    _attempt_insert_or_kick(h);
+    current_items_count_++;
+    return true;
+}
+
+void MyBambooFilter::contains_hashed_batch(const std::uint64_t* hashes, std::size_t count, bool* results) const {
+    if (num_buckets_ == 0) { // Moved-from
+        std::fill(results, results + count, false);
+        return;
+    }
+    std::size_t i1[kBatchPrefetchGroup];
+    for (std::size_t base = 0; base < count; base += kBatchPrefetchGroup) {
+        const std::size_t group = std::min(kBatchPrefetchGroup, count - base);
+
+        // Pass 1: compute primary buckets and pull their vector headers into cache.
+        for (std::size_t j = 0; j < group; ++j) {
+            i1[j] = index_from_hash_val(hashes[base + j], num_buckets_);
+            __builtin_prefetch(&bucket(i1[j]));
+        }
+        // Pass 2: the headers are (mostly) resident now; prefetch the slot storage they point to.
+        for (std::size_t j = 0; j < group; ++j) {
+            __builtin_prefetch(bucket(i1[j]).data());
+        }
+        // Pass 3: probe.
+        for (std::size_t j = 0; j < group; ++j) {
+            results[base + j] = contains_hashed(hashes[base + j]);
+        }
+    }
+}
+
+void MyBambooFilter::contains_hashed_batch(const std::uint64_t* hashes, std::size_t count, bool* results,
+                                           BatchOrder order) const {
+    if (order == BatchOrder::Input || num_buckets_ == 0 || count < kSortedBatchMin || count * kSortedDensity < num_buckets_) {
+        // Too sparse: neighbouring probes would still land pages apart, so sorting would not pay for itself.
+        contains_hashed_batch(hashes, count, results);
+        return;
+    }
+
+    // One counting-sort pass on the top bits of the primary bucket: each group then covers
+    // num_buckets_ >> kSortGroupBits neighbouring buckets, which is enough for the probes of a
+    // group to share pages and cache lines; a full sort costs more than it saves.
+    const unsigned bucket_bits = bit_width(num_buckets_ - 1);
+    const unsigned drop = bucket_bits > kSortGroupBits ? bucket_bits - kSortGroupBits : 0;
+
+    const std::size_t chunk = std::min(count, kSortedBatchMax);
+    std::vector<std::uint16_t> keys(chunk);
+    std::vector<std::uint64_t> sorted(chunk);
+    std::vector<std::uint32_t> positions(chunk);
+    std::unique_ptr<bool[]> found(new bool[chunk]);
+
+    for (std::size_t base = 0; base < count; base += kSortedBatchMax) {
+        const std::size_t n = std::min(kSortedBatchMax, count - base);
+        std::size_t offsets[std::size_t{1} << kSortGroupBits] = {};
+        if ((num_buckets_ & (num_buckets_ - 1)) == 0) {
+            // Power-of-two table (the usual case, since rebuilds double): the modulo is a mask.
+            for (std::size_t i = 0; i < n; ++i) {
+                keys[i] = static_cast<std::uint16_t>(((hashes[base + i] >> 16) & (num_buckets_ - 1)) >> drop);
+                ++offsets[keys[i]];
+            }
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                keys[i] = static_cast<std::uint16_t>(index_from_hash_val(hashes[base + i], num_buckets_) >> drop);
+                ++offsets[keys[i]];
+            }
+        }
+        std::size_t sum = 0;
+        for (auto& offset : offsets) {
+            const std::size_t group_size = offset;
+            offset = sum;
+            sum += group_size;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t slot = offsets[keys[i]]++;
+            sorted[slot] = hashes[base + i];
+            positions[slot] = static_cast<std::uint32_t>(i);
+        }
+
+        // Probe in group order through the prefetching path, then scatter back.
+        contains_hashed_batch(sorted.data(), n, found.get());
+        for (std::size_t j = 0; j < n; ++j) results[base + positions[j]] = found[j];
+    }
+}
+
+std::size_t MyBambooFilter::insert_kmers(std::string_view sequence, unsigned k) {
+    std::uint64_t buffer[kKmerBatchSize];
+    std::size_t buffered = 0;
+    std::size_t processed = 0;
+    kmer::for_each_canonical_kmer(sequence, k, [&](std::uint64_t code) {
+        buffer[buffered++] = mix64(code);
+        if (buffered == kKmerBatchSize) {
+            insert_hashed_batch(buffer, buffered);
+            processed += buffered;
+            buffered = 0;
+        }
+    });
+    insert_hashed_batch(buffer, buffered);
+    return processed + buffered;
+}
+
+std::size_t MyBambooFilter::count_present_kmers(std::string_view sequence, unsigned k) const {
+    std::uint64_t buffer[kKmerBatchSize];
+    bool found[kKmerBatchSize];
+    std::size_t buffered = 0;
+    std::size_t present = 0;
+    auto flush = [&]() {
+        contains_hashed_batch(buffer, buffered, found);
+        for (std::size_t i = 0; i < buffered; ++i) present += found[i];
+        buffered = 0;
+    };
+    kmer::for_each_canonical_kmer(sequence, k, [&](std::uint64_t code) {
+        buffer[buffered++] = mix64(code);
+        if (buffered == kKmerBatchSize) flush();
+    });
+    flush();
+    return present;
+}
+
+MyBambooFilter::ReadClassification MyBambooFilter::classify_read(std::string_view sequence, unsigned k,
+                                                                float threshold) const {
+    // Encoding is cheap next to probing, so all k-mers are extracted first to know the total.
+    static thread_local std::vector<std::uint64_t> hashes;
+    hashes.clear();
+    kmer::for_each_canonical_kmer(sequence, k, [&](std::uint64_t code) { hashes.push_back(mix64(code)); });
+
+    ReadClassification result{false, hashes.size(), 0, 0};
+    if (hashes.empty()) return result;
+    const std::size_t required = static_cast<std::size_t>(
+        std::ceil(std::max(0.0f, std::min(1.0f, threshold)) * static_cast<double>(hashes.size())));
+
+    bool found[kBatchPrefetchGroup];
+    while (result.hits < required && result.hits + (hashes.size() - result.kmers_probed) >= required) {
+        const std::size_t batch = std::min(kBatchPrefetchGroup, hashes.size() - result.kmers_probed);
+        contains_hashed_batch(hashes.data() + result.kmers_probed, batch, found);
+        for (std::size_t i = 0; i < batch; ++i) result.hits += found[i];
+        result.kmers_probed += batch;
+    }
+    result.matched = result.hits >= required;
+    return result;
+}
+
+//================================================================================
+// Public Methods: columnar (Arrow layout) batches
+//================================================================================
+
+namespace {
+// Rows per hashing block; a multiple of 8, so every block fills whole bitmap bytes.
+constexpr std::size_t kColumnBlock = 256;
+
+/** @brief Tests validity bit `bit` (LSB first); a null bitmap means every row is valid. */
+inline bool row_valid(const std::uint8_t* validity, std::size_t bit) {
+    return validity == nullptr || ((validity[bit >> 3] >> (bit & 7)) & 1) != 0;
+}
+
+/** @brief Checks all `n + 1` offsets up front, so a bad one is reported before any row is used. */
+template <typename Offset>
+void check_column_offsets(const Offset* offsets, std::size_t n) {
+    if (offsets[0] < 0) throw std::invalid_argument("Column offsets must be non-negative and non-decreasing.");
+    for (std::size_t row = 0; row < n; ++row) {
+        if (offsets[row + 1] < offsets[row]) {
+            throw std::invalid_argument("Column offsets must be non-negative and non-decreasing.");
+        }
+    }
+}
+
+template <typename Offset>
+std::string_view column_row(const Offset* offsets, const char* data, std::size_t row) {
+    return std::string_view(data + offsets[row], static_cast<std::size_t>(offsets[row + 1] - offsets[row]));
+}
+
+/** @brief Hashes the valid rows of [base, base + count) into `hashes`; records their rows in `rows`. */
+template <typename Offset>
+std::size_t hash_column_block(MyBambooFilter::HashPolicy policy, const Offset* offsets, const char* data,
+                              const std::uint8_t* validity, std::size_t validity_offset, std::size_t base,
+                              std::size_t count, std::uint64_t* hashes, std::size_t* rows) {
+    std::size_t valid = 0;
+    for (std::size_t row = base; row < base + count; ++row) {
+        if (!row_valid(validity, validity_offset + row)) continue;
+        hashes[valid] = MyBambooFilter::hash_with_policy(policy, column_row(offsets, data, row));
+        rows[valid++] = row;
+    }
+    return valid;
+}
+
+template <typename Offset>
+std::size_t insert_column_impl(MyBambooFilter& filter, const Offset* offsets, const char* data, std::size_t n,
+                               const std::uint8_t* validity, std::size_t validity_offset) {
+    check_column_offsets(offsets, n);
+    std::uint64_t hashes[kColumnBlock];
+    std::size_t rows[kColumnBlock];
+    const std::size_t before = filter.size(); // Rows whose fingerprint is already stored add nothing
+    for (std::size_t base = 0; base < n; base += kColumnBlock) {
+        const std::size_t valid = hash_column_block(filter.hash_policy(), offsets, data, validity, validity_offset,
+                                                    base, std::min(kColumnBlock, n - base), hashes, rows);
+        filter.insert_hashed_batch(hashes, valid);
+    }
+    return filter.size() - before;
+}
+
+template <typename Offset>
+void contains_column_impl(const MyBambooFilter& filter, const Offset* offsets, const char* data, std::size_t n,
+                          std::uint8_t* out_bitmap, const std::uint8_t* validity, std::size_t validity_offset) {
+    check_column_offsets(offsets, n);
+    std::uint64_t hashes[kColumnBlock];
+    std::size_t rows[kColumnBlock];
+    bool found[kColumnBlock];
+    for (std::size_t base = 0; base < n; base += kColumnBlock) {
+        const std::size_t count = std::min(kColumnBlock, n - base);
+        const std::size_t valid = hash_column_block(filter.hash_policy(), offsets, data, validity, validity_offset,
+                                                    base, count, hashes, rows);
+        filter.contains_hashed_batch(hashes, valid, found);
+
+        // Assemble the block's bitmap bytes; null rows and padding bits stay 0.
+        std::uint8_t* out = out_bitmap + base / 8;
+        std::fill(out, out + (count + 7) / 8, std::uint8_t{0});
+        for (std::size_t j = 0; j < valid; ++j) {
+            const std::size_t bit = rows[j] - base;
+            out[bit >> 3] |= static_cast<std::uint8_t>(found[j]) << (bit & 7);
+        }
+    }
+}
+} // namespace
+
+std::size_t MyBambooFilter::insert_column(const std::int32_t* offsets, const char* data, std::size_t n,
+                                          const std::uint8_t* validity, std::size_t validity_offset) {
+    return insert_column_impl(*this, offsets, data, n, validity, validity_offset);
+}
+
+std::size_t MyBambooFilter::insert_column(const std::int64_t* offsets, const char* data, std::size_t n,
+                                          const std::uint8_t* validity, std::size_t validity_offset) {
+    return insert_column_impl(*this, offsets, data, n, validity, validity_offset);
+}
+
+void MyBambooFilter::contains_column(const std::int32_t* offsets, const char* data, std::size_t n,
+                                     std::uint8_t* out_bitmap, const std::uint8_t* validity,
+                                     std::size_t validity_offset) const {
+    contains_column_impl(*this, offsets, data, n, out_bitmap, validity, validity_offset);
+}
+
+void MyBambooFilter::contains_column(const std::int64_t* offsets, const char* data, std::size_t n,
+                                     std::uint8_t* out_bitmap, const std::uint8_t* validity,
+                                     std::size_t validity_offset) const {
+    contains_column_impl(*this, offsets, data, n, out_bitmap, validity, validity_offset);
+}
+
+//================================================================================
+// Public Methods: erase
+//================================================================================
+
+bool MyBambooFilter::erase(const std::string& key) {
+    return erase_hashed(hash_key(key.data(), key.length()));
+}
+
+bool MyBambooFilter::erase_hashed(std::uint64_t h) {
+    if (num_buckets_ == 0) return false; // Moved-from
+    const Fp fp = fingerprint_from_hash_val(h, fingerprint_bits_);
+    const std::size_t i1 = index_from_hash_val(h, num_buckets_);
+    const std::size_t i2 = alt_index(i1, fp);
+
+    // Stashed items always live in one of their two candidate buckets, so these are the only places to look.
+    for (std::size_t bucket_idx : {i1, i2}) {
+        const Bucket& candidate = bucket(bucket_idx);
+        for (std::size_t s = 0; s < candidate.size(); ++s) {
+            if (candidate[s].second != h) continue;
+
+            Bucket& target = mutable_bucket(bucket_idx); // Only unshare the segment once there is a match
+            if (target.size() > slots_per_bucket_) stashed_items_count_--; // The bucket drops one stashed item
+            target[s] = target.back(); // Order within a bucket is irrelevant
+            target.pop_back();
+            current_items_count_--;
+            return true;
+        }
+    }
+    return false;
+}
+
 //================================================================================
 // Private Method: _attempt_insert_or_kick
 //================================================================================
 
-void MyBambooFilter::_attempt_insert_or_kick(std::uint64_t original_hash_of_item) {
-    Slot slot_to_place = {fingerprint_from_hash_val(original_hash_of_item), original_hash_of_item};
+bool MyBambooFilter::_attempt_insert_or_kick(std::uint64_t original_hash_of_item) {
+    Slot slot_to_place = {fingerprint_from_hash_val(original_hash_of_item, fingerprint_bits_), original_hash_of_item};
     std::size_t i1 = index_from_hash_val(original_hash_of_item, num_buckets_);
 
     // Attempt to place in the primary bucket
-    if (table_[i1].size() < slots_per_bucket_) {
-        table_[i1].push_back(slot_to_place);
-        return;
+    if (bucket(i1).size() < slots_per_bucket_) {
+        mutable_bucket(i1).push_back(slot_to_place);
+        return true;
     }
 
     // Attempt to place in the alternate bucket
-    std::size_t i2 = alt_index_from_fp_val(i1, slot_to_place.first, num_buckets_);
-    if (table_[i2].size() < slots_per_bucket_) {
-        table_[i2].push_back(slot_to_place);
-        return;
+    std::size_t i2 = alt_index(i1, slot_to_place.first);
+    if (bucket(i2).size() < slots_per_bucket_) {
+        mutable_bucket(i2).push_back(slot_to_place);
+        return true;
     }
 
     // Both candidate buckets are full; begin Cuckoo eviction.
@@ -121,41 +664,49 @@ void MyBambooFilter::_attempt_insert_or_kick(std::uint64_t original_hash_of_item
 
     for (std::size_t kick_count = 0; kick_count < max_cuckoo_kicks_; ++kick_count) {
         // The bucket we are kicking from should not be empty if we reached this Cuckoo path.
-        if (table_[current_bucket_idx].empty()) {
+        Bucket& current = mutable_bucket(current_bucket_idx);
+        if (current.empty()) {
             // This is an unexpected state, indicating a potential logic error elsewhere
             // or that an empty bucket was chosen after a kick. Recover by placing here.
-            table_[current_bucket_idx].push_back(slot_to_place);
-            return;
+            current.push_back(slot_to_place);
+            BAMBOO_TRACE_KICK_CHAIN(original_hash_of_item, kick_count, false);
+            return true;
         }
 
         // Select a random victim from the current_bucket_idx
-        std::uniform_int_distribution<std::size_t> dist(0, table_[current_bucket_idx].size() - 1);
+        std::uniform_int_distribution<std::size_t> dist(0, current.size() - 1);
         std::size_t victim_slot_in_bucket_offset = dist(rng);
 
         // Swap the item we are trying to place with the victim
-        Slot temp_victim_slot = table_[current_bucket_idx][victim_slot_in_bucket_offset];
-        table_[current_bucket_idx][victim_slot_in_bucket_offset] = slot_to_place;
+        Slot temp_victim_slot = current[victim_slot_in_bucket_offset];
+        current[victim_slot_in_bucket_offset] = slot_to_place;
         slot_to_place = temp_victim_slot; // slot_to_place now holds the victim, which needs a new home
+        ++relocations_;
 
         std::size_t victim_original_primary_idx = index_from_hash_val(slot_to_place.second, num_buckets_);
         if (current_bucket_idx == victim_original_primary_idx) {
-            current_bucket_idx = alt_index_from_fp_val(victim_original_primary_idx, slot_to_place.first, num_buckets_);
+            current_bucket_idx = alt_index(victim_original_primary_idx, slot_to_place.first);
         } else {
             // current_bucket_idx was already the alternate for the victim, so move it to its primary
             current_bucket_idx = victim_original_primary_idx;
         }
 
         // Try to place the victim (now in slot_to_place) in this new current_bucket_idx
-        if (table_[current_bucket_idx].size() < slots_per_bucket_) {
-            table_[current_bucket_idx].push_back(slot_to_place);
-            return; // Successfully placed the kicked item
+        if (bucket(current_bucket_idx).size() < slots_per_bucket_) {
+            mutable_bucket(current_bucket_idx).push_back(slot_to_place);
+            BAMBOO_TRACE_KICK_CHAIN(original_hash_of_item, kick_count + 1, false);
+            return true; // Successfully placed the kicked item
         }
         // If the new bucket is also full, the loop continues, and the victim (in slot_to_place) will kick someone else.
     }
 
     // Cuckoo kicks failed after max_cuckoo_kicks_; stash the item.
     // The item (which is some displaced victim) is stashed in the last attempted bucket.
-    table_[current_bucket_idx].push_back(slot_to_place);
+    mutable_bucket(current_bucket_idx).push_back(slot_to_place);
+    stashed_items_count_++;
+    kick_failures_since_rebuild_++;
+    BAMBOO_TRACE_KICK_CHAIN(original_hash_of_item, max_cuckoo_kicks_, true);
+    return false;
 }
 
 //================================================================================
@@ -163,36 +714,75 @@ void MyBambooFilter::_attempt_insert_or_kick(std::uint64_t original_hash_of_item
 //================================================================================
 
 void MyBambooFilter::maybe_expand() {
-    if (loadFactor() >= max_load_factor_) {
-        rebuild_table();
+    const float load = loadFactor();
+    auto expand = [&](ExpansionReason reason) {
+        BAMBOO_TRACE_EXPAND(static_cast<int>(reason), static_cast<unsigned>(load * 1000.0f),
+                            kick_failures_since_rebuild_, stashed_items_count_);
+        rebuild_table(reason);
+    };
+    if (load >= max_load_factor_) {
+        expand(ExpansionReason::LoadFactor);
+        return;
+    }
+
+    // Pressure triggers only apply once the table holds a meaningful number of items.
+    if (load < expansion_policy_.min_load_factor) return;
+
+    if (expansion_policy_.max_kick_failures != 0 &&
+        kick_failures_since_rebuild_ >= expansion_policy_.max_kick_failures) {
+        expand(ExpansionReason::KickFailure);
+        return;
+    }
+
+    const std::size_t total_physical_slots = num_buckets_ * slots_per_bucket_;
+    if (expansion_policy_.max_stash_fraction > 0.0f &&
+        stashed_items_count_ > expansion_policy_.max_stash_fraction * total_physical_slots) {
+        expand(ExpansionReason::StashPressure);
     }
 }
 
-void MyBambooFilter::rebuild_table() {
+void MyBambooFilter::rebuild_table(ExpansionReason reason) {
+    ExpansionEvent event{reason, num_buckets_, 0, current_items_count_, loadFactor(),
+                         stashed_items_count_, kick_failures_since_rebuild_};
+    BAMBOO_TRACE_REBUILD_BEGIN(num_buckets_, current_items_count_);
+
+
     // 1. Collect all original 64-bit hashes of currently stored items.
     std::vector<std::uint64_t> all_original_hashes;
     all_original_hashes.reserve(current_items_count_); // Reserve based on the count of unique items
 
-    for (const auto& bucket : table_) {
-        for (const auto& slot_item : bucket) {
-            if (slot_item.first != 0) { // Ensure slot is not empty (fingerprint 0 is reserved)
-                all_original_hashes.push_back(slot_item.second); // Store the full original hash
+    for (const auto& segment : segments_) {
+        for (const auto& old_bucket : segment->buckets) {
+            for (const auto& slot_item : old_bucket) {
+                if (slot_item.first != 0) { // Ensure slot is not empty (fingerprint 0 is reserved)
+                    all_original_hashes.push_back(slot_item.second); // Store the full original hash
+                }
             }
         }
     }
 
     // 2. Double the number of buckets and re-initialize the table.
     num_buckets_ *= 2;
-    table_.assign(num_buckets_, std::vector<Slot>()); // Create new, empty buckets
+    reset_segments(num_buckets_); // Create new, empty buckets; clones keep the old segments
 
-    // 3. Reset item count; items will be recounted as they are re-inserted.
+    // 3. Reset item and stash counts; items will be recounted as they are re-inserted.
     current_items_count_ = 0;
+    stashed_items_count_ = 0;
 
     // 4. Re-insert all items using their original full hashes into the new, larger table.
     for (const auto& original_hash_to_reinsert : all_original_hashes) {
         _attempt_insert_or_kick(original_hash_to_reinsert);
         current_items_count_++; // Increment count for each successfully re-inserted item
     }
+
+    // 5. Failures seen while re-inserting are not held against the new table, and a running
+    //    compaction pass starts over on the new layout.
+    kick_failures_since_rebuild_ = 0;
+    compact_cursor_ = 0;
+
+    event.buckets_after = num_buckets_;
+    expansion_history_.push_back(event);
+    BAMBOO_TRACE_REBUILD_END(num_buckets_, current_items_count_, stashed_items_count_);
 }
 
 //================================================================================
@@ -207,17 +797,439 @@ std::size_t MyBambooFilter::capacity_buckets() const {
     return num_buckets_;
 }
 
+std::uint16_t MyBambooFilter::fingerprint_of(std::uint64_t hash) const {
+    return fingerprint_from_hash_val(hash, fingerprint_bits_);
+}
+
+std::size_t MyBambooFilter::primary_bucket(std::uint64_t hash, std::size_t num_buckets) {
+    return index_from_hash_val(hash, num_buckets);
+}
+
+std::size_t MyBambooFilter::alternate_bucket(std::size_t primary, Fp fp, std::size_t num_buckets, std::size_t window) {
+    return window == 0 ? alt_index_from_fp_val(primary, fp, num_buckets)
+                       : alt_index_in_window(primary, fp, num_buckets, window);
+}
+
 float MyBambooFilter::loadFactor() const {
     const std::size_t total_physical_slots = num_buckets_ * slots_per_bucket_;
     if (total_physical_slots == 0) return 0.0f;
     return static_cast<float>(current_items_count_) / total_physical_slots;
 }
 
+//================================================================================
+// Public Methods: compaction
+//================================================================================
+
+std::size_t MyBambooFilter::compact() {
+    const std::size_t before = memoryUsage();
+    compact_cursor_ = 0;
+    compact_step(num_buckets_);
+    const std::size_t after = memoryUsage();
+    return before > after ? before - after : 0;
+}
+
+bool MyBambooFilter::compact_step(std::size_t max_buckets) {
+    // max_buckets may be SIZE_MAX ("finish the pass"), so the sum could wrap.
+    const std::size_t end = max_buckets >= num_buckets_ - compact_cursor_ ? num_buckets_ : compact_cursor_ + max_buckets;
+    for (; compact_cursor_ < end; ++compact_cursor_) {
+        const Bucket& current = bucket(compact_cursor_);
+        if (current.size() <= slots_per_bucket_ && current.capacity() == current.size()) continue;
+        Bucket& target = mutable_bucket(compact_cursor_); // Shared segments are only copied when there is work
+
+        // Re-place stashed items: each is in one of its two candidate buckets, so try the other.
+        for (std::size_t pos = target.size(); pos > slots_per_bucket_; --pos) {
+            const Slot item = target[pos - 1];
+            const std::size_t primary = index_from_hash_val(item.second, num_buckets_);
+            const std::size_t other = primary == compact_cursor_
+                                    ? alt_index(primary, item.first)
+                                    : primary;
+            if (other == compact_cursor_ || bucket(other).size() >= slots_per_bucket_) continue;
+            mutable_bucket(other).push_back(item);
+            target.erase(target.begin() + static_cast<std::ptrdiff_t>(pos - 1));
+            stashed_items_count_--;
+            ++relocations_;
+        }
+
+        // Reallocate to the exact size; shrink_to_fit() is only a request.
+        if (target.capacity() != target.size()) Bucket(target.begin(), target.end()).swap(target);
+    }
+
+    if (compact_cursor_ < num_buckets_) return false;
+    compact_cursor_ = 0;
+#if defined(__GLIBC__)
+    // Freed bucket storage stays in the allocator's free lists; trimming returns whole free
+    // pages to the kernel (glibc releases them with madvise(MADV_DONTNEED)).
+    malloc_trim(0);
+#endif
+    return true;
+}
+
+//================================================================================
+// Public Methods: entry iteration
+//================================================================================
+
+MyBambooFilter::EntryCursor MyBambooFilter::entries() const {
+    return entries(0, num_buckets_);
+}
+
+MyBambooFilter::EntryCursor MyBambooFilter::entries(std::size_t first_bucket, std::size_t last_bucket) const {
+    last_bucket = std::min(last_bucket, num_buckets_);
+    first_bucket = std::min(first_bucket, last_bucket);
+    std::vector<std::shared_ptr<const Segment>> covered;
+    if (first_bucket < last_bucket) {
+        const std::size_t first_segment = first_bucket >> kSegmentShift;
+        const std::size_t last_segment = (last_bucket - 1) >> kSegmentShift;
+        covered.assign(segments_.begin() + static_cast<std::ptrdiff_t>(first_segment),
+                       segments_.begin() + static_cast<std::ptrdiff_t>(last_segment + 1));
+    }
+    return EntryCursor(std::move(covered), first_bucket, last_bucket);
+}
+
+std::vector<MyBambooFilter::EntryCursor> MyBambooFilter::partition_entries(std::size_t num_parts) const {
+    num_parts = std::max<std::size_t>(1, std::min(num_parts, num_buckets_));
+    // Whole segments per part when there are enough of them, so parts never share a segment.
+    std::size_t step = (num_buckets_ + num_parts - 1) / num_parts;
+    if (segments_.size() >= num_parts) {
+        step = ((segments_.size() + num_parts - 1) / num_parts) * kSegmentBuckets;
+    }
+    std::vector<EntryCursor> parts;
+    parts.reserve(num_parts);
+    for (std::size_t first = 0; first < num_buckets_; first += step) {
+        parts.push_back(entries(first, first + step));
+    }
+    return parts;
+}
+
+std::size_t MyBambooFilter::for_each_entry_parallel(std::size_t num_workers,
+                                                    const std::function<void(const Entry&, std::size_t)>& fn) const {
+    std::vector<EntryCursor> parts = partition_entries(std::max<std::size_t>(1, num_workers));
+    std::vector<std::size_t> visited(parts.size(), 0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto walk = [&](std::size_t w) {
+        try {
+            Entry entry;
+            while (parts[w].next(entry)) {
+                fn(entry, w);
+                ++visited[w];
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t w = 1; w < parts.size(); ++w) workers.emplace_back(walk, w);
+    walk(0); // The calling thread takes the first range
+    for (auto& worker : workers) worker.join();
+    if (error) std::rethrow_exception(error);
+
+    std::size_t total = 0;
+    for (std::size_t v : visited) total += v;
+    return total;
+}
+
+MyBambooFilter::EntryCursor::EntryCursor(std::vector<std::shared_ptr<const Segment>> segments,
+                                         std::size_t first_bucket, std::size_t last_bucket)
+  : segments_(std::move(segments)),
+    first_segment_(first_bucket >> kSegmentShift),
+    first_bucket_(first_bucket),
+    last_bucket_(last_bucket),
+    bucket_(first_bucket),
+    slot_(0) {}
+
+bool MyBambooFilter::EntryCursor::next(Entry& out) {
+    while (bucket_ < last_bucket_) {
+        const Bucket& current =
+            segments_[(bucket_ >> kSegmentShift) - first_segment_]->buckets[bucket_ & (kSegmentBuckets - 1)];
+        if (slot_ < current.size()) {
+            out = Entry{bucket_, current[slot_].first, current[slot_].second};
+            ++slot_;
+            return true;
+        }
+        ++bucket_;
+        slot_ = 0;
+    }
+    return false;
+}
+
+std::size_t MyBambooFilter::EntryCursor::next_batch(Entry* out, std::size_t max_entries) {
+    std::size_t written = 0;
+    while (written < max_entries && next(out[written])) ++written;
+    return written;
+}
+
+std::size_t MyBambooFilter::EntryCursor::first_bucket() const { return first_bucket_; }
+
+std::size_t MyBambooFilter::EntryCursor::last_bucket() const { return last_bucket_; }
+
+//================================================================================
+// Public Methods: delta sync
+//================================================================================
+
+namespace {
+constexpr char kDeltaMagic[4] = {'B', 'F', 'D', '2'};
+
+void put_varint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void put_u64(std::string& out, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+std::uint64_t get_varint(std::string_view in, std::size_t& pos) {
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) throw std::runtime_error("Truncated filter delta.");
+        const auto byte = static_cast<unsigned char>(in[pos++]);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    throw std::runtime_error("Malformed varint in filter delta.");
+}
+
+std::uint64_t get_u64(std::string_view in, std::size_t& pos) {
+    if (in.size() - pos < 8) throw std::runtime_error("Truncated filter delta.");
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) value |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[pos++])) << (8 * i);
+    return value;
+}
+} // namespace
+
+std::size_t MyBambooFilter::Delta::entry_count() const {
+    std::size_t total = 0;
+    for (const auto& patch : patches) total += patch.hashes.size();
+    return total;
+}
+
+std::string MyBambooFilter::Delta::serialize() const {
+    // Layout: magic, flags, geometry and counts as varints, then per patch the gap to the
+    // previous patched bucket, the slot count and the slot hashes as 8-byte little-endian words.
+    std::string out(kDeltaMagic, sizeof(kDeltaMagic));
+    out.reserve(32 + patches.size() * 3 + entry_count() * 8);
+    out.push_back(static_cast<char>(full ? 1 : 0));
+    put_varint(out, num_buckets);
+    put_varint(out, slots_per_bucket);
+    put_varint(out, fingerprint_bits);
+    put_varint(out, static_cast<std::uint64_t>(hash_policy));
+    put_varint(out, alternate_window);
+    put_varint(out, items);
+    put_varint(out, stashed_items);
+    put_varint(out, patches.size());
+    std::size_t next_bucket = 0;
+    for (const auto& patch : patches) {
+        put_varint(out, patch.bucket - next_bucket);
+        next_bucket = patch.bucket + 1;
+        put_varint(out, patch.hashes.size());
+        for (std::uint64_t h : patch.hashes) put_u64(out, h);
+    }
+    return out;
+}
+
+MyBambooFilter::Delta MyBambooFilter::Delta::deserialize(std::string_view bytes) {
+    if (bytes.size() < sizeof(kDeltaMagic) + 1 || bytes.compare(0, sizeof(kDeltaMagic), kDeltaMagic, sizeof(kDeltaMagic)) != 0) {
+        throw std::runtime_error("Not a filter delta.");
+    }
+    std::size_t pos = sizeof(kDeltaMagic);
+    Delta delta;
+    delta.full = bytes[pos++] != 0;
+    delta.num_buckets = get_varint(bytes, pos);
+    delta.slots_per_bucket = get_varint(bytes, pos);
+    const std::uint64_t fingerprint_bits = get_varint(bytes, pos);
+    if (fingerprint_bits > 16) throw std::runtime_error("Malformed filter delta.");
+    delta.fingerprint_bits = static_cast<unsigned>(fingerprint_bits);
+    const std::uint64_t policy = get_varint(bytes, pos);
+    if (policy > static_cast<std::uint64_t>(HashPolicy::WordMix)) throw std::runtime_error("Unknown hash policy in filter delta.");
+    delta.hash_policy = static_cast<HashPolicy>(policy);
+    delta.alternate_window = get_varint(bytes, pos);
+    delta.items = get_varint(bytes, pos);
+    delta.stashed_items = get_varint(bytes, pos);
+    const std::uint64_t num_patches = get_varint(bytes, pos);
+    // Every patch takes at least two bytes, which bounds the reservation below.
+    if (num_patches > delta.num_buckets || num_patches > (bytes.size() - pos) / 2) {
+        throw std::runtime_error("Malformed filter delta.");
+    }
+    delta.patches.reserve(num_patches);
+    std::size_t next_bucket = 0;
+    for (std::uint64_t p = 0; p < num_patches; ++p) {
+        BucketPatch patch;
+        const std::uint64_t gap = get_varint(bytes, pos);
+        if (gap >= delta.num_buckets - next_bucket) throw std::runtime_error("Malformed filter delta.");
+        patch.bucket = next_bucket + gap;
+        next_bucket = patch.bucket + 1;
+        const std::uint64_t count = get_varint(bytes, pos);
+        if (count > (bytes.size() - pos) / 8) throw std::runtime_error("Truncated filter delta.");
+        patch.hashes.resize(count);
+        for (auto& h : patch.hashes) h = get_u64(bytes, pos);
+        delta.patches.push_back(std::move(patch));
+    }
+    if (pos != bytes.size()) throw std::runtime_error("Trailing bytes after filter delta.");
+    return delta;
+}
+
+MyBambooFilter::Delta MyBambooFilter::diff(const MyBambooFilter& from, const MyBambooFilter& to) {
+    if (from.slots_per_bucket_ != to.slots_per_bucket_ || from.fingerprint_bits_ != to.fingerprint_bits_ ||
+        from.hash_policy_ != to.hash_policy_ || from.alt_window_ != to.alt_window_) {
+        throw std::invalid_argument(
+            "Filters differ in slots per bucket, fingerprint width, hash policy or alternate-bucket window.");
+    }
+    if (from.num_buckets_ != to.num_buckets_) return to.full_delta();
+    return to.diff_segments(from.segments_);
+}
+
+MyBambooFilter::Delta MyBambooFilter::diff_segments(const std::vector<std::shared_ptr<Segment>>& from) const {
+    Delta delta{false, num_buckets_, slots_per_bucket_, fingerprint_bits_, hash_policy_, alt_window_,
+                current_items_count_, stashed_items_count_, {}};
+    for (std::size_t seg = 0; seg < segments_.size(); ++seg) {
+        // A shared segment cannot have been written since: writes copy shared segments first.
+        if (from[seg] == segments_[seg]) continue;
+        const std::size_t first = seg << kSegmentShift;
+        const std::size_t count = std::min(kSegmentBuckets, num_buckets_ - first);
+        for (std::size_t b = 0; b < count; ++b) {
+            const Bucket& now = segments_[seg]->buckets[b];
+            if (from[seg]->buckets[b] == now) continue;
+            Delta::BucketPatch patch{first + b, {}};
+            patch.hashes.reserve(now.size());
+            for (const auto& slot : now) patch.hashes.push_back(slot.second);
+            delta.patches.push_back(std::move(patch));
+        }
+    }
+    return delta;
+}
+
+MyBambooFilter::Delta MyBambooFilter::full_delta() const {
+    Delta delta{true, num_buckets_, slots_per_bucket_, fingerprint_bits_, hash_policy_, alt_window_,
+                current_items_count_, stashed_items_count_, {}};
+    for (std::size_t b = 0; b < num_buckets_; ++b) {
+        const Bucket& current = bucket(b);
+        if (current.empty()) continue;
+        Delta::BucketPatch patch{b, {}};
+        patch.hashes.reserve(current.size());
+        for (const auto& slot : current) patch.hashes.push_back(slot.second);
+        delta.patches.push_back(std::move(patch));
+    }
+    return delta;
+}
+
+std::uint64_t MyBambooFilter::take_snapshot() {
+    const std::uint64_t id = next_snapshot_id_++;
+    snapshots_.emplace(id, Snapshot{num_buckets_, segments_});
+    return id;
+}
+
+MyBambooFilter::Delta MyBambooFilter::diff_since(std::uint64_t snapshot_id) const {
+    const auto it = snapshots_.find(snapshot_id);
+    if (it == snapshots_.end()) throw std::invalid_argument("Unknown snapshot ID.");
+    if (it->second.num_buckets != num_buckets_) return full_delta(); // Rebuilt since the snapshot
+    return diff_segments(it->second.segments);
+}
+
+bool MyBambooFilter::release_snapshot(std::uint64_t snapshot_id) {
+    return snapshots_.erase(snapshot_id) > 0;
+}
+
+void MyBambooFilter::apply_delta(const Delta& delta) {
+    if (delta.full) {
+        if (delta.num_buckets == 0 || delta.slots_per_bucket == 0 || delta.fingerprint_bits == 0 ||
+            delta.fingerprint_bits > 16 || (delta.alternate_window & (delta.alternate_window - 1)) != 0 ||
+            delta.alternate_window == 1) {
+            throw std::invalid_argument("Delta has an invalid geometry.");
+        }
+        num_buckets_ = delta.num_buckets;
+        slots_per_bucket_ = delta.slots_per_bucket;
+        fingerprint_bits_ = delta.fingerprint_bits;
+        hash_policy_ = delta.hash_policy;
+        alt_window_ = delta.alternate_window;
+        reset_segments(num_buckets_);
+        kick_failures_since_rebuild_ = 0;
+        compact_cursor_ = 0;
+    } else if (delta.num_buckets != num_buckets_ || delta.slots_per_bucket != slots_per_bucket_ ||
+               delta.fingerprint_bits != fingerprint_bits_ || delta.hash_policy != hash_policy_ ||
+               delta.alternate_window != alt_window_) {
+        throw std::invalid_argument("Delta geometry does not match this filter.");
+    }
+    for (const auto& patch : delta.patches) {
+        if (patch.bucket >= num_buckets_) throw std::invalid_argument("Delta patches a bucket out of range.");
+    }
+
+    for (const auto& patch : delta.patches) {
+        Bucket& target = mutable_bucket(patch.bucket);
+        target.clear();
+        target.reserve(patch.hashes.size());
+        for (std::uint64_t h : patch.hashes) target.emplace_back(fingerprint_from_hash_val(h, fingerprint_bits_), h);
+    }
+    current_items_count_ = delta.items;
+    stashed_items_count_ = delta.stashed_items;
+}
+
 std::size_t MyBambooFilter::memoryUsage() const {
-    std::size_t total_mem = sizeof(table_); // Overhead for the main std::vector object itself
-    for (const auto& bucket : table_) {
-        // Overhead for each inner std::vector object + memory for its allocated slots
-        total_mem += sizeof(std::vector<Slot>) + (bucket.capacity() * sizeof(Slot));
+    // Segments shared with clones are counted in full by every filter that references them.
+    std::size_t total_mem = sizeof(segments_) + segments_.capacity() * sizeof(std::shared_ptr<Segment>);
+    for (const auto& segment : segments_) {
+        total_mem += sizeof(Segment) + segment->buckets.capacity() * sizeof(Bucket); // Bucket headers
+        for (const auto& b : segment->buckets) {
+            total_mem += b.capacity() * sizeof(Slot); // Memory for each bucket's allocated slots
+        }
     }
     return total_mem;
+}
+
+std::size_t MyBambooFilter::stashed_items() const {
+    return stashed_items_count_;
+}
+
+std::size_t MyBambooFilter::relocations() const {
+    return relocations_;
+}
+
+const MyBambooFilter::ExpansionPolicy& MyBambooFilter::expansion_policy() const {
+    return expansion_policy_;
+}
+
+void MyBambooFilter::set_expansion_policy(const ExpansionPolicy& policy) {
+    expansion_policy_ = policy;
+}
+
+const std::vector<MyBambooFilter::ExpansionEvent>& MyBambooFilter::expansion_history() const {
+    return expansion_history_;
+}
+
+const char* MyBambooFilter::expansion_reason_name(ExpansionReason reason) {
+    switch (reason) {
+        case ExpansionReason::LoadFactor:    return "load_factor";
+        case ExpansionReason::KickFailure:   return "kick_failure";
+        case ExpansionReason::StashPressure: return "stash_pressure";
+    }
+    return "unknown";
+}
+
+unsigned MyBambooFilter::fingerprint_bits() const {
+    return fingerprint_bits_;
+}
+
+MyBambooFilter::HashPolicy MyBambooFilter::hash_policy() const {
+    return hash_policy_;
+}
+
+std::size_t MyBambooFilter::slots_per_bucket() const {
+    return slots_per_bucket_;
+}
+
+std::size_t MyBambooFilter::alternate_window_buckets() const {
+    return alt_window_;
+}
+
+const char* MyBambooFilter::hash_policy_name(HashPolicy policy) {
+    switch (policy) {
+        case HashPolicy::Fnv1a:    return "fnv1a";
+        case HashPolicy::Fnv1aMix: return "fnv1a_mix";
+        case HashPolicy::WordMix:  return "word_mix";
+    }
+    return "unknown";
 }
\ No newline at end of file
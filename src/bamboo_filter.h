@@ -2,8 +2,13 @@
 #define MY_BAMBOO_FILTER_H
 
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
+#include <functional>
+#include <map>
 #include <cstdint>
+#include <memory>  // For std::shared_ptr
 #include <utility> // For std::pair
 
 /**
@@ -14,6 +19,10 @@
  * mechanism for expansion when the load factor exceeds a defined threshold.
  * It stores a 16-bit fingerprint along with the full 64-bit hash of the item
  * to ensure correct rebuilding and to aid in certain Cuckoo eviction scenarios.
+ *
+ * Buckets are grouped into fixed-size segments held by shared pointers. Filters
+ * are move-only; clone() produces an independent filter that shares every
+ * segment and copies one only when either side first modifies it.
  */
 class MyBambooFilter {
 public:
@@ -22,6 +31,146 @@ public:
     /** @brief Type alias for a slot in the filter, storing fingerprint and full hash. */
     using Slot = std::pair<Fp, std::uint64_t>;
 
+    /** @brief Reason reported for a table expansion. */
+    enum class ExpansionReason {
+        LoadFactor,    ///< The load factor reached the configured threshold.
+        KickFailure,   ///< Too many Cuckoo kick chains failed since the last rebuild.
+        StashPressure  ///< Too many items are stashed beyond the regular bucket slots.
+    };
+
+    /**
+     * @brief Tunable expansion triggers applied in addition to the load factor threshold.
+     * Skewed key sets can overload individual buckets long before the global load factor
+     * threshold is reached; these triggers expand the table in that case as well.
+     * Setting a limit to 0 disables the corresponding trigger.
+     */
+    struct ExpansionPolicy {
+        /** @brief Failed Cuckoo kick chains (since the last rebuild) that trigger an expansion. */
+        std::size_t max_kick_failures = 16;
+        /** @brief Fraction of all regular slots that stashed items may occupy before an expansion. */
+        float max_stash_fraction = 0.01f;
+        /**
+         * @brief Load factor below which the kick failure and stash triggers are ignored.
+         * Guards against repeated doubling on degenerate inputs (e.g. colliding hashes)
+         * that a larger table cannot spread out.
+         */
+        float min_load_factor = 0.25f;
+    };
+
+    /** @brief Function used to turn key bytes into the 64-bit item hash. */
+    enum class HashPolicy {
+        Fnv1a,    ///< Byte-wise FNV-1a (the original hash).
+        Fnv1aMix, ///< FNV-1a followed by a MurmurHash3 finalizer for better high-bit diffusion.
+        WordMix   ///< Word-at-a-time multiply/xorshift hash; fastest on longer keys.
+    };
+
+    /** @brief Order in which batched lookups probe the table. */
+    enum class BatchOrder {
+        Input,       ///< Probe in input order, prefetching small groups ahead.
+        BucketSorted ///< Radix-sort by primary bucket first, probe nearly sequentially, then scatter results back.
+    };
+
+    /** @brief Outcome of classify_read(). */
+    struct ReadClassification {
+        /** @brief True if at least the threshold fraction of the read's k-mers hit the filter. */
+        bool matched;
+        /** @brief Number of valid k-mers in the read. */
+        std::size_t kmers_total;
+        /** @brief Number of k-mers actually probed before the decision was certain. */
+        std::size_t kmers_probed;
+        /** @brief Number of probed k-mers that hit. */
+        std::size_t hits;
+    };
+
+    /** @brief One stored item as reported by an EntryCursor. */
+    struct Entry {
+        std::size_t bucket;  ///< Bucket the item currently occupies
+        Fp fingerprint;      ///< Stored fingerprint
+        std::uint64_t hash;  ///< Full 64-bit item hash
+    };
+
+    class EntryCursor;
+
+    /**
+     * @brief Bucket-level difference between two versions of a filter, see diff() and apply_delta().
+     * A patch replaces one bucket's contents; slots are sent as full hashes because the
+     * fingerprint is derived from the hash. A full delta carries every non-empty bucket and
+     * also re-creates the table, for replicas whose geometry no longer matches.
+     */
+    struct Delta {
+        /** @brief New contents of one bucket. */
+        struct BucketPatch {
+            std::size_t bucket;
+            std::vector<std::uint64_t> hashes; ///< Slot hashes in slot order
+        };
+
+        bool full = false;                ///< True if the delta rebuilds the table from scratch
+        std::size_t num_buckets = 0;      ///< Bucket count of the target version
+        std::size_t slots_per_bucket = 0;
+        unsigned fingerprint_bits = 0;
+        HashPolicy hash_policy = HashPolicy::Fnv1a;
+        std::size_t alternate_window = 0; ///< alternate_window_buckets() of the target version
+        std::size_t items = 0;            ///< size() of the target version
+        std::size_t stashed_items = 0;    ///< stashed_items() of the target version
+        std::vector<BucketPatch> patches; ///< Sorted by bucket
+
+        /** @brief Returns the number of slots carried by all patches. */
+        std::size_t entry_count() const;
+
+        /**
+         * @brief Encodes the delta in a compact little-endian binary format.
+         * @return The encoded bytes.
+         */
+        std::string serialize() const;
+
+        /**
+         * @brief Decodes a delta produced by serialize().
+         * @param bytes The encoded delta.
+         * @return The delta.
+         * @throws std::runtime_error If the input is malformed or truncated.
+         */
+        static Delta deserialize(std::string_view bytes);
+    };
+
+    /** @brief Describes a single table expansion and why it happened. */
+    struct ExpansionEvent {
+        ExpansionReason reason;
+        std::size_t buckets_before;
+        std::size_t buckets_after;
+        std::size_t items;
+        float load_factor;
+        std::size_t stashed_items;
+        std::size_t kick_failures;
+    };
+
+    /** @brief Complete filter configuration, including the tunables the positional constructors leave at their defaults. */
+    struct Config {
+        /** @brief The initial number of buckets in the filter. */
+        std::size_t initial_num_buckets = 1024;
+        /** @brief The number of slots each bucket can hold before Cuckoo eviction or stashing. */
+        std::size_t slots_per_bucket = 4;
+        /** @brief The load factor at which the filter table rebuilds and expands. */
+        float load_factor_threshold = 0.95f;
+        /** @brief The maximum number of displacements allowed during a Cuckoo hashing attempt. */
+        std::size_t max_cuckoo_kicks = 500;
+        /**
+         * @brief Number of hash bits kept in each fingerprint (1..16). Fewer bits raise the false positive
+         * rate. Slots are not bit-packed, so a narrower fingerprint does not reduce memoryUsage().
+         */
+        unsigned fingerprint_bits = 16;
+        /** @brief Hash function applied to string keys. */
+        HashPolicy hash_policy = HashPolicy::Fnv1a;
+        /** @brief Additional expansion triggers. */
+        ExpansionPolicy expansion_policy;
+        /**
+         * @brief Keeps each item's alternate bucket in the same aligned window of this many bytes of
+         * bucket headers as its primary bucket, e.g. 4096 for one 4 KiB page, so both probes share a
+         * page translation. Rounded down to a power-of-two bucket count of at least 2. 0 lets the
+         * alternate bucket fall anywhere in the table.
+         */
+        std::size_t alternate_window_bytes = 0;
+    };
+
     /**
      * @brief Constructs a MyBambooFilter.
      * @param initial_num_buckets The initial number of buckets in the filter.
@@ -31,6 +180,57 @@ public:
      */
     MyBambooFilter(std::size_t initial_num_buckets, std::size_t slots_per_bucket, float load_factor_threshold, std::size_t max_cuckoo_kicks);
 
+    /**
+     * @brief Constructs a MyBambooFilter with an explicit expansion policy.
+     * @param initial_num_buckets The initial number of buckets in the filter.
+     * @param slots_per_bucket The number of slots (items) each bucket can hold before Cuckoo eviction or stashing.
+     * @param load_factor_threshold The load factor at which the filter table rebuilds and expands.
+     * @param max_cuckoo_kicks The maximum number of displacements allowed during a Cuckoo hashing attempt.
+     * @param expansion_policy Additional expansion triggers (kick failures, stash occupancy).
+     */
+    MyBambooFilter(std::size_t initial_num_buckets, std::size_t slots_per_bucket, float load_factor_threshold, std::size_t max_cuckoo_kicks,
+                   const ExpansionPolicy& expansion_policy);
+
+    /**
+     * @brief Constructs a MyBambooFilter from a complete configuration.
+     * @param config The filter configuration.
+     * @throws std::invalid_argument If the geometry is empty or the fingerprint width is outside 1..16 bits.
+     */
+    explicit MyBambooFilter(const Config& config);
+
+    /** @brief Copying is disabled: a deep copy of a large filter is expensive. Use clone(). */
+    MyBambooFilter(const MyBambooFilter&) = delete;
+    /** @brief Copying is disabled: a deep copy of a large filter is expensive. Use clone(). */
+    MyBambooFilter& operator=(const MyBambooFilter&) = delete;
+
+    /**
+     * @brief Moves a filter in constant time.
+     * The moved-from filter is left with no buckets and no items: it answers queries and erases like
+     * an empty filter, but must be assigned to before anything is inserted into it.
+     */
+    MyBambooFilter(MyBambooFilter&& other) noexcept;
+    /** @brief Move-assigns a filter in constant time; see the move constructor. */
+    MyBambooFilter& operator=(MyBambooFilter&& other) noexcept;
+
+    /**
+     * @brief Returns an independent copy that shares bucket storage copy-on-write.
+     * Costs one pointer copy per segment; a segment is duplicated the first time either
+     * filter modifies a bucket in it. Clones are not synchronized: the copy decision reads
+     * the shared reference count, so two clones that share segments must not be modified
+     * (or one modified while the other is read) concurrently without external locking.
+     * @return The clone.
+     */
+    MyBambooFilter clone() const;
+
+    /**
+     * @brief Exchanges the contents of two filters in constant time.
+     * @param other The filter to swap with.
+     */
+    void swap(MyBambooFilter& other) noexcept;
+
+    /** @brief Exchanges the contents of two filters; enables `using std::swap; swap(a, b)`. */
+    friend void swap(MyBambooFilter& a, MyBambooFilter& b) noexcept { a.swap(b); }
+
     /**
      * @brief Inserts a key into the filter.
      * If the key is already likely present (based on a `contains` check),
@@ -50,6 +250,216 @@ public:
      */
     bool contains(const std::string& key) const;
 
+    /**
+     * @brief Removes a key from the filter.
+     * Items are matched by their full 64-bit hash, so erasing a key that was never
+     * inserted cannot remove another key that merely shares its fingerprint.
+     * @param key The key to remove.
+     * @return True if a matching item was found and removed.
+     */
+    bool erase(const std::string& key);
+
+    /**
+     * @brief Inserts an integer key (a packed k-mer, a numeric ID, ...).
+     * Integer keys skip string handling entirely and are hashed with mix64(),
+     * so they do not match string keys with the same digits.
+     * @param key The key to insert.
+     */
+    void insert(std::uint64_t key);
+
+    /**
+     * @brief Checks if an integer key is possibly in the filter.
+     * @param key The key to check.
+     * @return True if the key might be in the filter, false otherwise.
+     */
+    bool contains(std::uint64_t key) const;
+
+    /**
+     * @brief Removes an integer key from the filter.
+     * @param key The key to remove.
+     * @return True if a matching item was found and removed.
+     */
+    bool erase(std::uint64_t key);
+
+    /**
+     * @brief Inserts an array of integer keys. Equivalent to calling insert() for each key, in order.
+     * @param keys Pointer to the keys.
+     * @param count Number of keys.
+     */
+    void insert_batch(const std::uint64_t* keys, std::size_t count);
+
+    /**
+     * @brief Looks up an array of integer keys with batched, prefetched probes.
+     * @param keys Pointer to the keys.
+     * @param count Number of keys.
+     * @param results Receives `count` results; results[i] corresponds to keys[i].
+     */
+    void contains_batch(const std::uint64_t* keys, std::size_t count, bool* results) const;
+
+    /**
+     * @brief Looks up an array of integer keys in the given probe order; see contains_hashed_batch().
+     * @param keys Pointer to the keys.
+     * @param count Number of keys.
+     * @param results Receives `count` results; results[i] corresponds to keys[i].
+     * @param order Probe order.
+     */
+    void contains_batch(const std::uint64_t* keys, std::size_t count, bool* results, BatchOrder order) const;
+
+    /**
+     * @brief Inserts an item given its precomputed 64-bit hash (as produced by the configured hash policy).
+     * Same semantics as insert(), without hashing a key.
+     * @param hash The 64-bit item hash.
+     */
+    void insert_hashed(std::uint64_t hash);
+
+    /**
+     * @brief Checks if an item given by its precomputed 64-bit hash is possibly in the filter.
+     * @param hash The 64-bit item hash.
+     * @return True if the item might be in the filter, false otherwise.
+     */
+    bool contains_hashed(std::uint64_t hash) const;
+
+    /**
+     * @brief Removes an item given by its precomputed 64-bit hash.
+     * @param hash The 64-bit item hash.
+     * @return True if a matching item was found and removed.
+     */
+    bool erase_hashed(std::uint64_t hash);
+
+    /**
+     * @brief Inserts a batch of items given by their precomputed 64-bit hashes.
+     * Equivalent to calling insert_hashed() for each hash, in order.
+     * @param hashes Pointer to the hashes.
+     * @param count Number of hashes.
+     */
+    void insert_hashed_batch(const std::uint64_t* hashes, std::size_t count);
+
+    /**
+     * @brief Inserts an item unless one with the same full 64-bit hash is stored.
+     * insert_hashed() skips an item whose fingerprint is already present, so the item is
+     * represented only by a look-alike. This stores it anyway, giving every distinct hash
+     * an entry of its own; erase_hashed(), entries() and range extraction then see it, and
+     * a kick that moves the look-alike cannot hide it. Costs one slot per distinct hash.
+     * @param hash The 64-bit item hash.
+     * @return True if the item was added, false if the hash was already stored.
+     */
+    bool insert_distinct_hashed(std::uint64_t hash);
+
+    /**
+     * @brief Looks up a batch of items given by their precomputed 64-bit hashes.
+     * Bucket addresses are computed and prefetched for a group of items before
+     * any of them is probed, so the memory accesses of the group overlap.
+     * @param hashes Pointer to the hashes.
+     * @param count Number of hashes.
+     * @param results Receives `count` results; results[i] corresponds to hashes[i].
+     */
+    void contains_hashed_batch(const std::uint64_t* hashes, std::size_t count, bool* results) const;
+
+    /**
+     * @brief Looks up a batch of pre-hashed items in the given probe order.
+     * BucketSorted groups the items by the top bits of their primary bucket with one
+     * counting-sort pass and probes them group by group, so a large batch walks the table
+     * nearly sequentially; results are scattered back to input order. It allocates about
+     * 15 bytes of scratch memory per item. Batches with fewer items than half the bucket
+     * count are probed in input order, because their neighbouring probes would still be
+     * pages apart. The gain is largest with Config::alternate_window_bytes set, since the
+     * alternate buckets then follow the same order.
+     * @param hashes Pointer to the hashes.
+     * @param count Number of hashes.
+     * @param results Receives `count` results; results[i] corresponds to hashes[i].
+     * @param order Probe order.
+     */
+    void contains_hashed_batch(const std::uint64_t* hashes, std::size_t count, bool* results, BatchOrder order) const;
+
+    /**
+     * @brief Inserts the rows of a string column in Arrow layout, without building per-row strings.
+     * Row i spans `data[offsets[i]]` to `data[offsets[i + 1]]` (exclusive) and is hashed like insert().
+     * For a sliced array, pass the offsets advanced to the slice's first offset, the unadvanced
+     * validity bitmap and the slice offset as `validity_offset`. All offsets are checked before
+     * any row is inserted, so invalid offsets leave the filter unchanged.
+     * @param offsets `n + 1` row offsets (Arrow String).
+     * @param data The concatenated row bytes.
+     * @param n Number of rows.
+     * @param validity Optional LSB-first validity bitmap; null rows are skipped. nullptr means all rows are valid.
+     * @param validity_offset Bit of `validity` that describes row 0; need not be a multiple of 8.
+     * @return The number of items added. Rows whose fingerprint is already stored, like repeated
+     * values, are not added again and not counted.
+     * @throws std::invalid_argument If an offset is negative or smaller than its predecessor.
+     */
+    std::size_t insert_column(const std::int32_t* offsets, const char* data, std::size_t n,
+                              const std::uint8_t* validity = nullptr, std::size_t validity_offset = 0);
+    /** @brief insert_column() for 64-bit offsets (Arrow LargeString). */
+    std::size_t insert_column(const std::int64_t* offsets, const char* data, std::size_t n,
+                              const std::uint8_t* validity = nullptr, std::size_t validity_offset = 0);
+
+    /**
+     * @brief Looks up the rows of a string column in Arrow layout with batched, prefetched probes.
+     * @param offsets `n + 1` row offsets (Arrow String).
+     * @param data The concatenated row bytes.
+     * @param n Number of rows.
+     * @param out_bitmap Receives `(n + 7) / 8` bytes; bit i (LSB first) is set if row i is possibly
+     * present. Null rows get 0, so the result can serve directly as a validity or selection bitmap.
+     * @param validity Optional LSB-first validity bitmap. nullptr means all rows are valid.
+     * @param validity_offset Bit of `validity` that describes row 0, as for insert_column().
+     * The output bitmap always starts at bit 0.
+     * @throws std::invalid_argument If an offset is negative or smaller than its predecessor.
+     */
+    void contains_column(const std::int32_t* offsets, const char* data, std::size_t n, std::uint8_t* out_bitmap,
+                         const std::uint8_t* validity = nullptr, std::size_t validity_offset = 0) const;
+    /** @brief contains_column() for 64-bit offsets (Arrow LargeString). */
+    void contains_column(const std::int64_t* offsets, const char* data, std::size_t n, std::uint8_t* out_bitmap,
+                         const std::uint8_t* validity = nullptr, std::size_t validity_offset = 0) const;
+
+    /**
+     * @brief Inserts every canonical k-mer of a DNA sequence.
+     * K-mers are 2-bit encoded with an O(1) rolling update and hashed with mix64(),
+     * without building a string per k-mer. Line breaks are skipped and non-ACGT
+     * characters (e.g. N) break the k-mer window. A filter should hold k-mers of a
+     * single k, since equal packed codes of different lengths hash identically.
+     * @param sequence The DNA sequence.
+     * @param k The k-mer length (1..32).
+     * @return The number of k-mers processed.
+     * @throws std::invalid_argument If k is out of range.
+     */
+    std::size_t insert_kmers(std::string_view sequence, unsigned k);
+
+    /**
+     * @brief Counts how many canonical k-mers of a DNA sequence are possibly in the filter.
+     * @param sequence The DNA sequence.
+     * @param k The k-mer length (1..32).
+     * @return The number of k-mers for which the filter reports a (possible) hit.
+     * @throws std::invalid_argument If k is out of range.
+     */
+    std::size_t count_present_kmers(std::string_view sequence, unsigned k) const;
+
+    /**
+     * @brief Decides whether a read belongs to the k-mer set stored in the filter.
+     * A read matches if at least `threshold` (0..1) of its canonical k-mers hit.
+     * K-mers are probed in small batches and probing stops as soon as the hits so far
+     * reach the required count, or the remaining k-mers could no longer reach it.
+     * @param sequence The read sequence.
+     * @param k The k-mer length used to build the filter (1..32).
+     * @param threshold Required fraction of hitting k-mers.
+     * @return The decision and how much probing it took. Reads without valid k-mers never match.
+     * @throws std::invalid_argument If k is out of range.
+     */
+    ReadClassification classify_read(std::string_view sequence, unsigned k, float threshold) const;
+
+    /**
+     * @brief Hashes a key with the configured hash policy, as insert() and contains() do.
+     * @param key The key to hash.
+     * @return The 64-bit item hash.
+     */
+    std::uint64_t hash_of(std::string_view key) const;
+
+    /**
+     * @brief Hashes a key with an explicit hash policy, for structures that share this filter's hashing.
+     * @param policy The hash policy.
+     * @param key The key to hash.
+     * @return The 64-bit item hash.
+     */
+    static std::uint64_t hash_with_policy(HashPolicy policy, std::string_view key);
+
     /**
      * @brief Returns the number of items currently estimated to be in the filter.
      * This count reflects items successfully passed to the insertion logic.
@@ -64,6 +474,29 @@ public:
      */
     std::size_t capacity_buckets() const;
 
+    /**
+     * @brief Returns the fingerprint stored for a hash. A false positive for `hash` can only be
+     * caused by a stored item with the same fingerprint.
+     * @param hash The 64-bit item hash.
+     * @return The fingerprint (never 0).
+     */
+    std::uint16_t fingerprint_of(std::uint64_t hash) const;
+
+    /**
+     * @brief Returns the primary bucket of a hash in a table of `num_buckets` buckets.
+     * Together with alternate_bucket() this lets another table reproduce this filter's layout.
+     */
+    static std::size_t primary_bucket(std::uint64_t hash, std::size_t num_buckets);
+
+    /**
+     * @brief Returns the alternate of a primary bucket, as contains() probes it.
+     * @param primary The primary bucket.
+     * @param fp The item's fingerprint.
+     * @param num_buckets Buckets in the table.
+     * @param window alternate_window_buckets() of the filter; 0 if the window spans the table.
+     */
+    static std::size_t alternate_bucket(std::size_t primary, Fp fp, std::size_t num_buckets, std::size_t window);
+
     /**
      * @brief Calculates the current load factor of the filter.
      * Load factor = (number of items) / (total number of slots).
@@ -78,9 +511,212 @@ public:
      */
     std::size_t memoryUsage() const;
 
+    /**
+     * @brief Returns the number of items stored beyond the regular slots of their bucket.
+     * @return The number of stashed items.
+     */
+    std::size_t stashed_items() const;
+
+    /**
+     * @brief Returns how many times a stored item has moved to its other bucket, through
+     * Cuckoo kicks or compaction, since construction. Rebuilds are not counted; see
+     * expansion_history(). A cached answer that relied on where items sat is stale once
+     * this changes.
+     * @return The number of relocations.
+     */
+    std::size_t relocations() const;
+
+    /**
+     * @brief Runs a full compaction pass: see compact_step().
+     * @return The number of bytes by which memoryUsage() dropped.
+     */
+    std::size_t compact();
+
+    /**
+     * @brief Compacts up to `max_buckets` buckets, continuing where the previous step stopped.
+     * Stashed items are moved to their alternate bucket when it has a free regular slot, and
+     * each bucket's storage is reallocated to its exact size. When a pass reaches the end of
+     * the table, freed heap memory is handed back to the operating system. Interleave small
+     * steps with regular operations to spread the work; a rebuild restarts the pass.
+     * @param max_buckets Maximum number of buckets to process in this step.
+     * @return True if this step completed a pass over the whole table.
+     */
+    bool compact_step(std::size_t max_buckets);
+
+    /**
+     * @brief Returns a cursor over every stored item, in bucket order.
+     * The cursor holds the table's segments, so it sees a consistent snapshot and stays
+     * valid while the filter is modified (or even destroyed); while it is alive, the first
+     * write to each segment copies that segment.
+     * @return The cursor.
+     */
+    EntryCursor entries() const;
+
+    /**
+     * @brief Returns a cursor over the items stored in buckets [first_bucket, last_bucket).
+     * @param first_bucket First bucket, inclusive.
+     * @param last_bucket Last bucket, exclusive; clamped to capacity_buckets().
+     * @return The cursor.
+     */
+    EntryCursor entries(std::size_t first_bucket, std::size_t last_bucket) const;
+
+    /**
+     * @brief Splits the table into contiguous bucket ranges, one cursor each.
+     * Ranges are whole segments when the table has at least `num_parts` of them, so cursors
+     * share no segment; rounding to segments can yield fewer than `num_parts` cursors.
+     * @param num_parts Requested number of cursors (at least 1 is returned).
+     * @return Cursors covering every bucket exactly once.
+     */
+    std::vector<EntryCursor> partition_entries(std::size_t num_parts) const;
+
+    /**
+     * @brief Calls `fn(entry, worker)` for every stored item, using `num_workers` threads
+     * that each walk one range of partition_entries(). Calls from one worker are in bucket order.
+     * @param num_workers Number of threads (0 is treated as 1).
+     * @param fn Callback; must be safe to call concurrently from different workers.
+     * @return The number of items visited.
+     */
+    std::size_t for_each_entry_parallel(std::size_t num_workers,
+                                        const std::function<void(const Entry&, std::size_t)>& fn) const;
+
+    /**
+     * @brief Computes the buckets that differ between two versions of a filter.
+     * Segments that `from` and `to` still share (e.g. after clone()) are skipped without
+     * being compared. If the bucket counts differ (one side was rebuilt), the result is a
+     * full delta of `to`.
+     * @param from The version a replica currently holds.
+     * @param to The version the replica should end up with.
+     * @return The delta turning `from` into `to`.
+     * @throws std::invalid_argument If slots per bucket, fingerprint widths, hash policies or
+     * alternate-bucket windows differ.
+     */
+    static Delta diff(const MyBambooFilter& from, const MyBambooFilter& to);
+
+    /**
+     * @brief Returns a full delta that rebuilds this filter's table on a replica.
+     * @return The delta.
+     */
+    Delta full_delta() const;
+
+    /**
+     * @brief Records the current version so that diff_since() can later compute changes from it.
+     * A snapshot keeps the current segments alive; the first write to each segment afterwards
+     * copies it, so release snapshots that are no longer needed.
+     * @return The snapshot ID.
+     */
+    std::uint64_t take_snapshot();
+
+    /**
+     * @brief Computes the changes made since a snapshot; a full delta if the table was rebuilt since.
+     * @param snapshot_id ID returned by take_snapshot().
+     * @return The delta from the snapshot to the current version.
+     * @throws std::invalid_argument If the ID is unknown or was released.
+     */
+    Delta diff_since(std::uint64_t snapshot_id) const;
+
+    /**
+     * @brief Forgets a snapshot, releasing the segments only it was keeping alive.
+     * @param snapshot_id ID returned by take_snapshot().
+     * @return True if the snapshot existed.
+     */
+    bool release_snapshot(std::uint64_t snapshot_id);
+
+    /**
+     * @brief Patches this filter in place. Unless the delta is full, this filter must hold the
+     * version the delta was computed from.
+     * @param delta The delta to apply.
+     * @throws std::invalid_argument If the delta is not full and its geometry does not match.
+     */
+    void apply_delta(const Delta& delta);
+
+    /** @brief Returns the expansion policy currently in effect. */
+    const ExpansionPolicy& expansion_policy() const;
+
+    /**
+     * @brief Replaces the expansion policy. Takes effect on the next insertion.
+     * @param policy The new policy.
+     */
+    void set_expansion_policy(const ExpansionPolicy& policy);
+
+    /**
+     * @brief Returns every expansion performed so far, oldest first, with its trigger.
+     * @return The expansion history.
+     */
+    const std::vector<ExpansionEvent>& expansion_history() const;
+
+    /**
+     * @brief Returns a printable name for an expansion reason.
+     * @param reason The reason.
+     * @return A static, null-terminated string.
+     */
+    static const char* expansion_reason_name(ExpansionReason reason);
+
+    /** @brief Returns the number of bits kept in each fingerprint. */
+    unsigned fingerprint_bits() const;
+
+    /** @brief Returns the configured slots per bucket; a bucket with stashed items holds more. */
+    std::size_t slots_per_bucket() const;
+
+    /** @brief Returns the hash function applied to string keys. */
+    HashPolicy hash_policy() const;
+
+    /** @brief Returns the number of buckets an alternate-bucket window spans, or 0 if it spans the table. */
+    std::size_t alternate_window_buckets() const;
+
+    /**
+     * @brief Returns a printable name for a hash policy.
+     * @param policy The policy.
+     * @return A static, null-terminated string.
+     */
+    static const char* hash_policy_name(HashPolicy policy);
+
+    /**
+     * @brief MurmurHash3 64-bit finalizer. Bijective, so distinct inputs keep distinct hashes.
+     * @param x The value to mix.
+     * @return The mixed value.
+     */
+    static std::uint64_t mix64(std::uint64_t x);
+
 private:
-    /** @brief The main table storing buckets, where each bucket is a vector of Slots. */
-    std::vector<std::vector<Slot>> table_;
+    /** @brief Gives the per-primitive microbenchmarks (bench/microbench.cpp) access to the internals they time. */
+    friend struct MyBambooFilterBenchAccess;
+
+    /** @brief A bucket: its regular slots followed by any stashed items. */
+    using Bucket = std::vector<Slot>;
+
+    /** @brief Number of buckets per segment, the unit of copy-on-write sharing (a power of two). */
+    static constexpr std::size_t kSegmentBuckets = 4096;
+    static constexpr unsigned kSegmentShift = 12;
+
+    /**
+     * @brief A contiguous run of kSegmentBuckets buckets. The last segment holds only the
+     * buckets left over, so a small table does not pay for a whole segment.
+     */
+    struct Segment {
+        std::vector<Bucket> buckets;
+    };
+
+    /** @brief Selects the copy constructor used by clone(). */
+    struct CloneTag {};
+    MyBambooFilter(const MyBambooFilter& other, CloneTag);
+
+    /** @brief The table, as segments that may be shared with clones. */
+    std::vector<std::shared_ptr<Segment>> segments_;
+
+    /** @brief Returns bucket `i` for reading. */
+    const Bucket& bucket(std::size_t i) const {
+        return segments_[i >> kSegmentShift]->buckets[i & (kSegmentBuckets - 1)];
+    }
+
+    /** @brief Returns bucket `i` for writing, first copying its segment if a clone shares it. */
+    Bucket& mutable_bucket(std::size_t i) {
+        auto& segment = segments_[i >> kSegmentShift];
+        if (segment.use_count() > 1) segment = std::make_shared<Segment>(*segment);
+        return segment->buckets[i & (kSegmentBuckets - 1)];
+    }
+
+    /** @brief Replaces the table with `num_buckets` empty buckets. */
+    void reset_segments(std::size_t num_buckets);
 
     /** @brief Current number of buckets in the filter. */
     std::size_t num_buckets_;
@@ -90,19 +726,53 @@ private:
     float max_load_factor_;
     /** @brief Maximum number of kicks in a Cuckoo path before stashing. */
     std::size_t max_cuckoo_kicks_;
+    /** @brief Number of hash bits kept in each fingerprint. */
+    unsigned fingerprint_bits_;
+    /** @brief Hash function applied to string keys. */
+    HashPolicy hash_policy_;
+    /** @brief Buckets per alternate-bucket window (a power of two), or 0 for the whole table. */
+    std::size_t alt_window_{0};
     /** @brief Number of items currently in the filter. */
     std::size_t current_items_count_{0};
+    /** @brief Number of items stored beyond the regular slots of their bucket. */
+    std::size_t stashed_items_count_{0};
+    /** @brief Number of Cuckoo kick chains that ended in a stash since the last rebuild. */
+    std::size_t kick_failures_since_rebuild_{0};
+    /** @brief Additional expansion triggers. */
+    ExpansionPolicy expansion_policy_;
+    /** @brief Log of all expansions performed so far. */
+    std::vector<ExpansionEvent> expansion_history_;
+    /** @brief Next bucket an incremental compaction pass will process. */
+    std::size_t compact_cursor_{0};
+    /** @brief Items moved between their two buckets by kicks or compaction; see relocations(). */
+    std::size_t relocations_{0};
+    /** @brief A version recorded by take_snapshot(). */
+    struct Snapshot {
+        std::size_t num_buckets;
+        std::vector<std::shared_ptr<Segment>> segments;
+    };
+    /** @brief Snapshots by ID; not carried over by clone(). */
+    std::map<std::uint64_t, Snapshot> snapshots_;
+    /** @brief ID handed out by the next take_snapshot(). */
+    std::uint64_t next_snapshot_id_{1};
+
+    /**
+     * @brief Diffs a table given as segments against this filter's current table.
+     * Both must have num_buckets_ buckets.
+     */
+    Delta diff_segments(const std::vector<std::shared_ptr<Segment>>& from) const;
 
     /**
      * @brief Internal method to perform the actual insertion logic (Cuckoo hashing, stashing).
      * This is called by both `insert()` and `rebuild_table()`.
      * @param original_hash_of_item The full 64-bit hash of the item to insert.
+     * @return True if the item (or a displaced victim) found a regular slot, false if one had to be stashed.
      */
-    void _attempt_insert_or_kick(std::uint64_t original_hash_of_item);
+    bool _attempt_insert_or_kick(std::uint64_t original_hash_of_item);
 
     /**
-     * @brief Checks if the filter needs to expand based on the current load factor
-     * and triggers a rebuild if necessary.
+     * @brief Checks if the filter needs to expand based on the current load factor,
+     * failed kick chains and stash occupancy, and triggers a rebuild if necessary.
      */
     void maybe_expand();
 
@@ -110,8 +780,9 @@ private:
      * @brief Rebuilds the filter table, typically by doubling its capacity,
      * and re-inserts all existing items. This is a "stop-the-world" operation
      * that ensures all items are correctly placed after expansion using their full hashes.
+     * @param reason The trigger recorded in the expansion history.
      */
-    void rebuild_table();
+    void rebuild_table(ExpansionReason reason);
 
     // Hashing utility methods
     /**
@@ -122,12 +793,27 @@ private:
      */
     static std::uint64_t fnv1a_hash_str(const void* data, std::size_t len);
     /**
-     * @brief Extracts a 16-bit fingerprint from a 64-bit hash.
+     * @brief Computes a 64-bit hash reading the data one 64-bit word at a time.
+     * @param data Pointer to the data to hash.
+     * @param len Length of the data in bytes.
+     * @return 64-bit hash value.
+     */
+    static std::uint64_t word_mix_hash(const void* data, std::size_t len);
+    /**
+     * @brief Hashes key bytes with the configured hash policy.
+     * @param data Pointer to the data to hash.
+     * @param len Length of the data in bytes.
+     * @return 64-bit hash value.
+     */
+    std::uint64_t hash_key(const void* data, std::size_t len) const;
+    /**
+     * @brief Extracts a fingerprint of up to 16 bits from a 64-bit hash.
      * Ensures the fingerprint is non-zero.
      * @param h The 64-bit hash.
-     * @return 16-bit fingerprint.
+     * @param bits Number of low hash bits kept (1..16).
+     * @return The fingerprint.
      */
-    static Fp fingerprint_from_hash_val(std::uint64_t h);
+    static Fp fingerprint_from_hash_val(std::uint64_t h, unsigned bits = 16);
     /**
      * @brief Calculates the primary bucket index from a 64-bit hash.
      * @param h The 64-bit hash.
@@ -143,6 +829,132 @@ private:
      * @return Alternate bucket index.
      */
     static std::size_t alt_index_from_fp_val(std::size_t primary_idx, Fp fp, std::size_t num_buckets_param);
+    /**
+     * @brief Calculates the alternate bucket index within the aligned window holding the primary bucket.
+     * @param primary_idx The primary bucket index.
+     * @param fp The fingerprint of the item.
+     * @param num_buckets_param Current number of buckets in the table.
+     * @param window Buckets per window; a power of two.
+     * @return Alternate bucket index.
+     */
+    static std::size_t alt_index_in_window(std::size_t primary_idx, Fp fp, std::size_t num_buckets_param, std::size_t window);
+    /** @brief Alternate bucket index under this filter's window setting. */
+    std::size_t alt_index(std::size_t primary_idx, Fp fp) const {
+        return alt_window_ == 0 ? alt_index_from_fp_val(primary_idx, fp, num_buckets_)
+                                : alt_index_in_window(primary_idx, fp, num_buckets_, alt_window_);
+    }
+};
+
+/**
+ * @brief Streams the items stored in a range of buckets of a MyBambooFilter.
+ * Obtained from MyBambooFilter::entries() or partition_entries(); holds references to
+ * the segments it covers, so nothing is copied up front and later writes to the filter
+ * are not observed.
+ */
+class MyBambooFilter::EntryCursor {
+public:
+    /**
+     * @brief Advances to the next item.
+     * @param out Receives the item.
+     * @return False once the range is exhausted.
+     */
+    bool next(Entry& out);
+
+    /**
+     * @brief Reads up to `max_entries` items.
+     * @param out Destination array.
+     * @param max_entries Capacity of `out`.
+     * @return The number of items written; 0 once the range is exhausted.
+     */
+    std::size_t next_batch(Entry* out, std::size_t max_entries);
+
+    /** @brief Returns the first bucket of the range. */
+    std::size_t first_bucket() const;
+
+    /** @brief Returns one past the last bucket of the range. */
+    std::size_t last_bucket() const;
+
+private:
+    friend class MyBambooFilter;
+    EntryCursor(std::vector<std::shared_ptr<const Segment>> segments, std::size_t first_bucket, std::size_t last_bucket);
+
+    std::vector<std::shared_ptr<const Segment>> segments_; ///< Segments covering the range, starting at first_segment_
+    std::size_t first_segment_;
+    std::size_t first_bucket_;
+    std::size_t last_bucket_;
+    std::size_t bucket_; ///< Current bucket
+    std::size_t slot_;   ///< Next slot within the current bucket
+};
+
+/**
+ * @brief Maps a key type to the 64-bit item hash used by MyBambooFilter.
+ * Integral keys are hashed with MyBambooFilter::mix64() and string-like keys with the
+ * filter's hash policy. Specialize for other key types; the filter is passed in so
+ * a specialization can reuse its hash policy.
+ */
+template <typename Key, typename Enable = void>
+struct BambooKeyHash;
+
+template <typename Key>
+struct BambooKeyHash<Key, std::enable_if_t<std::is_integral_v<Key>>> {
+    std::uint64_t operator()(const MyBambooFilter&, Key key) const {
+        return MyBambooFilter::mix64(static_cast<std::uint64_t>(key));
+    }
+};
+
+template <typename Key>
+struct BambooKeyHash<Key, std::enable_if_t<std::is_convertible_v<const Key&, std::string_view>>> {
+    std::uint64_t operator()(const MyBambooFilter& filter, const Key& key) const {
+        return filter.hash_of(std::string_view(key));
+    }
+};
+
+/**
+ * @brief MyBambooFilter restricted to one key type, e.g. `KeyedBambooFilter<std::uint64_t>`
+ * for numeric IDs. Keys are hashed once through `Hash` and every operation goes
+ * straight to the hashed entry points, so no string objects are created.
+ * @tparam Key The key type.
+ * @tparam Hash Functor `std::uint64_t(const MyBambooFilter&, const Key&)`.
+ */
+template <typename Key, typename Hash = BambooKeyHash<Key>>
+class KeyedBambooFilter {
+public:
+    /** @brief Constructs the underlying filter from a configuration. */
+    explicit KeyedBambooFilter(const MyBambooFilter::Config& config, Hash hash = Hash())
+      : filter_(config), hash_(hash) {}
+
+    void insert(const Key& key) { filter_.insert_hashed(hash_(filter_, key)); }
+    bool contains(const Key& key) const { return filter_.contains_hashed(hash_(filter_, key)); }
+    bool erase(const Key& key) { return filter_.erase_hashed(hash_(filter_, key)); }
+
+    /** @brief Inserts `count` keys, hashing them in blocks before the batched insert. */
+    void insert_batch(const Key* keys, std::size_t count) {
+        std::uint64_t hashes[kBlock];
+        for (std::size_t base = 0; base < count; base += kBlock) {
+            const std::size_t n = count - base < kBlock ? count - base : kBlock;
+            for (std::size_t i = 0; i < n; ++i) hashes[i] = hash_(filter_, keys[base + i]);
+            filter_.insert_hashed_batch(hashes, n);
+        }
+    }
+
+    /** @brief Looks up `count` keys; results[i] corresponds to keys[i]. */
+    void contains_batch(const Key* keys, std::size_t count, bool* results) const {
+        std::uint64_t hashes[kBlock];
+        for (std::size_t base = 0; base < count; base += kBlock) {
+            const std::size_t n = count - base < kBlock ? count - base : kBlock;
+            for (std::size_t i = 0; i < n; ++i) hashes[i] = hash_(filter_, keys[base + i]);
+            filter_.contains_hashed_batch(hashes, n, results + base);
+        }
+    }
+
+    /** @brief Returns the underlying filter (statistics, hashed operations). */
+    const MyBambooFilter& filter() const { return filter_; }
+    MyBambooFilter& filter() { return filter_; }
+
+private:
+    static constexpr std::size_t kBlock = 256;
+    MyBambooFilter filter_;
+    Hash hash_;
 };
 
 #endif // MY_BAMBOO_FILTER_H
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef MY_BAMBOO_TRACE_H
+#define MY_BAMBOO_TRACE_H
+
+/**
+ * @file bamboo_trace.h
+ * @brief Tracepoints on MyBambooFilter's hot paths, selected at compile time.
+ *
+ * Three backends, in order of precedence:
+ *
+ * - Observer: define BAMBOO_TRACE_OBSERVER as a type with the static member
+ *   functions below (and BAMBOO_TRACE_OBSERVER_HEADER as the quoted header that
+ *   declares it). Calls are direct and inlinable; use this for in-process collectors.
+ * - USDT: with BAMBOO_ENABLE_USDT defined and <sys/sdt.h> available, every hook is a
+ *   static probe in provider `bamboo`. An unattached probe is a single nop, so a
+ *   regular release build can be traced in production, e.g.
+ *   `bpftrace -e 'usdt:./BambooFilterTest:bamboo:kick_chain /arg1 > 100/ { @[arg2] = count(); }'`.
+ * - Otherwise every hook expands to nothing.
+ *
+ * Hooks and their arguments (the probe names of the USDT backend):
+ *   contains(hash, found)                    every contains_hashed() call
+ *   kick_chain(hash, kicks, stashed)         an insert that had to evict; `hash` is the inserted item
+ *   expand(reason, load_permille, kick_failures, stashed_items)
+ *                                            maybe_expand() decided to grow; reason is an ExpansionReason
+ *   rebuild_begin(buckets, items)            rebuild_table() starts
+ *   rebuild_end(buckets, items, stashed_items)
+ *                                            rebuild_table() finished; the gap to rebuild_begin is the stall
+ *
+ * Observer interface:
+ * @code
+ * struct MyObserver {
+ *     static void on_contains(std::uint64_t hash, bool found);
+ *     static void on_kick_chain(std::uint64_t hash, std::size_t kicks, bool stashed);
+ *     static void on_expand(int reason, unsigned load_permille, std::size_t kick_failures, std::size_t stashed_items);
+ *     static void on_rebuild_begin(std::size_t buckets, std::size_t items);
+ *     static void on_rebuild_end(std::size_t buckets, std::size_t items, std::size_t stashed_items);
+ * };
+ * @endcode
+ */
+
+#if defined(BAMBOO_TRACE_OBSERVER)
+
+#if defined(BAMBOO_TRACE_OBSERVER_HEADER)
+#include BAMBOO_TRACE_OBSERVER_HEADER
+#endif
+
+#define BAMBOO_TRACE_CONTAINS(hash, found) BAMBOO_TRACE_OBSERVER::on_contains((hash), (found))
+#define BAMBOO_TRACE_KICK_CHAIN(hash, kicks, stashed) BAMBOO_TRACE_OBSERVER::on_kick_chain((hash), (kicks), (stashed))
+#define BAMBOO_TRACE_EXPAND(reason, load_permille, kick_failures, stashed_items) \
+    BAMBOO_TRACE_OBSERVER::on_expand((reason), (load_permille), (kick_failures), (stashed_items))
+#define BAMBOO_TRACE_REBUILD_BEGIN(buckets, items) BAMBOO_TRACE_OBSERVER::on_rebuild_begin((buckets), (items))
+#define BAMBOO_TRACE_REBUILD_END(buckets, items, stashed_items) \
+    BAMBOO_TRACE_OBSERVER::on_rebuild_end((buckets), (items), (stashed_items))
+
+#elif defined(BAMBOO_ENABLE_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BAMBOO_TRACE_USDT 1
+#define BAMBOO_TRACE_CONTAINS(hash, found) DTRACE_PROBE2(bamboo, contains, (hash), (found))
+#define BAMBOO_TRACE_KICK_CHAIN(hash, kicks, stashed) DTRACE_PROBE3(bamboo, kick_chain, (hash), (kicks), (stashed))
+#define BAMBOO_TRACE_EXPAND(reason, load_permille, kick_failures, stashed_items) \
+    DTRACE_PROBE4(bamboo, expand, (reason), (load_permille), (kick_failures), (stashed_items))
+#define BAMBOO_TRACE_REBUILD_BEGIN(buckets, items) DTRACE_PROBE2(bamboo, rebuild_begin, (buckets), (items))
+#define BAMBOO_TRACE_REBUILD_END(buckets, items, stashed_items) \
+    DTRACE_PROBE3(bamboo, rebuild_end, (buckets), (items), (stashed_items))
+#endif
+
+#endif
+
+#if !defined(BAMBOO_TRACE_OBSERVER) && !defined(BAMBOO_TRACE_USDT)
+#define BAMBOO_TRACE_CONTAINS(hash, found) ((void)0)
+#define BAMBOO_TRACE_KICK_CHAIN(hash, kicks, stashed) ((void)0)
+#define BAMBOO_TRACE_EXPAND(reason, load_permille, kick_failures, stashed_items) ((void)0)
+#define BAMBOO_TRACE_REBUILD_BEGIN(buckets, items) ((void)0)
+#define BAMBOO_TRACE_REBUILD_END(buckets, items, stashed_items) ((void)0)
+#endif
+
+#endif // MY_BAMBOO_TRACE_H
@@ -0,0 +1,72 @@
+#ifndef MY_BAMBOO_BOUNDED_QUEUE_H
+#define MY_BAMBOO_BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * @file bounded_queue.h
+ * @brief Blocking multi-producer/multi-consumer queue with a fixed capacity,
+ * used to connect pipeline stages without unbounded buffering.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * @brief Constructs an empty queue.
+     * @param capacity Maximum number of queued items; push() blocks while the queue is full.
+     */
+    explicit BoundedQueue(std::size_t capacity) : capacity_(capacity == 0 ? 1 : capacity) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Appends an item, blocking while the queue is full.
+     * @param item The item to append.
+     * @return False if the queue was closed (the item is dropped).
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item, blocking while the queue is empty and open.
+     * @param out Receives the item.
+     * @return False once the queue is closed and drained.
+     */
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+        out = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /** @brief Closes the queue: pending items can still be popped, further pushes fail. */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+private:
+    std::size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
+#endif // MY_BAMBOO_BOUNDED_QUEUE_H
@@ -0,0 +1,306 @@
+#include "fastx_reader.h"
+#include "bamboo_filter.h"
+#include "bounded_queue.h"
+#include "inflate.h"
+#include "kmer.h"
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+//================================================================================
+// Record boundaries
+//================================================================================
+
+/** @brief Returns the index just past the end of the line starting at `pos`. */
+std::size_t line_end(std::string_view data, std::size_t pos) {
+    const std::size_t nl = data.find('\n', pos);
+    return nl == std::string_view::npos ? data.size() : nl + 1;
+}
+
+/** @brief Length of a line without its terminating "\n" or "\r\n". */
+std::size_t trimmed_length(std::string_view data, std::size_t begin, std::size_t end) {
+    while (end > begin && (data[end - 1] == '\n' || data[end - 1] == '\r')) --end;
+    return end - begin;
+}
+
+bool detect_format(std::string_view data, FastxReader::Format& format) {
+    for (char c : data) {
+        if (c == '>') { format = FastxReader::Format::Fasta; return true; }
+        if (c == '@') { format = FastxReader::Format::Fastq; return true; }
+        if (c != '\n' && c != '\r' && c != ' ' && c != '\t') break;
+    }
+    return false;
+}
+
+/**
+ * @brief Finds the first record start at or after `from`, or npos if it cannot be decided from `data`.
+ * FASTQ quality lines may start with '@', so a FASTQ candidate is only accepted if
+ * it is followed by a sequence line, a '+' line and a quality line of equal length.
+ * Multi-line FASTQ records therefore never produce a boundary and end up in one chunk.
+ */
+std::size_t next_record_start(std::string_view data, std::size_t from, FastxReader::Format format) {
+    const char marker = format == FastxReader::Format::Fasta ? '>' : '@';
+    for (std::size_t pos = from; pos < data.size(); ++pos) {
+        pos = data.find(marker, pos);
+        if (pos == std::string_view::npos) return std::string_view::npos;
+        if (pos != 0 && data[pos - 1] != '\n') continue;
+        if (format == FastxReader::Format::Fasta) return pos;
+
+        const std::size_t seq = line_end(data, pos);
+        const std::size_t plus = line_end(data, seq);
+        const std::size_t qual = line_end(data, plus);
+        const std::size_t next = line_end(data, qual);
+        if (qual >= data.size() || data[next - 1] != '\n') return std::string_view::npos; // Needs more data
+        if (data[plus] == '+' && trimmed_length(data, seq, plus) == trimmed_length(data, qual, next)) return pos;
+    }
+    return std::string_view::npos;
+}
+
+/**
+ * @brief Emits chunks of whole records from `data` and returns how many bytes were emitted.
+ * Without `final`, the trailing partial chunk is left for the next call.
+ */
+std::size_t split_chunks(std::string_view data, bool final, std::size_t chunk_bytes,
+                         const std::function<void(std::string_view)>& fn) {
+    FastxReader::Format format;
+    if (!detect_format(data, format)) {
+        return final || data.size() > chunk_bytes ? data.size() : 0; // Nothing parseable (yet)
+    }
+    std::size_t start = 0;
+    while (data.size() - start > chunk_bytes) {
+        const std::size_t boundary = next_record_start(data, start + chunk_bytes, format);
+        if (boundary == std::string_view::npos) break;
+        fn(data.substr(start, boundary - start));
+        start = boundary;
+    }
+    if (final && start < data.size()) {
+        fn(data.substr(start));
+        start = data.size();
+    }
+    return start;
+}
+
+} // namespace
+
+//================================================================================
+// FastxReader
+//================================================================================
+
+FastxReader::FastxReader(const std::string& path) : path_(path) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) throw std::runtime_error("Cannot open " + path);
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ == 0) return;
+
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        ::close(fd_);
+        throw std::runtime_error("Cannot mmap " + path);
+    }
+    ::madvise(mapping, size_, MADV_SEQUENTIAL); // Read-ahead aggressively, drop pages behind us
+    data_ = static_cast<const char*>(mapping);
+}
+
+FastxReader::~FastxReader() {
+    if (data_ != nullptr) ::munmap(const_cast<char*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool FastxReader::is_gzip() const {
+    return inflate::is_gzip(data_, size_);
+}
+
+void FastxReader::for_each_chunk(std::size_t chunk_bytes, const std::function<void(std::string_view)>& fn) const {
+    if (size_ == 0) return;
+    if (!is_gzip()) {
+        split_chunks(std::string_view(data_, size_), true, chunk_bytes, fn);
+        return;
+    }
+    inflate::gunzip(data_, size_, [&](const char* data, std::size_t len, bool final) {
+        return split_chunks(std::string_view(data, len), final, chunk_bytes, fn);
+    }, 2 * chunk_bytes);
+}
+
+std::size_t FastxReader::parse_chunk(std::string_view chunk, const std::function<void(const FastxRecord&)>& fn) {
+    Format format;
+    if (!detect_format(chunk, format)) return 0;
+
+    std::size_t records = 0;
+    std::size_t pos = chunk.find(format == Format::Fasta ? '>' : '@');
+    while (pos < chunk.size()) {
+        FastxRecord record;
+        const std::size_t header_end = line_end(chunk, pos);
+        record.name = chunk.substr(pos + 1, trimmed_length(chunk, pos + 1, header_end));
+
+        if (format == Format::Fasta) {
+            std::size_t next = chunk.find("\n>", header_end == 0 ? 0 : header_end - 1);
+            next = next == std::string_view::npos ? chunk.size() : next + 1;
+            record.sequence = chunk.substr(header_end, next - header_end);
+            pos = next;
+        } else {
+            // Sequence lines run until the '+' separator line.
+            std::size_t seq_end = header_end;
+            std::size_t bases = 0;
+            while (seq_end < chunk.size() && chunk[seq_end] != '+') {
+                const std::size_t end = line_end(chunk, seq_end);
+                bases += trimmed_length(chunk, seq_end, end);
+                seq_end = end;
+            }
+            if (seq_end >= chunk.size()) throw std::runtime_error("FASTQ record without '+' line.");
+            record.sequence = chunk.substr(header_end, seq_end - header_end);
+
+            // Quality lines run until they cover as many characters as the sequence has bases.
+            const std::size_t qual_begin = line_end(chunk, seq_end);
+            std::size_t qual_end = qual_begin;
+            std::size_t qualities = 0;
+            while (qualities < bases && qual_end < chunk.size()) {
+                const std::size_t end = line_end(chunk, qual_end);
+                qualities += trimmed_length(chunk, qual_end, end);
+                qual_end = end;
+            }
+            if (qualities != bases) throw std::runtime_error("FASTQ quality length does not match sequence length.");
+            record.quality = chunk.substr(qual_begin, qual_end - qual_begin);
+            pos = qual_end;
+            while (pos < chunk.size() && (chunk[pos] == '\n' || chunk[pos] == '\r')) ++pos;
+        }
+        fn(record);
+        ++records;
+    }
+    return records;
+}
+
+std::size_t FastxReader::parallel_for_each_record(std::size_t num_workers,
+                                                  const std::function<void(const FastxRecord&, std::size_t)>& fn,
+                                                  std::size_t chunk_bytes) const {
+    if (num_workers == 0) num_workers = 1;
+
+    // Chunks of a plain mapped file are views; decompressed chunks are copied out of the inflater's buffer.
+    struct Chunk {
+        std::string_view view;
+        std::shared_ptr<std::string> storage;
+    };
+    BoundedQueue<Chunk> queue(2 * num_workers);
+    std::vector<std::size_t> records(num_workers, 0);
+    std::vector<std::thread> workers;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    for (std::size_t w = 0; w < num_workers; ++w) {
+        workers.emplace_back([&, w] {
+            Chunk chunk;
+            while (queue.pop(chunk)) {
+                try {
+                    records[w] += parse_chunk(chunk.view, [&](const FastxRecord& record) { fn(record, w); });
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                    queue.close();
+                }
+            }
+        });
+    }
+
+    try {
+        const bool copy = is_gzip();
+        for_each_chunk(chunk_bytes, [&](std::string_view view) {
+            Chunk chunk;
+            if (copy) {
+                chunk.storage = std::make_shared<std::string>(view);
+                chunk.view = *chunk.storage;
+            } else {
+                chunk.view = view;
+            }
+            queue.push(std::move(chunk));
+        });
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+    }
+    queue.close();
+    for (auto& worker : workers) worker.join();
+    if (error) std::rethrow_exception(error);
+
+    std::size_t total = 0;
+    for (std::size_t r : records) total += r;
+    return total;
+}
+
+//================================================================================
+// Filter construction
+//================================================================================
+
+std::size_t build_filter_from_fastx(const std::string& path, MyBambooFilter& filter, unsigned k, std::size_t num_workers) {
+    kmer::check_k(k);
+    if (num_workers == 0) num_workers = 1;
+    constexpr std::size_t kFlushHashes = 1u << 16;
+
+    FastxReader reader(path);
+    std::mutex filter_mutex;
+    std::vector<std::vector<std::uint64_t>> buffers(num_workers);
+    std::vector<std::size_t> kmers(num_workers, 0);
+
+    auto flush = [&](std::size_t w) {
+        std::lock_guard<std::mutex> lock(filter_mutex);
+        filter.insert_hashed_batch(buffers[w].data(), buffers[w].size());
+        kmers[w] += buffers[w].size();
+        buffers[w].clear();
+    };
+
+    reader.parallel_for_each_record(num_workers, [&](const FastxRecord& record, std::size_t w) {
+        auto& buffer = buffers[w];
+        kmer::for_each_canonical_kmer(record.sequence, k, [&](std::uint64_t code) {
+            buffer.push_back(MyBambooFilter::mix64(code));
+        });
+        if (buffer.size() >= kFlushHashes) flush(w);
+    });
+    for (std::size_t w = 0; w < num_workers; ++w) flush(w);
+
+    std::size_t total = 0;
+    for (std::size_t n : kmers) total += n;
+    return total;
+}
+
+//================================================================================
+// Read classification
+//================================================================================
+
+ClassificationSummary classify_fastx(
+    const std::string& path, const MyBambooFilter& filter, unsigned k, float threshold, std::size_t num_workers,
+    const std::function<void(const FastxRecord&, const MyBambooFilter::ReadClassification&, std::size_t)>& on_read) {
+    kmer::check_k(k);
+    if (num_workers == 0) num_workers = 1;
+
+    FastxReader reader(path);
+    std::vector<ClassificationSummary> per_worker(num_workers);
+    reader.parallel_for_each_record(num_workers, [&](const FastxRecord& record, std::size_t w) {
+        const MyBambooFilter::ReadClassification result = filter.classify_read(record.sequence, k, threshold);
+        ClassificationSummary& summary = per_worker[w];
+        summary.reads++;
+        summary.matched += result.matched;
+        summary.kmers_total += result.kmers_total;
+        summary.kmers_probed += result.kmers_probed;
+        if (on_read) on_read(record, result, w);
+    });
+
+    ClassificationSummary total;
+    for (const auto& summary : per_worker) {
+        total.reads += summary.reads;
+        total.matched += summary.matched;
+        total.kmers_total += summary.kmers_total;
+        total.kmers_probed += summary.kmers_probed;
+    }
+    return total;
+}
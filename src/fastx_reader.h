@@ -0,0 +1,132 @@
+#ifndef MY_BAMBOO_FASTX_READER_H
+#define MY_BAMBOO_FASTX_READER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include "bamboo_filter.h"
+
+/**
+ * @file fastx_reader.h
+ * @brief Zero-copy FASTA/FASTQ reader over memory-mapped (optionally gzip-compressed) files.
+ *
+ * The file is mapped read-only and cut into chunks that always end on a record
+ * boundary, so chunks can be parsed independently by worker threads. Records are
+ * exposed as views into the mapping: a line-wrapped FASTA sequence is handed out
+ * as one view that still contains its line breaks, which the k-mer code skips.
+ * Gzip input is decompressed with the in-tree inflater (see inflate.h).
+ */
+
+/** @brief One sequence record; all views point into the reader's buffers. */
+struct FastxRecord {
+    /** @brief Header line without the leading '>' or '@'. */
+    std::string_view name;
+    /** @brief Sequence, possibly containing line breaks (wrapped FASTA, multi-line FASTQ). */
+    std::string_view sequence;
+    /** @brief Quality string (FASTQ only, empty for FASTA). */
+    std::string_view quality;
+};
+
+class FastxReader {
+public:
+    /** @brief Input record format, detected from the first record marker. */
+    enum class Format { Fasta, Fastq };
+
+    /**
+     * @brief Opens and memory-maps a FASTA/FASTQ file (plain or gzip).
+     * @param path Path of the file.
+     * @throws std::runtime_error If the file cannot be opened or mapped.
+     */
+    explicit FastxReader(const std::string& path);
+    ~FastxReader();
+
+    FastxReader(const FastxReader&) = delete;
+    FastxReader& operator=(const FastxReader&) = delete;
+
+    /** @brief Returns true if the file is gzip-compressed. */
+    bool is_gzip() const;
+
+    /**
+     * @brief Cuts the (decompressed) input into chunks of whole records, in file order.
+     * Chunks of mapped plain files stay valid for the lifetime of the reader; chunks of
+     * gzip input are only valid during the callback.
+     * @param chunk_bytes Approximate chunk size; a chunk extends to the next record boundary.
+     * @param fn Called with each chunk.
+     * @throws std::runtime_error On malformed gzip input.
+     */
+    void for_each_chunk(std::size_t chunk_bytes, const std::function<void(std::string_view)>& fn) const;
+
+    /**
+     * @brief Parses the records of a chunk produced by for_each_chunk().
+     * FASTQ records may span several sequence/quality lines; the format is detected
+     * from the chunk's first record marker.
+     * @param chunk The chunk.
+     * @param fn Called with each record.
+     * @return The number of records parsed.
+     * @throws std::runtime_error On malformed records.
+     */
+    static std::size_t parse_chunk(std::string_view chunk, const std::function<void(const FastxRecord&)>& fn);
+
+    /**
+     * @brief Parses all records on `num_workers` threads.
+     * The calling thread cuts chunks and hands them to the workers through a bounded queue.
+     * @param num_workers Number of worker threads (at least 1).
+     * @param fn Called with each record and the index of the worker thread calling it.
+     *           Calls from different workers run concurrently.
+     * @param chunk_bytes Approximate chunk size handed to a worker at a time.
+     * @return The number of records parsed.
+     */
+    std::size_t parallel_for_each_record(std::size_t num_workers,
+                                         const std::function<void(const FastxRecord&, std::size_t)>& fn,
+                                         std::size_t chunk_bytes = 4u << 20) const;
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+/**
+ * @brief Inserts every canonical k-mer of every record of a FASTA/FASTQ file into `filter`.
+ * Worker threads parse chunks and hash k-mers in parallel (same hashing as
+ * MyBambooFilter::insert_kmers()); hashes are handed to the filter in large
+ * batches through insert_hashed_batch() under a single lock.
+ * @param path Path of the FASTA/FASTQ file (plain or gzip).
+ * @param filter The filter to fill.
+ * @param k The k-mer length (1..32).
+ * @param num_workers Number of hashing threads.
+ * @return The number of k-mers processed.
+ * @throws std::invalid_argument If k is out of range.
+ * @throws std::runtime_error If the file cannot be read.
+ */
+std::size_t build_filter_from_fastx(const std::string& path, MyBambooFilter& filter, unsigned k, std::size_t num_workers);
+
+/** @brief Totals of a classify_fastx() run. */
+struct ClassificationSummary {
+    std::size_t reads = 0;
+    std::size_t matched = 0;
+    std::size_t kmers_total = 0;
+    std::size_t kmers_probed = 0;
+};
+
+/**
+ * @brief Classifies every read of a FASTA/FASTQ file against a reference k-mer filter.
+ * Reads are parsed and classified on `num_workers` threads with
+ * MyBambooFilter::classify_read(); the filter is only read, so no lock is taken.
+ * @param path Path of the FASTA/FASTQ file (plain or gzip).
+ * @param filter The reference filter.
+ * @param k The k-mer length the filter was built with.
+ * @param threshold Required fraction of hitting k-mers for a match.
+ * @param num_workers Number of worker threads.
+ * @param on_read Optional; called with each read, its classification and the worker index.
+ *                Calls from different workers run concurrently.
+ * @return Totals over all reads.
+ * @throws std::runtime_error If the file cannot be read.
+ */
+ClassificationSummary classify_fastx(
+    const std::string& path, const MyBambooFilter& filter, unsigned k, float threshold, std::size_t num_workers,
+    const std::function<void(const FastxRecord&, const MyBambooFilter::ReadClassification&, std::size_t)>& on_read = {});
+
+#endif // MY_BAMBOO_FASTX_READER_H
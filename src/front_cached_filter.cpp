@@ -0,0 +1,184 @@
+#include "front_cached_filter.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+// Front misses forwarded to the backing filter in one contains_hashed_batch() call.
+constexpr std::size_t kBatchBlock = 256;
+constexpr std::uint8_t kCounterMax = 15;
+
+std::size_t floor_pow2(std::size_t x) {
+    return x == 0 ? 0 : std::size_t{1} << (63 - __builtin_clzll(x));
+}
+
+// Front sets are chosen by the multiplicatively hashed fingerprint; doorkeeper counters
+// by the whole hash, so they do not follow the backing filter's bucket index.
+inline std::uint64_t front_mix(std::uint64_t fp) { return fp * 0x9e3779b97f4a7c15ULL; }
+inline std::uint64_t doorkeeper_mix(std::uint64_t h) { return (h ^ (h >> 29)) * 0xbf58476d1ce4e5b9ULL; }
+} // namespace
+
+//================================================================================
+// Constructor
+//================================================================================
+
+FrontCachedFilter::FrontCachedFilter(const MyBambooFilter::Config& config, const Options& options)
+  : backing_(config), admission_threshold_(options.admission_threshold) {
+    // Sets are chosen by fingerprint, so more sets than fingerprints would stay empty.
+    const std::size_t num_sets = std::min(floor_pow2(options.front_bytes / sizeof(Set)),
+                                          std::size_t{1} << backing_.fingerprint_bits());
+    if (num_sets == 0) throw std::invalid_argument("Front must hold at least one 64-byte set.");
+    if (admission_threshold_ == 0 || admission_threshold_ > kCounterMax) {
+        throw std::invalid_argument("Admission threshold must be between 1 and 15.");
+    }
+    sets_.assign(num_sets, Set{});
+    set_shift_ = 64 - static_cast<unsigned>(__builtin_ctzll(num_sets));
+
+    const std::size_t num_counters = floor_pow2(std::max<std::size_t>(1, num_sets * kWays * options.counters_per_entry));
+    counters_.assign(num_counters, 0);
+    aging_period_ = options.aging_period != 0 ? options.aging_period : num_counters * 8;
+}
+
+FrontCachedFilter::FrontCachedFilter(const MyBambooFilter::Config& config) : FrontCachedFilter(config, Options()) {}
+
+//================================================================================
+// Private Helpers: front and doorkeeper
+//================================================================================
+
+FrontCachedFilter::Set& FrontCachedFilter::set_of(std::uint64_t h) {
+    // A shift by 64 is undefined, so a single-set front is handled separately.
+    return set_shift_ == 64 ? sets_[0] : sets_[front_mix(backing_.fingerprint_of(h)) >> set_shift_];
+}
+
+bool FrontCachedFilter::front_contains(std::uint64_t h) {
+    if (h == 0) return false; // 0 marks empty ways, so it is never cached
+    const Set& set = set_of(h);
+    bool found = false;
+    for (std::size_t w = 0; w < kWays; ++w) found |= set.hashes[w] == h; // Branch-free scan of one cache line
+    return found;
+}
+
+void FrontCachedFilter::record_hit(std::uint64_t h) {
+    if (h == 0) return;
+    std::uint8_t& counter = counters_[doorkeeper_mix(h) & (counters_.size() - 1)];
+    if (counter < kCounterMax) ++counter;
+
+    if (++increments_since_aging_ >= aging_period_) {
+        // Halving keeps relative popularity while letting old favourites fade.
+        for (auto& c : counters_) c >>= 1;
+        increments_since_aging_ = 0;
+    }
+    if (counter < admission_threshold_) return;
+    // A batch can confirm the same hash twice before the front is consulted again.
+    if (front_contains(h)) return;
+
+    // Admit: shift the set by one way (dropping the oldest entry) and put the item first.
+    Set& set = set_of(h);
+    std::copy_backward(set.hashes, set.hashes + kWays - 1, set.hashes + kWays);
+    set.hashes[0] = h;
+    ++stats_.admissions;
+}
+
+void FrontCachedFilter::flush_if_moved() {
+    const std::size_t rebuilds = backing_.expansion_history().size();
+    const std::size_t relocations = backing_.relocations();
+    if (rebuilds == rebuilds_seen_ && relocations == relocations_seen_) return;
+    // Items moved to other buckets, so cached false positives may no longer hold.
+    std::fill(sets_.begin(), sets_.end(), Set{});
+    rebuilds_seen_ = rebuilds;
+    relocations_seen_ = relocations;
+    ++stats_.flushes;
+}
+
+//================================================================================
+// Public Methods: insert and erase
+//================================================================================
+
+void FrontCachedFilter::insert(std::string_view key) {
+    insert_hashed(backing_.hash_of(key));
+}
+
+void FrontCachedFilter::insert_hashed(std::uint64_t h) {
+    backing_.insert_hashed(h);
+    flush_if_moved();
+}
+
+bool FrontCachedFilter::erase(std::string_view key) {
+    return erase_hashed(backing_.hash_of(key));
+}
+
+bool FrontCachedFilter::erase_hashed(std::uint64_t h) {
+    if (!backing_.erase_hashed(h)) return false;
+    // Any cached hash with this fingerprint may have been a false positive caused by the
+    // erased item, and all of them share its set.
+    Set& set = set_of(h);
+    for (std::size_t w = 0; w < kWays; ++w) {
+        if (set.hashes[w] == 0) continue;
+        set.hashes[w] = 0;
+        ++stats_.invalidations;
+    }
+    return true;
+}
+
+//================================================================================
+// Public Methods: queries
+//================================================================================
+
+bool FrontCachedFilter::contains(std::string_view key) {
+    return contains_hashed(backing_.hash_of(key));
+}
+
+bool FrontCachedFilter::contains_hashed(std::uint64_t h) {
+    ++stats_.lookups;
+    if (front_contains(h)) {
+        ++stats_.front_hits;
+        return true;
+    }
+    ++stats_.backing_lookups;
+    const bool found = backing_.contains_hashed(h);
+    if (found) record_hit(h);
+    return found;
+}
+
+void FrontCachedFilter::contains_hashed_batch(const std::uint64_t* hashes, std::size_t count, bool* results) {
+    std::uint64_t misses[kBatchBlock];
+    std::size_t positions[kBatchBlock];
+    bool found[kBatchBlock];
+    for (std::size_t base = 0; base < count; base += kBatchBlock) {
+        const std::size_t n = std::min(kBatchBlock, count - base);
+        // Pass 1: answer what the front can; collect the rest.
+        std::size_t num_misses = 0;
+        for (std::size_t i = base; i < base + n; ++i) {
+            if (front_contains(hashes[i])) {
+                results[i] = true;
+                continue;
+            }
+            misses[num_misses] = hashes[i];
+            positions[num_misses++] = i;
+        }
+        // Pass 2: one batched (prefetching) backing lookup for the misses.
+        backing_.contains_hashed_batch(misses, num_misses, found);
+        for (std::size_t j = 0; j < num_misses; ++j) {
+            results[positions[j]] = found[j];
+            if (found[j]) record_hit(misses[j]);
+        }
+        stats_.lookups += n;
+        stats_.front_hits += n - num_misses;
+        stats_.backing_lookups += num_misses;
+    }
+}
+
+//================================================================================
+// Public Methods: statistics
+//================================================================================
+
+const FrontCachedFilter::Stats& FrontCachedFilter::stats() const { return stats_; }
+
+void FrontCachedFilter::reset_stats() { stats_ = Stats(); }
+
+const MyBambooFilter& FrontCachedFilter::backing() const { return backing_; }
+
+std::size_t FrontCachedFilter::front_capacity() const { return sets_.size() * kWays; }
+
+std::size_t FrontCachedFilter::memoryUsage() const {
+    return backing_.memoryUsage() + sets_.capacity() * sizeof(Set) + counters_.capacity();
+}
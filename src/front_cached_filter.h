@@ -0,0 +1,140 @@
+#ifndef MY_BAMBOO_FRONT_CACHED_FILTER_H
+#define MY_BAMBOO_FRONT_CACHED_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "bamboo_filter.h"
+
+/**
+ * @file front_cached_filter.h
+ * @brief MyBambooFilter behind a small cache-resident front that answers popular
+ * positive lookups without touching the large table.
+ *
+ * The front is a set-associative array of full 64-bit item hashes: each set is one
+ * 64-byte cache line holding 8 hashes, so a front probe costs a single cache line.
+ * It only holds hashes the backing filter has confirmed, including the backing
+ * filter's false positives. The set of a hash is chosen by its backing fingerprint, so
+ * a false positive is always cached in the same set as the stored items that can cause
+ * it. The front therefore answers exactly like the backing filter:
+ *
+ * - erase() clears the whole set of the erased fingerprint when the backing filter
+ *   removes an item, dropping any cached false positive that relied on it;
+ * - an insert that makes the backing filter rebuild, or that kicks stored items to
+ *   their other bucket, flushes the whole front, because a cached false positive may
+ *   have relied on a fingerprint that moved. Kicks only happen once both buckets of
+ *   an insert are full, so at moderate load inserts rarely flush.
+ *
+ * Keying sets by fingerprint limits the front to 2^fingerprint_bits sets.
+ *
+ * Admission is decided by a doorkeeper: a small array of 4-bit saturating counters
+ * indexed by hash. Each positive backing lookup increments the item's counter, and the
+ * item enters the front once the counter reaches the admission threshold, so one-off
+ * hits do not evict popular items. All counters are halved periodically so that
+ * popularity fades. Within a set, admission evicts the oldest entry.
+ *
+ * Lookups update the front, so this class is not thread-safe, not even for lookups.
+ */
+class FrontCachedFilter {
+public:
+    /** @brief Sizing and admission settings of the front. */
+    struct Options {
+        std::size_t front_bytes = 1u << 20;      ///< Front size; rounded down to a power-of-two number of 64-byte sets
+        unsigned admission_threshold = 2;        ///< Confirmed hits before an item enters the front (1..15)
+        std::size_t counters_per_entry = 4;      ///< Doorkeeper counters per front entry
+        std::size_t aging_period = 0;            ///< Counter increments between halvings; 0 = 8 per counter
+    };
+
+    /** @brief Front effectiveness counters since construction or the last reset_stats(). */
+    struct Stats {
+        std::size_t lookups = 0;          ///< All lookups
+        std::size_t front_hits = 0;       ///< Lookups answered by the front
+        std::size_t backing_lookups = 0;  ///< Lookups forwarded to the backing filter
+        std::size_t admissions = 0;       ///< Items that entered the front
+        std::size_t invalidations = 0;    ///< Front entries removed by erase()
+        std::size_t flushes = 0;          ///< Front flushes after a backing rebuild or kick
+    };
+
+    /**
+     * @brief Constructs the backing filter and an empty front.
+     * @param config Configuration of the backing filter.
+     * @param options Front settings.
+     * @throws std::invalid_argument If the front holds less than one set or the threshold is outside 1..15.
+     */
+    FrontCachedFilter(const MyBambooFilter::Config& config, const Options& options);
+
+    /** @brief Constructs the backing filter and a front with default Options. */
+    explicit FrontCachedFilter(const MyBambooFilter::Config& config);
+
+    /**
+     * @brief Inserts a key into the backing filter; the front only admits items on lookups.
+     * Flushes the front if the backing filter rebuilds.
+     */
+    void insert(std::string_view key);
+    /** @brief Inserts a pre-hashed item into the backing filter. Flushes the front if the backing filter rebuilds. */
+    void insert_hashed(std::uint64_t h);
+
+    /** @brief Checks whether a key is possibly present, trying the front first. */
+    bool contains(std::string_view key);
+    /** @brief Checks whether a pre-hashed item is possibly present, trying the front first. */
+    bool contains_hashed(std::uint64_t h);
+    /**
+     * @brief Checks pre-hashed items; `results[i]` answers `hashes[i]`. Front misses are
+     * forwarded to MyBambooFilter::contains_hashed_batch() together.
+     */
+    void contains_hashed_batch(const std::uint64_t* hashes, std::size_t count, bool* results);
+
+    /**
+     * @brief Removes a key from the backing filter. If it was stored, every front entry with
+     * its fingerprint is dropped too.
+     * @return True if the backing filter erased it.
+     */
+    bool erase(std::string_view key);
+    /** @brief Removes a pre-hashed item from the front and the backing filter. */
+    bool erase_hashed(std::uint64_t h);
+
+    /** @brief Returns the front counters. */
+    const Stats& stats() const;
+    /** @brief Zeroes the front counters. */
+    void reset_stats();
+
+    /** @brief Returns the backing filter. Modify it only through this class, or the front goes stale. */
+    const MyBambooFilter& backing() const;
+
+    /** @brief Returns the number of hashes the front can hold. */
+    std::size_t front_capacity() const;
+
+    /** @brief Returns the estimated memory usage of the backing filter, the front and the doorkeeper in bytes. */
+    std::size_t memoryUsage() const;
+
+private:
+    static constexpr std::size_t kWays = 8;
+
+    /** @brief One cache line of the front; 0 marks an empty way. */
+    struct alignas(64) Set {
+        std::uint64_t hashes[kWays];
+    };
+
+    /** @brief Returns the front set of a hash, chosen by its backing fingerprint. */
+    Set& set_of(std::uint64_t h);
+    /** @brief Returns true if the front holds the hash. */
+    bool front_contains(std::uint64_t h);
+    /** @brief Counts a confirmed hit and admits the item once it is popular enough. */
+    void record_hit(std::uint64_t h);
+    /** @brief Empties the front if the backing filter has rebuilt or moved items since the last check. */
+    void flush_if_moved();
+
+    MyBambooFilter backing_;
+    std::vector<Set> sets_;
+    unsigned set_shift_;                 ///< 64 - log2(number of sets)
+    std::vector<std::uint8_t> counters_; ///< Doorkeeper; size is a power of two
+    unsigned admission_threshold_;
+    std::size_t aging_period_;
+    std::size_t increments_since_aging_{0};
+    std::size_t rebuilds_seen_{0};       ///< backing_.expansion_history().size() when the front was last valid
+    std::size_t relocations_seen_{0};    ///< backing_.relocations() when the front was last valid
+    Stats stats_;
+};
+
+#endif // MY_BAMBOO_FRONT_CACHED_FILTER_H
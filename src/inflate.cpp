@@ -0,0 +1,436 @@
+#include "inflate.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace inflate {
+
+namespace {
+
+constexpr std::size_t kWindowSize = 32768; // Maximum DEFLATE back-reference distance
+constexpr std::size_t kMaxMatch = 258;     // Maximum DEFLATE match length
+
+//================================================================================
+// CRC-32 (gzip trailer check)
+//================================================================================
+
+const std::array<std::uint32_t, 256>& crc_table() {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+std::uint32_t crc32_update(std::uint32_t crc, const char* data, std::size_t len) {
+    const auto& table = crc_table();
+    crc = ~crc;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+//================================================================================
+// Bit reader (DEFLATE packs bits LSB-first)
+//================================================================================
+
+class BitReader {
+public:
+    BitReader(const std::uint8_t* begin, const std::uint8_t* end) : p_(begin), end_(end) {}
+
+    std::uint32_t peek(unsigned n) {
+        if (count_ < n) refill();
+        return static_cast<std::uint32_t>(buffer_ & ((1ULL << n) - 1));
+    }
+
+    void consume(unsigned n) {
+        buffer_ >>= n;
+        count_ -= n;
+    }
+
+    std::uint32_t bits(unsigned n) {
+        if (n == 0) return 0;
+        const std::uint32_t v = peek(n);
+        consume(n);
+        return v;
+    }
+
+    void align_to_byte() { consume(count_ % 8); }
+
+    /** @brief Throws if more bits were consumed than the input holds (zero padding was read). */
+    void check_overrun() const {
+        if (count_ < 8 * padded_bytes_) throw std::runtime_error("Truncated deflate stream.");
+    }
+
+    /** @brief Byte position just after the last fully consumed byte; call after align_to_byte(). */
+    const std::uint8_t* byte_position() const { return p_ - (count_ / 8 - padded_bytes_); }
+
+    /** @brief Copies `len` whole bytes to `out`; the reader must be byte aligned. */
+    void copy_bytes(char* out, std::size_t len) {
+        while (len > 0 && count_ >= 8) {
+            *out++ = static_cast<char>(bits(8));
+            --len;
+        }
+        check_overrun();
+        if (static_cast<std::size_t>(end_ - p_) < len) throw std::runtime_error("Truncated stored block.");
+        std::memcpy(out, p_, len);
+        p_ += len;
+    }
+
+private:
+    void refill() {
+        while (count_ <= 56) {
+            std::uint64_t byte = 0;
+            if (p_ < end_) byte = *p_++;
+            else padded_bytes_++; // Past the end: feed zeros, detected by check_overrun()
+            buffer_ |= byte << count_;
+            count_ += 8;
+        }
+    }
+
+    const std::uint8_t* p_;
+    const std::uint8_t* end_;
+    std::uint64_t buffer_ = 0;
+    unsigned count_ = 0;
+    std::size_t padded_bytes_ = 0;
+};
+
+//================================================================================
+// Canonical Huffman decoding
+//================================================================================
+
+class Huffman {
+public:
+    /** @brief Builds the decoder from per-symbol code lengths (0 = unused symbol). */
+    void build(const std::uint8_t* lengths, unsigned num_symbols) {
+        std::memset(count_, 0, sizeof(count_));
+        std::memset(fast_, 0, sizeof(fast_));
+        for (unsigned s = 0; s < num_symbols; ++s) count_[lengths[s]]++;
+        count_[0] = 0;
+
+        // More codes of some length than the code space allows would make decoding ambiguous.
+        int left = 1;
+        for (unsigned len = 1; len < 16; ++len) {
+            left = (left << 1) - count_[len];
+            if (left < 0) throw std::runtime_error("Over-subscribed Huffman code in deflate stream.");
+        }
+
+        std::uint16_t offsets[16];
+        offsets[1] = 0;
+        for (unsigned len = 1; len < 15; ++len) offsets[len + 1] = offsets[len] + count_[len];
+        for (unsigned s = 0; s < num_symbols; ++s) {
+            if (lengths[s] != 0) symbols_[offsets[lengths[s]]++] = static_cast<std::uint16_t>(s);
+        }
+
+        // Fill the direct lookup table with every code of at most kFastBits bits.
+        unsigned code = 0;
+        unsigned index = 0;
+        for (unsigned len = 1; len <= kFastBits; ++len) {
+            for (unsigned i = 0; i < count_[len]; ++i, ++code, ++index) {
+                unsigned reversed = 0;
+                for (unsigned b = 0; b < len; ++b) reversed |= ((code >> b) & 1u) << (len - 1 - b);
+                for (unsigned fill = reversed; fill < (1u << kFastBits); fill += 1u << len) {
+                    fast_[fill] = static_cast<std::uint16_t>((symbols_[index] << 4) | len);
+                }
+            }
+            code <<= 1;
+        }
+    }
+
+    /** @brief Decodes one symbol. */
+    unsigned decode(BitReader& in) const {
+        const std::uint16_t entry = fast_[in.peek(kFastBits)];
+        if (entry != 0) {
+            in.consume(entry & 0xf);
+            return entry >> 4;
+        }
+        // Slow path for long codes: walk the canonical code one bit at a time.
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (unsigned len = 1; len < 16; ++len) {
+            code |= static_cast<int>(in.bits(1));
+            const int count = count_[len];
+            if (code - count < first) return symbols_[index + (code - first)];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        throw std::runtime_error("Invalid Huffman code in deflate stream.");
+    }
+
+private:
+    static constexpr unsigned kFastBits = 10;
+    std::uint16_t fast_[1u << kFastBits]; // (symbol << 4) | length; 0 = not a short code
+    std::uint16_t count_[16];
+    std::uint16_t symbols_[288];
+};
+
+constexpr std::uint16_t kLengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                           35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                           3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::uint16_t kDistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                         257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                         8193, 12289, 16385, 24577};
+constexpr std::uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                         7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+constexpr std::uint8_t kCodeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+//================================================================================
+// Streaming output buffer
+//================================================================================
+
+class Output {
+public:
+    Output(const Sink& sink, std::size_t flush_bytes)
+      : sink_(sink), flush_bytes_(flush_bytes), threshold_(flush_bytes) {
+        buffer_.resize(kWindowSize + flush_bytes_ + kMaxMatch);
+    }
+
+    /** @brief Makes room for one literal or match, flushing to the sink when the threshold is reached. */
+    void reserve_match() {
+        if (pos_ >= threshold_) flush(false);
+    }
+
+    void put(char c) { buffer_[pos_++] = c; }
+
+    void copy_match(std::size_t distance, std::size_t length) {
+        if (distance > pos_ || distance > kWindowSize) throw std::runtime_error("Invalid deflate distance.");
+        char* out = buffer_.data() + pos_;
+        const char* from = out - distance;
+        if (distance >= length) {
+            std::memcpy(out, from, length);
+        } else {
+            for (std::size_t i = 0; i < length; ++i) out[i] = from[i]; // Overlapping copy repeats the pattern
+        }
+        pos_ += length;
+    }
+
+    /** @brief Ensures `len` bytes can be written contiguously, then returns where to write them. */
+    char* write_span(std::size_t len) {
+        if (pos_ + len > buffer_.size()) buffer_.resize(pos_ + len + kMaxMatch);
+        char* out = buffer_.data() + pos_;
+        pos_ += len;
+        return out;
+    }
+
+    /** @brief Finishes a gzip member: returns the CRC-32 of its output and starts a new one. */
+    std::uint32_t end_member() {
+        update_crc();
+        const std::uint32_t crc = crc_;
+        crc_ = 0;
+        return crc;
+    }
+
+    std::uint64_t member_size() const { return member_bytes_ + (pos_ - crc_pos_); }
+    void start_member() { member_bytes_ = 0; }
+
+    void flush(bool final) {
+        update_crc();
+        pending_ += sink_(buffer_.data() + pending_, pos_ - pending_, final);
+        if (final) return;
+
+        // Keep the back-reference window and everything the sink has not consumed.
+        const std::size_t drop = std::min(pending_, pos_ > kWindowSize ? pos_ - kWindowSize : 0);
+        std::memmove(buffer_.data(), buffer_.data() + drop, pos_ - drop);
+        pos_ -= drop;
+        pending_ -= drop;
+        crc_pos_ -= drop;
+
+        // If the sink keeps a lot unconsumed (e.g. one very long record), grow instead of spinning.
+        threshold_ = std::max(flush_bytes_, pos_ + flush_bytes_ / 2);
+        if (buffer_.size() < threshold_ + kMaxMatch) buffer_.resize(threshold_ + kMaxMatch);
+    }
+
+private:
+    void update_crc() {
+        crc_ = crc32_update(crc_, buffer_.data() + crc_pos_, pos_ - crc_pos_);
+        member_bytes_ += pos_ - crc_pos_;
+        crc_pos_ = pos_;
+    }
+
+    const Sink& sink_;
+    std::size_t flush_bytes_;
+    std::size_t threshold_;
+    std::vector<char> buffer_;
+    std::size_t pos_ = 0;     // End of produced output
+    std::size_t pending_ = 0; // Start of output not yet consumed by the sink
+    std::size_t crc_pos_ = 0; // End of output already folded into the CRC
+    std::uint32_t crc_ = 0;
+    std::uint64_t member_bytes_ = 0;
+};
+
+//================================================================================
+// DEFLATE blocks
+//================================================================================
+
+void inflate_codes(BitReader& in, Output& out, const Huffman& lit, const Huffman& dist) {
+    for (;;) {
+        out.reserve_match();
+        const unsigned sym = lit.decode(in);
+        in.check_overrun(); // Zero padding past the end would otherwise decode forever
+        if (sym < 256) {
+            out.put(static_cast<char>(sym));
+        } else if (sym == 256) {
+            return;
+        } else {
+            const unsigned li = sym - 257;
+            if (li >= 29) throw std::runtime_error("Invalid deflate length symbol.");
+            const std::size_t length = kLengthBase[li] + in.bits(kLengthExtra[li]);
+            const unsigned di = dist.decode(in);
+            if (di >= 30) throw std::runtime_error("Invalid deflate distance symbol.");
+            const std::size_t distance = kDistBase[di] + in.bits(kDistExtra[di]);
+            out.copy_match(distance, length);
+        }
+    }
+}
+
+void inflate_fixed(BitReader& in, Output& out) {
+    static const std::pair<Huffman, Huffman> tables = [] {
+        std::uint8_t lengths[288 + 30];
+        unsigned s = 0;
+        for (; s < 144; ++s) lengths[s] = 8;
+        for (; s < 256; ++s) lengths[s] = 9;
+        for (; s < 280; ++s) lengths[s] = 7;
+        for (; s < 288; ++s) lengths[s] = 8;
+        for (; s < 288 + 30; ++s) lengths[s] = 5;
+        std::pair<Huffman, Huffman> t;
+        t.first.build(lengths, 288);
+        t.second.build(lengths + 288, 30);
+        return t;
+    }();
+    inflate_codes(in, out, tables.first, tables.second);
+}
+
+void inflate_dynamic(BitReader& in, Output& out) {
+    const unsigned num_lit = in.bits(5) + 257;
+    const unsigned num_dist = in.bits(5) + 1;
+    const unsigned num_code = in.bits(4) + 4;
+    if (num_lit > 286 || num_dist > 30) throw std::runtime_error("Invalid dynamic block header.");
+
+    std::uint8_t lengths[320] = {};
+    for (unsigned i = 0; i < num_code; ++i) lengths[kCodeLengthOrder[i]] = static_cast<std::uint8_t>(in.bits(3));
+    Huffman code_lengths;
+    code_lengths.build(lengths, 19);
+
+    std::uint8_t all[320] = {};
+    for (unsigned i = 0; i < num_lit + num_dist;) {
+        const unsigned sym = code_lengths.decode(in);
+        in.check_overrun();
+        if (sym < 16) {
+            all[i++] = static_cast<std::uint8_t>(sym);
+            continue;
+        }
+        std::uint8_t value = 0;
+        unsigned repeat;
+        if (sym == 16) {
+            if (i == 0) throw std::runtime_error("Repeat with no previous code length.");
+            value = all[i - 1];
+            repeat = 3 + in.bits(2);
+        } else if (sym == 17) {
+            repeat = 3 + in.bits(3);
+        } else {
+            repeat = 11 + in.bits(7);
+        }
+        if (i + repeat > num_lit + num_dist) throw std::runtime_error("Code lengths overflow.");
+        while (repeat--) all[i++] = value;
+    }
+    if (all[256] == 0) throw std::runtime_error("Missing end-of-block code.");
+
+    Huffman lit, dist;
+    lit.build(all, num_lit);
+    dist.build(all + num_lit, num_dist);
+    inflate_codes(in, out, lit, dist);
+}
+
+void inflate_stored(BitReader& in, Output& out) {
+    in.align_to_byte();
+    const std::uint32_t len = in.bits(16);
+    const std::uint32_t nlen = in.bits(16);
+    if ((len ^ 0xffffu) != nlen) throw std::runtime_error("Corrupt stored block length.");
+    out.reserve_match();
+    in.copy_bytes(out.write_span(len), len);
+}
+
+/** @brief Parses a gzip member header and returns a pointer to its deflate data. */
+const std::uint8_t* skip_gzip_header(const std::uint8_t* p, const std::uint8_t* end) {
+    if (end - p < 10 || p[0] != 0x1f || p[1] != 0x8b || p[2] != 8) throw std::runtime_error("Not a gzip member.");
+    const std::uint8_t flags = p[3];
+    p += 10;
+    if (flags & 4) { // FEXTRA
+        if (end - p < 2) throw std::runtime_error("Truncated gzip header.");
+        const std::size_t xlen = p[0] | (p[1] << 8);
+        if (static_cast<std::size_t>(end - p) < 2 + xlen) throw std::runtime_error("Truncated gzip header.");
+        p += 2 + xlen;
+    }
+    for (std::uint8_t bit : {std::uint8_t{8}, std::uint8_t{16}}) { // FNAME, FCOMMENT: zero-terminated
+        if (!(flags & bit)) continue;
+        while (p < end && *p != 0) ++p;
+        if (p == end) throw std::runtime_error("Truncated gzip header.");
+        ++p;
+    }
+    if (flags & 2) { // FHCRC
+        if (end - p < 2) throw std::runtime_error("Truncated gzip header.");
+        p += 2;
+    }
+    return p;
+}
+
+std::uint32_t read_le32(const std::uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+} // namespace
+
+bool is_gzip(const void* data, std::size_t len) {
+    auto p = static_cast<const std::uint8_t*>(data);
+    return len >= 2 && p[0] == 0x1f && p[1] == 0x8b;
+}
+
+void gunzip(const void* data, std::size_t len, const Sink& sink, std::size_t flush_bytes) {
+    auto p = static_cast<const std::uint8_t*>(data);
+    const std::uint8_t* const end = p + len;
+    if (len == 0) throw std::runtime_error("Not a gzip member.");
+    Output out(sink, flush_bytes);
+
+    while (p < end) {
+        p = skip_gzip_header(p, end);
+        out.start_member();
+        BitReader in(p, end);
+        bool last_block = false;
+        while (!last_block) {
+            last_block = in.bits(1) != 0;
+            switch (in.bits(2)) {
+                case 0: inflate_stored(in, out); break;
+                case 1: inflate_fixed(in, out); break;
+                case 2: inflate_dynamic(in, out); break;
+                default: throw std::runtime_error("Invalid deflate block type.");
+            }
+            in.check_overrun();
+        }
+        in.align_to_byte();
+        p = in.byte_position();
+
+        if (end - p < 8) throw std::runtime_error("Truncated gzip trailer.");
+        const std::uint64_t size = out.member_size();
+        if (out.end_member() != read_le32(p) || static_cast<std::uint32_t>(size) != read_le32(p + 4)) {
+            throw std::runtime_error("gzip CRC or size mismatch.");
+        }
+        p += 8;
+
+        // Trailing zero padding after the last member is tolerated.
+        while (p < end && *p == 0) ++p;
+    }
+    out.flush(true);
+}
+
+} // namespace inflate
@@ -0,0 +1,47 @@
+#ifndef MY_BAMBOO_INFLATE_H
+#define MY_BAMBOO_INFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @file inflate.h
+ * @brief Minimal in-tree gzip (RFC 1952) / DEFLATE (RFC 1951) decompressor.
+ *
+ * Decompresses an in-memory (typically memory-mapped) gzip file and streams the
+ * output to a sink in large blocks, keeping only the 32 KiB back-reference window
+ * plus whatever the sink has not consumed yet. Multi-member files (e.g. bgzip
+ * output or concatenated .gz files) are decoded as one continuous stream.
+ */
+namespace inflate {
+
+/**
+ * @brief Receives decompressed data that has not been consumed yet.
+ * Called with the unconsumed output produced so far and a flag that is true on
+ * the very last call. Returns how many leading bytes it consumed; the rest is
+ * passed again, extended with newer output, on the next call.
+ */
+using Sink = std::function<std::size_t(const char* data, std::size_t len, bool final)>;
+
+/**
+ * @brief Checks for the gzip magic bytes.
+ * @param data Pointer to the file contents.
+ * @param len Length of the file contents.
+ * @return True if the data starts with a gzip header.
+ */
+bool is_gzip(const void* data, std::size_t len);
+
+/**
+ * @brief Decompresses a complete gzip file, streaming the output to `sink`.
+ * @param data Pointer to the compressed file contents.
+ * @param len Length of the compressed file contents.
+ * @param sink Receives the decompressed output.
+ * @param flush_bytes Amount of new output accumulated before the sink is called.
+ * @throws std::runtime_error On malformed input or a CRC/size mismatch.
+ */
+void gunzip(const void* data, std::size_t len, const Sink& sink, std::size_t flush_bytes = 8u << 20);
+
+} // namespace inflate
+
+#endif // MY_BAMBOO_INFLATE_H
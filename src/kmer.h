@@ -0,0 +1,106 @@
+#ifndef MY_BAMBOO_KMER_H
+#define MY_BAMBOO_KMER_H
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/**
+ * @file kmer.h
+ * @brief 2-bit DNA encoding and O(1) rolling extraction of canonical k-mers.
+ *
+ * Bases are encoded as A=0, C=1, G=2, T=3 (case-insensitive), so a k-mer of up
+ * to 32 bases packs into one 64-bit integer. The canonical k-mer is the smaller
+ * of the forward code and the reverse-complement code, which makes a k-mer and
+ * its reverse complement (the same locus read from the other strand) identical.
+ */
+namespace kmer {
+
+/** @brief Largest k that fits a 2-bit packed k-mer into 64 bits. */
+constexpr unsigned kMaxK = 32;
+
+/** @brief Encoding result for bases that break a k-mer (N, IUPAC codes, anything else). */
+constexpr std::uint8_t kInvalidBase = 4;
+/** @brief Encoding result for characters that are skipped without breaking a k-mer (line breaks in wrapped FASTA). */
+constexpr std::uint8_t kSkipBase = 5;
+
+/** @brief Lookup table mapping a character to its 2-bit code, kInvalidBase or kSkipBase. */
+inline const std::array<std::uint8_t, 256>& base_codes() {
+    static const std::array<std::uint8_t, 256> table = [] {
+        std::array<std::uint8_t, 256> t{};
+        t.fill(kInvalidBase);
+        t['A'] = t['a'] = 0;
+        t['C'] = t['c'] = 1;
+        t['G'] = t['g'] = 2;
+        t['T'] = t['t'] = 3;
+        t['\n'] = t['\r'] = kSkipBase;
+        return t;
+    }();
+    return table;
+}
+
+/**
+ * @brief Validates a k-mer length.
+ * @throws std::invalid_argument If k is 0 or larger than kMaxK.
+ */
+inline void check_k(unsigned k) {
+    if (k == 0 || k > kMaxK) {
+        throw std::invalid_argument("k-mer length must be between 1 and 32.");
+    }
+}
+
+/**
+ * @brief Calls `callback(canonical_code)` for every valid k-mer of `sequence`, in order.
+ *
+ * Each step is a constant-time shift of the forward and reverse-complement codes,
+ * independent of k. Line breaks are skipped, so line-wrapped sequences can be passed
+ * as-is; any other non-ACGT character (e.g. N) restarts the k-mer window.
+ *
+ * @param sequence The DNA sequence.
+ * @param k The k-mer length (1..32).
+ * @param callback Invocable as `callback(std::uint64_t)`.
+ * @throws std::invalid_argument If k is out of range.
+ */
+template <typename Callback>
+void for_each_canonical_kmer(std::string_view sequence, unsigned k, Callback&& callback) {
+    check_k(k);
+    const auto& codes = base_codes();
+    const std::uint64_t mask = k == kMaxK ? ~0ULL : ((1ULL << (2 * k)) - 1);
+    const unsigned rc_shift = 2 * (k - 1);
+
+    std::uint64_t forward = 0;
+    std::uint64_t reverse = 0;
+    unsigned valid_run = 0; // Number of consecutive valid bases seen, saturating at k
+    for (char c : sequence) {
+        const std::uint8_t base = codes[static_cast<unsigned char>(c)];
+        if (base == kSkipBase) continue;
+        if (base == kInvalidBase) {
+            valid_run = 0;
+            continue;
+        }
+        forward = ((forward << 2) | base) & mask;
+        reverse = (reverse >> 2) | (static_cast<std::uint64_t>(3 - base) << rc_shift);
+        if (valid_run < k) ++valid_run;
+        if (valid_run == k) callback(forward < reverse ? forward : reverse);
+    }
+}
+
+/**
+ * @brief Decodes a 2-bit packed k-mer back to its bases.
+ * @param code The packed k-mer.
+ * @param k The k-mer length (1..32).
+ * @return The k-mer as an upper-case ACGT string.
+ */
+inline std::string decode(std::uint64_t code, unsigned k) {
+    std::string bases(k, 'A');
+    for (unsigned i = 0; i < k; ++i) {
+        bases[k - 1 - i] = "ACGT"[(code >> (2 * i)) & 3];
+    }
+    return bases;
+}
+
+} // namespace kmer
+
+#endif // MY_BAMBOO_KMER_H
@@ -0,0 +1,193 @@
+#include "kmer_counter.h"
+#include "bounded_queue.h"
+#include "fastx_reader.h"
+#include "kmer.h"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+//================================================================================
+// KmerCountTable
+//================================================================================
+
+KmerCountTable::KmerCountTable(std::size_t initial_capacity) {
+    std::size_t capacity = 16;
+    while (capacity < initial_capacity * 2) capacity *= 2; // Keep the load at or below 0.5 initially
+    keys_.assign(capacity, kEmptyKey);
+    counts_.assign(capacity, 0);
+    mask_ = capacity - 1;
+}
+
+std::uint32_t& KmerCountTable::find_or_insert(std::uint64_t key, std::uint32_t initial) {
+    if (key == kEmptyKey) throw std::invalid_argument("The all-ones k-mer code is reserved.");
+    for (std::size_t i = MyBambooFilter::mix64(key) & mask_;; i = (i + 1) & mask_) {
+        if (keys_[i] == key) return counts_[i];
+        if (keys_[i] != kEmptyKey) continue;
+
+        if ((size_ + 1) * 10 > keys_.size() * 7) { // Grow past 70% load, then probe again
+            grow();
+            return find_or_insert(key, initial);
+        }
+        keys_[i] = key;
+        counts_[i] = initial;
+        size_++;
+        return counts_[i];
+    }
+}
+
+std::uint32_t KmerCountTable::count(std::uint64_t key) const {
+    if (key == kEmptyKey) return 0;
+    for (std::size_t i = MyBambooFilter::mix64(key) & mask_;; i = (i + 1) & mask_) {
+        if (keys_[i] == key) return counts_[i];
+        if (keys_[i] == kEmptyKey) return 0;
+    }
+}
+
+void KmerCountTable::grow() {
+    std::vector<std::uint64_t> old_keys(keys_.size() * 2, kEmptyKey);
+    std::vector<std::uint32_t> old_counts(counts_.size() * 2, 0);
+    old_keys.swap(keys_);
+    old_counts.swap(counts_);
+    mask_ = keys_.size() - 1;
+    for (std::size_t j = 0; j < old_keys.size(); ++j) {
+        if (old_keys[j] == kEmptyKey) continue;
+        std::size_t i = MyBambooFilter::mix64(old_keys[j]) & mask_;
+        while (keys_[i] != kEmptyKey) i = (i + 1) & mask_;
+        keys_[i] = old_keys[j];
+        counts_[i] = old_counts[j];
+    }
+}
+
+std::size_t KmerCountTable::size() const {
+    return size_;
+}
+
+std::size_t KmerCountTable::memoryUsage() const {
+    return keys_.capacity() * sizeof(std::uint64_t) + counts_.capacity() * sizeof(std::uint32_t);
+}
+
+void KmerCountTable::for_each(const std::function<void(std::uint64_t, std::uint32_t)>& fn) const {
+    for (std::size_t i = 0; i < keys_.size(); ++i) {
+        if (keys_[i] != kEmptyKey) fn(keys_[i], counts_[i]);
+    }
+}
+
+//================================================================================
+// KmerCounter
+//================================================================================
+
+/** @brief One counting stage: owned exclusively by its counting thread while a file is processed. */
+struct KmerCounter::Partition {
+    explicit Partition(const MyBambooFilter::Config& config) : first_seen(config) {}
+
+    MyBambooFilter first_seen;
+    KmerCountTable counts;
+    std::size_t promoted = 0;
+};
+
+KmerCounter::KmerCounter(const Options& options) : options_(options) {
+    kmer::check_k(options_.k);
+    if (options_.partitions == 0) options_.partitions = 1;
+    if (options_.hash_workers == 0) options_.hash_workers = 1;
+    if (options_.batch_size == 0) options_.batch_size = 1;
+    for (std::size_t p = 0; p < options_.partitions; ++p) {
+        partitions_.push_back(std::make_unique<Partition>(options_.filter_config));
+    }
+}
+
+KmerCounter::~KmerCounter() = default;
+
+std::size_t KmerCounter::partition_of(std::uint64_t kmer_hash) const {
+    // The filters take the fingerprint from the low bits of kmer_hash and the bucket from h >> 16,
+    // i.e. the high bits. Taking the partition straight from either would leave every filter with
+    // fewer distinct fingerprints or buckets in use, so it comes from an independent remix.
+    return MyBambooFilter::mix64(kmer_hash ^ 0x9e3779b97f4a7c15ULL) % partitions_.size();
+}
+
+void KmerCounter::count_file(const std::string& path) {
+    const std::size_t num_partitions = partitions_.size();
+    const std::size_t num_workers = options_.hash_workers;
+
+    // Stage 3: one counting thread per partition.
+    std::vector<std::unique_ptr<BoundedQueue<std::vector<std::uint64_t>>>> queues;
+    for (std::size_t p = 0; p < num_partitions; ++p) {
+        queues.push_back(std::make_unique<BoundedQueue<std::vector<std::uint64_t>>>(4 * num_workers));
+    }
+    std::vector<std::thread> counters;
+    for (std::size_t p = 0; p < num_partitions; ++p) {
+        counters.emplace_back([this, p, &queues] {
+            Partition& part = *partitions_[p];
+            std::vector<std::uint64_t> batch;
+            while (queues[p]->pop(batch)) {
+                for (std::uint64_t code : batch) {
+                    const std::uint64_t h = MyBambooFilter::mix64(code);
+                    if (part.first_seen.contains_hashed(h)) {
+                        std::uint32_t& count = part.counts.find_or_insert(code, 1);
+                        if (count == 1) part.promoted++;
+                        count++; // First promotion counts the sighting recorded by the filter as well
+                    } else {
+                        part.first_seen.insert_hashed(h);
+                    }
+                }
+            }
+        });
+    }
+
+    // Stages 1 and 2: chunking on this thread, parsing and k-mer hashing on the reader's workers.
+    std::vector<std::vector<std::vector<std::uint64_t>>> buffers(
+        num_workers, std::vector<std::vector<std::uint64_t>>(num_partitions));
+    std::vector<std::size_t> worker_kmers(num_workers, 0);
+    std::size_t records = 0;
+    std::exception_ptr error;
+    try {
+        FastxReader reader(path);
+        records = reader.parallel_for_each_record(num_workers, [&](const FastxRecord& record, std::size_t w) {
+            auto& mine = buffers[w];
+            kmer::for_each_canonical_kmer(record.sequence, options_.k, [&](std::uint64_t code) {
+                auto& buffer = mine[partition_of(MyBambooFilter::mix64(code))];
+                buffer.push_back(code);
+                if (buffer.size() >= options_.batch_size) {
+                    worker_kmers[w] += buffer.size();
+                    queues[&buffer - mine.data()]->push(std::move(buffer));
+                    buffer = std::vector<std::uint64_t>();
+                    buffer.reserve(options_.batch_size);
+                }
+            });
+        });
+        for (std::size_t w = 0; w < num_workers; ++w) {
+            for (std::size_t p = 0; p < num_partitions; ++p) {
+                worker_kmers[w] += buffers[w][p].size();
+                if (!buffers[w][p].empty()) queues[p]->push(std::move(buffers[w][p]));
+            }
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (auto& queue : queues) queue->close();
+    for (auto& counter : counters) counter.join();
+    if (error) std::rethrow_exception(error);
+
+    records_ += records;
+    for (std::size_t n : worker_kmers) kmers_ += n;
+}
+
+std::uint32_t KmerCounter::count(std::uint64_t canonical_code) const {
+    return partitions_[partition_of(MyBambooFilter::mix64(canonical_code))]->counts.count(canonical_code);
+}
+
+void KmerCounter::for_each(const std::function<void(std::uint64_t, std::uint32_t)>& fn) const {
+    for (const auto& part : partitions_) part->counts.for_each(fn);
+}
+
+KmerCounter::Stats KmerCounter::stats() const {
+    Stats stats;
+    stats.records = records_;
+    stats.kmers = kmers_;
+    for (const auto& part : partitions_) {
+        stats.promoted += part->promoted;
+        stats.filter_items += part->first_seen.size();
+        stats.filter_memory += part->first_seen.memoryUsage();
+        stats.table_memory += part->counts.memoryUsage();
+    }
+    return stats;
+}
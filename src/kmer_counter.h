@@ -0,0 +1,140 @@
+#ifndef MY_BAMBOO_KMER_COUNTER_H
+#define MY_BAMBOO_KMER_COUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bamboo_filter.h"
+
+/**
+ * @file kmer_counter.h
+ * @brief Exact k-mer count table and a parallel counting pipeline that keeps
+ * singletons out of it with a MyBambooFilter first-seen filter.
+ */
+
+/**
+ * @brief Open-addressing (linear probing) hash table from packed canonical k-mers to counts.
+ * The all-ones code is reserved as the empty marker; it is never a canonical
+ * k-mer (its reverse complement is all zeros, which is smaller).
+ */
+class KmerCountTable {
+public:
+    /** @brief Marker for empty slots. */
+    static constexpr std::uint64_t kEmptyKey = ~0ULL;
+
+    /**
+     * @brief Constructs an empty table.
+     * @param initial_capacity Expected number of distinct k-mers.
+     */
+    explicit KmerCountTable(std::size_t initial_capacity = 1024);
+
+    /**
+     * @brief Returns the count of `key`, inserting it with `initial` first if absent.
+     * The reference stays valid until the next insertion.
+     * @throws std::invalid_argument If `key` equals kEmptyKey.
+     */
+    std::uint32_t& find_or_insert(std::uint64_t key, std::uint32_t initial);
+
+    /** @brief Returns the count of `key`, or 0 if absent. */
+    std::uint32_t count(std::uint64_t key) const;
+
+    /** @brief Returns the number of distinct keys. */
+    std::size_t size() const;
+
+    /** @brief Returns the memory used by the table storage in bytes. */
+    std::size_t memoryUsage() const;
+
+    /** @brief Calls `fn(key, count)` for every entry, in table order. */
+    void for_each(const std::function<void(std::uint64_t, std::uint32_t)>& fn) const;
+
+private:
+    void grow();
+
+    std::vector<std::uint64_t> keys_;
+    std::vector<std::uint32_t> counts_;
+    std::size_t mask_;
+    std::size_t size_ = 0;
+};
+
+/**
+ * @brief Multi-threaded k-mer counter that counts only k-mers seen at least twice.
+ *
+ * Most distinct k-mers in a read set are sequencing-error singletons. The first
+ * occurrence of a k-mer only goes into a per-partition MyBambooFilter; a k-mer the
+ * filter already (probably) contains is promoted into the exact KmerCountTable with
+ * a count of 2 and incremented from then on. Singletons therefore cost a few bits
+ * in the filter instead of a table entry. A false positive of the filter promotes a
+ * singleton early, so counts of 2 can be overestimated by one with the filter's FPR.
+ *
+ * Pipeline stages: the reader thread cuts record-aligned chunks; hashing workers
+ * parse them, extract canonical k-mers and batch them per partition; one counting
+ * thread per partition owns that partition's filter and table, so neither needs a lock.
+ */
+class KmerCounter {
+public:
+    /** @brief Pipeline configuration. */
+    struct Options {
+        /** @brief The k-mer length (1..32). */
+        unsigned k = 31;
+        /** @brief Number of hashing threads. */
+        std::size_t hash_workers = 2;
+        /** @brief Number of partitions, each with its own counting thread, filter and table. */
+        std::size_t partitions = 2;
+        /** @brief Number of k-mers handed between stages at a time. */
+        std::size_t batch_size = 1u << 14;
+        /** @brief Configuration of each partition's first-seen filter. */
+        MyBambooFilter::Config filter_config;
+    };
+
+    /** @brief Totals of a counting run. */
+    struct Stats {
+        std::size_t records = 0;
+        std::size_t kmers = 0;
+        std::size_t promoted = 0;
+        std::size_t filter_items = 0;
+        std::size_t filter_memory = 0;
+        std::size_t table_memory = 0;
+    };
+
+    /**
+     * @brief Constructs a counter.
+     * @throws std::invalid_argument If k is out of range.
+     */
+    explicit KmerCounter(const Options& options);
+    ~KmerCounter();
+
+    KmerCounter(const KmerCounter&) = delete;
+    KmerCounter& operator=(const KmerCounter&) = delete;
+
+    /**
+     * @brief Counts the k-mers of a FASTA/FASTQ file (plain or gzip). Can be called repeatedly.
+     * @param path Path of the file.
+     * @throws std::runtime_error If the file cannot be read.
+     */
+    void count_file(const std::string& path);
+
+    /** @brief Returns the exact count of a canonical k-mer code (0 for singletons and unseen k-mers). */
+    std::uint32_t count(std::uint64_t canonical_code) const;
+
+    /** @brief Calls `fn(canonical_code, count)` for every k-mer seen at least twice. */
+    void for_each(const std::function<void(std::uint64_t, std::uint32_t)>& fn) const;
+
+    /** @brief Returns the totals accumulated so far. */
+    Stats stats() const;
+
+private:
+    struct Partition;
+
+    /** @brief Partition owning a k-mer; independent of the bits the filters index with. */
+    std::size_t partition_of(std::uint64_t kmer_hash) const;
+
+    Options options_;
+    std::vector<std::unique_ptr<Partition>> partitions_;
+    std::size_t records_ = 0;
+    std::size_t kmers_ = 0;
+};
+
+#endif // MY_BAMBOO_KMER_COUNTER_H
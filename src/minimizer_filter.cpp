@@ -0,0 +1,138 @@
+#include "minimizer_filter.h"
+#include "kmer.h"
+#include <stdexcept>
+
+namespace {
+// Upper bound on buffered hashes per super-k-mer before they are flushed to a sub-filter.
+constexpr std::size_t kRoutedBatchSize = 256;
+} // namespace
+
+MinimizerPartitionedFilter::MinimizerPartitionedFilter(std::size_t num_partitions, unsigned k, unsigned m,
+                                                       const MyBambooFilter::Config& partition_config)
+  : k_(k), m_(m) {
+    kmer::check_k(k_);
+    if (m_ == 0 || m_ > k_) throw std::invalid_argument("Minimizer length must be between 1 and k.");
+    if (num_partitions == 0) throw std::invalid_argument("Number of partitions must be greater than 0.");
+    partitions_.reserve(num_partitions);
+    for (std::size_t i = 0; i < num_partitions; ++i) partitions_.emplace_back(partition_config);
+}
+
+template <typename Fn>
+void MinimizerPartitionedFilter::for_each_routed_kmer(std::string_view sequence, Fn&& fn) const {
+    const auto& codes = kmer::base_codes();
+    const std::uint64_t k_mask = k_ == kmer::kMaxK ? ~0ULL : ((1ULL << (2 * k_)) - 1);
+    const std::uint64_t m_mask = m_ == kmer::kMaxK ? ~0ULL : ((1ULL << (2 * m_)) - 1);
+    const unsigned k_shift = 2 * (k_ - 1);
+    const unsigned m_shift = 2 * (m_ - 1);
+    const unsigned window = k_ - m_ + 1; // m-mers per k-mer
+
+    std::uint64_t k_fwd = 0, k_rev = 0, m_fwd = 0, m_rev = 0;
+    unsigned run = 0;     // Consecutive valid bases, saturating at k
+    std::uint64_t pos = 0; // Index of the current valid base
+
+    // Monotone queue of (position, hash) of candidate minimizers; at most `window` entries live at once.
+    struct Candidate { std::uint64_t pos; std::uint64_t hash; };
+    Candidate ring[kmer::kMaxK];
+    unsigned head = 0, count = 0;
+
+    for (char c : sequence) {
+        const std::uint8_t base = codes[static_cast<unsigned char>(c)];
+        if (base == kmer::kSkipBase) continue;
+        if (base == kmer::kInvalidBase) {
+            run = 0;
+            count = 0;
+            continue;
+        }
+        k_fwd = ((k_fwd << 2) | base) & k_mask;
+        k_rev = (k_rev >> 2) | (static_cast<std::uint64_t>(3 - base) << k_shift);
+        m_fwd = ((m_fwd << 2) | base) & m_mask;
+        m_rev = (m_rev >> 2) | (static_cast<std::uint64_t>(3 - base) << m_shift);
+        if (run < k_) ++run;
+        ++pos;
+
+        if (run >= m_) {
+            const std::uint64_t m_hash = MyBambooFilter::mix64(m_fwd < m_rev ? m_fwd : m_rev);
+            // Drop candidates that can never be the minimum again, then append the new m-mer.
+            while (count > 0 && ring[(head + count - 1) % kmer::kMaxK].hash >= m_hash) --count;
+            ring[(head + count) % kmer::kMaxK] = {pos, m_hash};
+            ++count;
+            // Drop the front once it slides out of the current k-mer.
+            if (ring[head].pos + window <= pos) {
+                head = (head + 1) % kmer::kMaxK;
+                --count;
+            }
+        }
+        if (run == k_) {
+            const std::size_t partition = MyBambooFilter::mix64(ring[head].hash) % partitions_.size();
+            fn(MyBambooFilter::mix64(k_fwd < k_rev ? k_fwd : k_rev), partition);
+        }
+    }
+}
+
+std::size_t MinimizerPartitionedFilter::insert_kmers(std::string_view sequence) {
+    std::uint64_t buffer[kRoutedBatchSize];
+    std::size_t buffered = 0;
+    std::size_t current = 0;
+    std::size_t processed = 0;
+    auto flush = [&]() {
+        partitions_[current].insert_hashed_batch(buffer, buffered);
+        processed += buffered;
+        buffered = 0;
+    };
+    for_each_routed_kmer(sequence, [&](std::uint64_t hash, std::size_t partition) {
+        // A change of partition ends the super-k-mer; hand it over as one batch.
+        if (buffered == kRoutedBatchSize || (buffered > 0 && partition != current)) flush();
+        current = partition;
+        buffer[buffered++] = hash;
+    });
+    if (buffered > 0) flush();
+    return processed;
+}
+
+std::size_t MinimizerPartitionedFilter::count_present_kmers(std::string_view sequence) const {
+    std::uint64_t buffer[kRoutedBatchSize];
+    bool found[kRoutedBatchSize];
+    std::size_t buffered = 0;
+    std::size_t current = 0;
+    std::size_t present = 0;
+    auto flush = [&]() {
+        partitions_[current].contains_hashed_batch(buffer, buffered, found);
+        for (std::size_t i = 0; i < buffered; ++i) present += found[i];
+        buffered = 0;
+    };
+    for_each_routed_kmer(sequence, [&](std::uint64_t hash, std::size_t partition) {
+        if (buffered == kRoutedBatchSize || (buffered > 0 && partition != current)) flush();
+        current = partition;
+        buffer[buffered++] = hash;
+    });
+    if (buffered > 0) flush();
+    return present;
+}
+
+std::size_t MinimizerPartitionedFilter::size() const {
+    std::size_t total = 0;
+    for (const auto& p : partitions_) total += p.size();
+    return total;
+}
+
+std::size_t MinimizerPartitionedFilter::memoryUsage() const {
+    std::size_t total = sizeof(*this);
+    for (const auto& p : partitions_) total += p.memoryUsage();
+    return total;
+}
+
+std::size_t MinimizerPartitionedFilter::num_partitions() const {
+    return partitions_.size();
+}
+
+const MyBambooFilter& MinimizerPartitionedFilter::partition(std::size_t index) const {
+    return partitions_.at(index);
+}
+
+unsigned MinimizerPartitionedFilter::k() const {
+    return k_;
+}
+
+unsigned MinimizerPartitionedFilter::m() const {
+    return m_;
+}
@@ -0,0 +1,79 @@
+#ifndef MY_BAMBOO_MINIMIZER_FILTER_H
+#define MY_BAMBOO_MINIMIZER_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "bamboo_filter.h"
+
+/**
+ * @file minimizer_filter.h
+ * @brief K-mer filter split into sub-filters selected by the k-mer's minimizer.
+ *
+ * Consecutive k-mers of a read mostly share the same minimizer (the smallest
+ * hashed canonical m-mer inside the k-mer), forming a "super-k-mer". Routing each
+ * k-mer to the sub-filter chosen by its minimizer keeps a whole super-k-mer inside
+ * one small, cache-resident sub-filter, so a read touches a few sub-filters instead
+ * of hundreds of random buckets in one large table. Minimizers are computed over
+ * canonical m-mers, so a k-mer and its reverse complement land in the same sub-filter.
+ */
+class MinimizerPartitionedFilter {
+public:
+    /**
+     * @brief Constructs the partitioned filter.
+     * @param num_partitions Number of sub-filters.
+     * @param k The k-mer length (1..32).
+     * @param m The minimizer length (1..k).
+     * @param partition_config Configuration of each sub-filter (initial_num_buckets is per sub-filter).
+     * @throws std::invalid_argument If num_partitions is 0 or k/m are out of range.
+     */
+    MinimizerPartitionedFilter(std::size_t num_partitions, unsigned k, unsigned m,
+                               const MyBambooFilter::Config& partition_config);
+
+    /**
+     * @brief Inserts every canonical k-mer of a DNA sequence.
+     * @param sequence The DNA sequence (line breaks are skipped, non-ACGT characters break k-mers).
+     * @return The number of k-mers processed.
+     */
+    std::size_t insert_kmers(std::string_view sequence);
+
+    /**
+     * @brief Counts how many canonical k-mers of a DNA sequence are possibly present.
+     * @param sequence The DNA sequence.
+     * @return The number of k-mers reported present.
+     */
+    std::size_t count_present_kmers(std::string_view sequence) const;
+
+    /** @brief Returns the total number of items over all sub-filters. */
+    std::size_t size() const;
+
+    /** @brief Returns the estimated memory usage of all sub-filters in bytes. */
+    std::size_t memoryUsage() const;
+
+    /** @brief Returns the number of sub-filters. */
+    std::size_t num_partitions() const;
+
+    /** @brief Returns one sub-filter, e.g. to inspect its load. */
+    const MyBambooFilter& partition(std::size_t index) const;
+
+    /** @brief Returns the k-mer length. */
+    unsigned k() const;
+
+    /** @brief Returns the minimizer length. */
+    unsigned m() const;
+
+private:
+    /**
+     * @brief Calls `fn(kmer_hash, partition)` for each canonical k-mer of `sequence`, in order.
+     * The k-mer hash is the same mix64() hash MyBambooFilter::insert_kmers() uses.
+     */
+    template <typename Fn>
+    void for_each_routed_kmer(std::string_view sequence, Fn&& fn) const;
+
+    unsigned k_;
+    unsigned m_;
+    std::vector<MyBambooFilter> partitions_;
+};
+
+#endif // MY_BAMBOO_MINIMIZER_FILTER_H
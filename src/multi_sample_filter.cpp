@@ -0,0 +1,277 @@
+#include "multi_sample_filter.h"
+#include "kmer.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+namespace {
+// Number of k-mers whose buckets are prefetched together in count_present_kmers().
+constexpr std::size_t kQueryGroup = 16;
+constexpr std::size_t kNoSlot = static_cast<std::size_t>(-1);
+} // namespace
+
+//================================================================================
+// Constructor
+//================================================================================
+
+MultiSampleFilter::MultiSampleFilter(std::size_t num_samples, const MyBambooFilter::Config& config)
+  : num_samples_(num_samples),
+    words_((num_samples + 63) / 64),
+    slots_per_bucket_(config.slots_per_bucket),
+    max_load_factor_(config.load_factor_threshold),
+    max_cuckoo_kicks_(config.max_cuckoo_kicks),
+    fingerprint_bits_(config.fingerprint_bits),
+    hash_policy_(config.hash_policy) {
+    if (num_samples_ == 0) throw std::invalid_argument("Number of samples must be greater than 0.");
+    if (config.initial_num_buckets == 0 || slots_per_bucket_ == 0) {
+        throw std::invalid_argument("Number of buckets and slots per bucket must be greater than 0.");
+    }
+    if (fingerprint_bits_ == 0 || fingerprint_bits_ > 16) {
+        throw std::invalid_argument("Fingerprint width must be between 1 and 16 bits.");
+    }
+    table_ = make_table(config.initial_num_buckets);
+}
+
+//================================================================================
+// Private Helpers: geometry
+//================================================================================
+
+MultiSampleFilter::Table MultiSampleFilter::make_table(std::size_t num_buckets) const {
+    Table table;
+    table.num_buckets = num_buckets;
+    table.fps.assign(num_buckets * slots_per_bucket_, 0);
+    table.hashes.assign(num_buckets * slots_per_bucket_, 0);
+    table.rows.assign(num_buckets * slots_per_bucket_ * words_, 0);
+    return table;
+}
+
+// Same index derivation as MyBambooFilter, so both candidate buckets follow from the hash alone.
+std::size_t MultiSampleFilter::primary_index(std::uint64_t h, std::size_t num_buckets) const {
+    return (h >> 16) % num_buckets;
+}
+
+std::size_t MultiSampleFilter::alternate_index(std::uint64_t h, std::size_t num_buckets) const {
+    const std::uint64_t fp_mix = static_cast<std::uint64_t>(fingerprint(h)) * 0x5bd1e995ULL;
+    return (primary_index(h, num_buckets) ^ fp_mix) % num_buckets;
+}
+
+MyBambooFilter::Fp MultiSampleFilter::fingerprint(std::uint64_t h) const {
+    const auto fp = static_cast<MyBambooFilter::Fp>(h & ((1u << fingerprint_bits_) - 1));
+    return fp == 0 ? 1 : fp;
+}
+
+std::size_t MultiSampleFilter::find_slot(std::uint64_t h) const {
+    const std::size_t buckets[2] = {primary_index(h, table_.num_buckets), alternate_index(h, table_.num_buckets)};
+    for (std::size_t b : buckets) {
+        const std::size_t base = b * slots_per_bucket_;
+        for (std::size_t s = base; s < base + slots_per_bucket_; ++s) {
+            if (table_.fps[s] != 0 && table_.hashes[s] == h) return s;
+        }
+    }
+    return kNoSlot;
+}
+
+//================================================================================
+// Private Helpers: placement and expansion
+//================================================================================
+
+bool MultiSampleFilter::place(Table& table, std::uint64_t& h, std::uint64_t* row) const {
+    static thread_local std::mt19937 rng(std::random_device{}()); // Thread-local RNG for cuckoo kicks
+    std::uniform_int_distribution<std::size_t> dist(0, slots_per_bucket_ - 1);
+
+    std::size_t bucket = primary_index(h, table.num_buckets);
+    for (int kick = 0; kick <= max_cuckoo_kicks_; ++kick) {
+        const std::size_t alt = alternate_index(h, table.num_buckets);
+        // Prefer a free slot in either candidate bucket.
+        for (std::size_t b : {bucket, alt}) {
+            const std::size_t base = b * slots_per_bucket_;
+            for (std::size_t s = base; s < base + slots_per_bucket_; ++s) {
+                if (table.fps[s] == 0) {
+                    table.fps[s] = fingerprint(h);
+                    table.hashes[s] = h;
+                    std::copy(row, row + words_, table.rows.begin() + s * words_);
+                    return true;
+                }
+            }
+        }
+        // Both full: evict a random victim and carry it to its other candidate bucket.
+        const std::size_t victim_bucket = bucket;
+        const std::size_t s = victim_bucket * slots_per_bucket_ + dist(rng);
+        std::swap(table.hashes[s], h);
+        table.fps[s] = fingerprint(table.hashes[s]);
+        std::swap_ranges(row, row + words_, table.rows.begin() + s * words_);
+        const std::size_t victim_primary = primary_index(h, table.num_buckets);
+        bucket = victim_primary == victim_bucket ? alternate_index(h, table.num_buckets) : victim_primary;
+    }
+    return false;
+}
+
+void MultiSampleFilter::grow() {
+    std::size_t new_buckets = table_.num_buckets * 2;
+    std::vector<std::uint64_t> row(words_);
+    for (;;) {
+        Table next = make_table(new_buckets);
+        bool ok = true;
+        for (std::size_t s = 0; s < table_.fps.size() && ok; ++s) {
+            if (table_.fps[s] == 0) continue;
+            std::uint64_t h = table_.hashes[s];
+            std::copy(table_.rows.begin() + s * words_, table_.rows.begin() + (s + 1) * words_, row.begin());
+            ok = place(next, h, row.data());
+        }
+        if (ok) {
+            table_ = std::move(next);
+            return;
+        }
+        new_buckets *= 2;
+    }
+}
+
+//================================================================================
+// Public Methods: insert
+//================================================================================
+
+void MultiSampleFilter::insert(std::size_t sample, std::string_view key) {
+    insert_hashed(sample, MyBambooFilter::hash_with_policy(hash_policy_, key));
+}
+
+void MultiSampleFilter::insert(std::size_t sample, std::uint64_t key) {
+    insert_hashed(sample, MyBambooFilter::mix64(key));
+}
+
+void MultiSampleFilter::insert_hashed(std::size_t sample, std::uint64_t h) {
+    if (sample >= num_samples_) throw std::out_of_range("Sample index out of range.");
+    const std::uint64_t bit = 1ULL << (sample % 64);
+
+    // A key already held by other samples only gains a bit in its existing row.
+    const std::size_t existing = find_slot(h);
+    if (existing != kNoSlot) {
+        table_.rows[existing * words_ + sample / 64] |= bit;
+        return;
+    }
+
+    if (static_cast<float>(items_ + 1) > max_load_factor_ * table_.fps.size()) grow();
+
+    std::vector<std::uint64_t> row(words_);
+    row[sample / 64] = bit;
+    while (!place(table_, h, row.data())) {
+        // The leftover entry (possibly a different key) is re-placed after doubling.
+        grow();
+    }
+    ++items_;
+}
+
+std::size_t MultiSampleFilter::insert_kmers(std::size_t sample, std::string_view sequence, unsigned k) {
+    std::size_t processed = 0;
+    kmer::for_each_canonical_kmer(sequence, k, [&](std::uint64_t code) {
+        insert_hashed(sample, MyBambooFilter::mix64(code));
+        ++processed;
+    });
+    return processed;
+}
+
+//================================================================================
+// Public Methods: queries
+//================================================================================
+
+void MultiSampleFilter::contains_hashed(std::uint64_t h, std::uint64_t* out) const {
+    std::fill(out, out + words_, 0);
+    const MyBambooFilter::Fp fp = fingerprint(h);
+    const std::size_t i1 = primary_index(h, table_.num_buckets);
+    const std::size_t i2 = alternate_index(h, table_.num_buckets);
+    for (std::size_t b : {i1, i2}) {
+        const std::size_t base = b * slots_per_bucket_;
+        for (std::size_t s = base; s < base + slots_per_bucket_; ++s) {
+            if (table_.fps[s] != fp) continue;
+            const std::uint64_t* row = table_.rows.data() + s * words_;
+            for (std::size_t w = 0; w < words_; ++w) out[w] |= row[w];
+        }
+        if (i1 == i2) break;
+    }
+}
+
+MultiSampleFilter::SampleBitmap MultiSampleFilter::contains(std::string_view key) const {
+    SampleBitmap result(words_);
+    contains_hashed(MyBambooFilter::hash_with_policy(hash_policy_, key), result.data());
+    return result;
+}
+
+MultiSampleFilter::SampleBitmap MultiSampleFilter::contains(std::uint64_t key) const {
+    SampleBitmap result(words_);
+    contains_hashed(MyBambooFilter::mix64(key), result.data());
+    return result;
+}
+
+std::vector<std::uint32_t> MultiSampleFilter::count_present_kmers(std::string_view sequence, unsigned k) const {
+    std::vector<std::uint32_t> counts(num_samples_, 0);
+    std::vector<std::uint64_t> hits(words_);
+    std::uint64_t group[kQueryGroup];
+    std::size_t buffered = 0;
+
+    auto flush = [&]() {
+        // Prefetch every candidate bucket's fingerprints before probing any of them.
+        for (std::size_t j = 0; j < buffered; ++j) {
+            __builtin_prefetch(&table_.fps[primary_index(group[j], table_.num_buckets) * slots_per_bucket_]);
+            __builtin_prefetch(&table_.fps[alternate_index(group[j], table_.num_buckets) * slots_per_bucket_]);
+        }
+        for (std::size_t j = 0; j < buffered; ++j) {
+            contains_hashed(group[j], hits.data());
+            for (std::size_t w = 0; w < words_; ++w) {
+                for (std::uint64_t bits = hits[w]; bits != 0; bits &= bits - 1) {
+                    ++counts[w * 64 + static_cast<std::size_t>(__builtin_ctzll(bits))];
+                }
+            }
+        }
+        buffered = 0;
+    };
+    kmer::for_each_canonical_kmer(sequence, k, [&](std::uint64_t code) {
+        group[buffered++] = MyBambooFilter::mix64(code);
+        if (buffered == kQueryGroup) flush();
+    });
+    flush();
+    return counts;
+}
+
+//================================================================================
+// Public Methods: erase
+//================================================================================
+
+bool MultiSampleFilter::erase(std::size_t sample, std::string_view key) {
+    return erase_hashed(sample, MyBambooFilter::hash_with_policy(hash_policy_, key));
+}
+
+bool MultiSampleFilter::erase_hashed(std::size_t sample, std::uint64_t h) {
+    if (sample >= num_samples_) throw std::out_of_range("Sample index out of range.");
+    const std::size_t s = find_slot(h);
+    if (s == kNoSlot) return false;
+    std::uint64_t* row = table_.rows.data() + s * words_;
+    const std::uint64_t bit = 1ULL << (sample % 64);
+    if ((row[sample / 64] & bit) == 0) return false;
+    row[sample / 64] &= ~bit;
+    if (std::all_of(row, row + words_, [](std::uint64_t w) { return w == 0; })) {
+        table_.fps[s] = 0;
+        table_.hashes[s] = 0;
+        --items_;
+    }
+    return true;
+}
+
+//================================================================================
+// Public Methods: statistics
+//================================================================================
+
+std::size_t MultiSampleFilter::num_samples() const { return num_samples_; }
+
+std::size_t MultiSampleFilter::bitmap_words() const { return words_; }
+
+std::size_t MultiSampleFilter::size() const { return items_; }
+
+std::size_t MultiSampleFilter::capacity_buckets() const { return table_.num_buckets; }
+
+float MultiSampleFilter::loadFactor() const {
+    return table_.fps.empty() ? 0.0f : static_cast<float>(items_) / table_.fps.size();
+}
+
+std::size_t MultiSampleFilter::memoryUsage() const {
+    return sizeof(*this) + table_.fps.capacity() * sizeof(MyBambooFilter::Fp) +
+           table_.hashes.capacity() * sizeof(std::uint64_t) + table_.rows.capacity() * sizeof(std::uint64_t);
+}
@@ -0,0 +1,151 @@
+#ifndef MY_BAMBOO_MULTI_SAMPLE_FILTER_H
+#define MY_BAMBOO_MULTI_SAMPLE_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "bamboo_filter.h"
+
+/**
+ * @file multi_sample_filter.h
+ * @brief One cuckoo table shared by many samples, with a sample bitmap per slot.
+ *
+ * Instead of one MyBambooFilter per sample, every sample shares a single
+ * geometry and hash: a key is hashed once, lands in the same two candidate
+ * buckets for all samples, and occupies one slot whose bitmap row records which
+ * samples contain it. A query therefore reads two buckets of fingerprints plus
+ * the contiguous bitmap rows of the matching slots, independent of the number of
+ * samples, and returns the set of samples as a bitmap.
+ *
+ * Storage is flat: fingerprints, full hashes (used to rehash on expansion, as in
+ * MyBambooFilter) and bitmap rows each live in one array indexed by
+ * `bucket * slots_per_bucket + slot`. There is no stash; when the kick limit is
+ * reached the table doubles.
+ */
+class MultiSampleFilter {
+public:
+    /** @brief Set of samples, bit `s % 64` of word `s / 64` standing for sample `s`. */
+    using SampleBitmap = std::vector<std::uint64_t>;
+
+    /**
+     * @brief Constructs an empty multi-sample filter.
+     * @param num_samples Number of samples (bitmap width).
+     * @param config Shared table geometry; the expansion policy is not used.
+     * @throws std::invalid_argument If num_samples is 0 or the configuration is invalid.
+     */
+    MultiSampleFilter(std::size_t num_samples, const MyBambooFilter::Config& config = MyBambooFilter::Config());
+
+    /**
+     * @brief Adds a key to one sample.
+     * @param sample The sample index.
+     * @param key The key.
+     * @throws std::out_of_range If the sample index is out of range.
+     */
+    void insert(std::size_t sample, std::string_view key);
+
+    /** @brief Adds an integer key (hashed with MyBambooFilter::mix64()) to one sample. */
+    void insert(std::size_t sample, std::uint64_t key);
+
+    /** @brief Adds a pre-hashed key to one sample. */
+    void insert_hashed(std::size_t sample, std::uint64_t h);
+
+    /**
+     * @brief Adds every canonical k-mer of a DNA sequence to one sample.
+     * Uses the same k-mer hashing as MyBambooFilter::insert_kmers().
+     * @return The number of k-mers processed.
+     * @throws std::invalid_argument If k is out of range.
+     */
+    std::size_t insert_kmers(std::size_t sample, std::string_view sequence, unsigned k);
+
+    /**
+     * @brief Returns the samples that possibly contain a key.
+     * @param key The key.
+     * @return A bitmap of num_samples() bits.
+     */
+    SampleBitmap contains(std::string_view key) const;
+
+    /** @brief Returns the samples that possibly contain an integer key. */
+    SampleBitmap contains(std::uint64_t key) const;
+
+    /**
+     * @brief Writes the samples that possibly contain a pre-hashed key into `out`.
+     * @param h The item hash.
+     * @param out Destination of bitmap_words() words; overwritten.
+     */
+    void contains_hashed(std::uint64_t h, std::uint64_t* out) const;
+
+    /**
+     * @brief Counts, per sample, how many canonical k-mers of a sequence it possibly contains.
+     * @param sequence The DNA sequence.
+     * @param k The k-mer length.
+     * @return num_samples() counts.
+     */
+    std::vector<std::uint32_t> count_present_kmers(std::string_view sequence, unsigned k) const;
+
+    /**
+     * @brief Removes a key from one sample; the slot is freed when no sample holds the key anymore.
+     * @return True if the key was recorded for that sample.
+     */
+    bool erase(std::size_t sample, std::string_view key);
+
+    /** @brief Removes a pre-hashed key from one sample. */
+    bool erase_hashed(std::size_t sample, std::uint64_t h);
+
+    /** @brief Returns the number of samples. */
+    std::size_t num_samples() const;
+
+    /** @brief Returns the number of 64-bit words in a sample bitmap. */
+    std::size_t bitmap_words() const;
+
+    /** @brief Returns the number of distinct keys over all samples. */
+    std::size_t size() const;
+
+    /** @brief Returns the current number of buckets. */
+    std::size_t capacity_buckets() const;
+
+    /** @brief Returns distinct keys divided by total slots. */
+    float loadFactor() const;
+
+    /** @brief Returns the estimated memory usage in bytes. */
+    std::size_t memoryUsage() const;
+
+private:
+    /** @brief Flat slot storage for one table geometry. */
+    struct Table {
+        std::size_t num_buckets = 0;
+        std::vector<MyBambooFilter::Fp> fps;   ///< 0 marks an empty slot
+        std::vector<std::uint64_t> hashes;
+        std::vector<std::uint64_t> rows;       ///< bitmap_words() words per slot
+    };
+
+    Table make_table(std::size_t num_buckets) const;
+    std::size_t primary_index(std::uint64_t h, std::size_t num_buckets) const;
+    std::size_t alternate_index(std::uint64_t h, std::size_t num_buckets) const;
+    MyBambooFilter::Fp fingerprint(std::uint64_t h) const;
+
+    /** @brief Returns the slot holding exactly this hash, or npos. */
+    std::size_t find_slot(std::uint64_t h) const;
+
+    /**
+     * @brief Places (h, row) into `table`, kicking entries as needed.
+     * On failure, `h` and `row` hold the entry left without a home.
+     * @return True if everything found a slot.
+     */
+    bool place(Table& table, std::uint64_t& h, std::uint64_t* row) const;
+
+    /** @brief Doubles the table (repeatedly, if placement fails) and re-places every entry. */
+    void grow();
+
+    std::size_t num_samples_;
+    std::size_t words_;
+    std::size_t slots_per_bucket_;
+    float max_load_factor_;
+    int max_cuckoo_kicks_;
+    unsigned fingerprint_bits_;
+    MyBambooFilter::HashPolicy hash_policy_;
+    std::size_t items_ = 0;
+    Table table_;
+};
+
+#endif // MY_BAMBOO_MULTI_SAMPLE_FILTER_H
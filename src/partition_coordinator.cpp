@@ -0,0 +1,426 @@
+#include "partition_coordinator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// Wire protocol: every request is a RequestHeader followed by `count` 64-bit words.
+enum class Op : std::uint32_t {
+    Insert = 1,   ///< Payload: hashes. Reply: u64 item count afterwards.
+    Contains = 2, ///< Payload: hashes. Reply: one byte per hash.
+    Erase = 3,    ///< Payload: hashes. Reply: u64 number erased.
+    Extract = 4,  ///< Payload: first, last hash. Reply: u64 n, then n hashes (removed from the worker).
+    Stats = 5,    ///< No payload. Reply: u64 items, buckets, memory bytes.
+    Shutdown = 6, ///< No payload, no reply.
+};
+
+struct RequestHeader {
+    std::uint32_t op;
+    std::uint32_t reserved;
+    std::uint64_t count;
+};
+
+void write_all(int fd, const void* data, std::size_t len) {
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        const ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Partition worker connection failed: ") + std::strerror(errno));
+        }
+        p += n;
+        len -= static_cast<std::size_t>(n);
+    }
+}
+
+void read_all(int fd, void* data, std::size_t len) {
+    char* p = static_cast<char*>(data);
+    while (len > 0) {
+        const ssize_t n = ::read(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Partition worker connection failed: ") + std::strerror(errno));
+        }
+        if (n == 0) throw std::runtime_error("Partition worker closed the connection.");
+        p += n;
+        len -= static_cast<std::size_t>(n);
+    }
+}
+
+void send_request(int fd, Op op, const std::uint64_t* payload, std::size_t count) {
+    const RequestHeader header{static_cast<std::uint32_t>(op), 0, count};
+    write_all(fd, &header, sizeof(header));
+    if (count > 0) write_all(fd, payload, count * sizeof(std::uint64_t));
+}
+
+std::uint64_t read_u64(int fd) {
+    std::uint64_t value = 0;
+    read_all(fd, &value, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Runs one worker's step of a batched exchange. A connection error is stored in
+ * `error` (the first one is kept) instead of thrown, so the caller can still finish the
+ * other workers' exchanges and keep their streams in step.
+ * @return False if the step failed.
+ */
+template <typename Step>
+bool try_step(Step&& step, std::exception_ptr& error) {
+    try {
+        step();
+        return true;
+    } catch (const std::runtime_error&) {
+        if (!error) error = std::current_exception();
+        return false;
+    }
+}
+
+/** @brief Request loop of a worker process; returns when asked to shut down or the coordinator goes away. */
+void serve(int fd, const MyBambooFilter::Config& config) {
+    MyBambooFilter filter(config);
+    std::vector<std::uint64_t> payload;
+    std::vector<std::uint8_t> flags;
+    for (;;) {
+        RequestHeader header{};
+        read_all(fd, &header, sizeof(header));
+        payload.resize(header.count);
+        if (header.count > 0) read_all(fd, payload.data(), header.count * sizeof(std::uint64_t));
+
+        switch (static_cast<Op>(header.op)) {
+            case Op::Insert: {
+                // Every distinct hash gets its own entry, so a split moves each key with its range.
+                for (std::uint64_t h : payload) filter.insert_distinct_hashed(h);
+                const std::uint64_t items = filter.size();
+                write_all(fd, &items, sizeof(items));
+                break;
+            }
+            case Op::Contains: {
+                flags.resize(payload.size());
+                for (std::size_t i = 0; i < payload.size(); ++i) flags[i] = filter.contains_hashed(payload[i]);
+                write_all(fd, flags.data(), flags.size());
+                break;
+            }
+            case Op::Erase: {
+                std::uint64_t erased = 0;
+                for (std::uint64_t h : payload) erased += filter.erase_hashed(h);
+                write_all(fd, &erased, sizeof(erased));
+                break;
+            }
+            case Op::Extract: {
+                if (payload.size() != 2) throw std::runtime_error("Malformed extract request.");
+                std::vector<std::uint64_t> moved;
+                auto cursor = filter.entries();
+                MyBambooFilter::Entry entry;
+                while (cursor.next(entry)) {
+                    if (entry.hash >= payload[0] && entry.hash <= payload[1]) moved.push_back(entry.hash);
+                }
+                for (std::uint64_t h : moved) filter.erase_hashed(h);
+                filter.compact();
+                const std::uint64_t n = moved.size();
+                write_all(fd, &n, sizeof(n));
+                if (n > 0) write_all(fd, moved.data(), moved.size() * sizeof(std::uint64_t));
+                break;
+            }
+            case Op::Stats: {
+                const std::uint64_t reply[3] = {filter.size(), filter.capacity_buckets(), filter.memoryUsage()};
+                write_all(fd, reply, sizeof(reply));
+                break;
+            }
+            case Op::Shutdown:
+                return;
+            default:
+                throw std::runtime_error("Unknown partition request.");
+        }
+    }
+}
+
+} // namespace
+
+//================================================================================
+// Constructor, destructor and worker management
+//================================================================================
+
+PartitionCoordinator::PartitionCoordinator(const Options& options) : config_(options.config) {
+    if (options.num_workers == 0) throw std::invalid_argument("Number of workers must be greater than 0.");
+    workers_.reserve(options.num_workers);
+    try {
+        for (std::size_t i = 0; i < options.num_workers; ++i) {
+            // Even split of [0, 2^64): partition i starts at i * 2^64 / N.
+            const auto first = static_cast<std::uint64_t>((static_cast<unsigned __int128>(i) << 64) / options.num_workers);
+            const auto next = static_cast<std::uint64_t>((static_cast<unsigned __int128>(i + 1) << 64) / options.num_workers);
+            Worker worker = spawn(config_);
+            worker.first_hash = first;
+            worker.last_hash = i + 1 == options.num_workers ? ~0ULL : next - 1;
+            workers_.push_back(worker);
+        }
+    } catch (...) {
+        shutdown_workers();
+        throw;
+    }
+}
+
+PartitionCoordinator::~PartitionCoordinator() {
+    shutdown_workers();
+}
+
+void PartitionCoordinator::shutdown_workers() {
+    for (const Worker& worker : workers_) {
+        if (worker.fd >= 0) {
+            // A busy worker's stream is out of step; closing the socket alone makes it exit.
+            if (!worker.busy) {
+                try {
+                    send_request(worker.fd, Op::Shutdown, nullptr, 0);
+                } catch (const std::exception&) {
+                    // The worker is gone already; it is reaped below.
+                }
+            }
+            ::close(worker.fd);
+        }
+        ::waitpid(worker.pid, nullptr, 0);
+    }
+    workers_.clear();
+}
+
+void PartitionCoordinator::retire(std::size_t p) {
+    Worker& worker = workers_[p];
+    if (worker.fd < 0) return;
+    ::close(worker.fd); // The worker reads end of file, or fails its next write, and exits
+    worker.fd = -1;
+    worker.busy = false;
+}
+
+void PartitionCoordinator::require_worker(std::size_t p) {
+    Worker& worker = workers_[p];
+    if (worker.busy) retire(p); // An earlier exchange failed part-way; the stream is out of step
+    if (worker.fd < 0) {
+        throw std::runtime_error("Partition worker for hashes " + std::to_string(worker.first_hash) + ".." +
+                                 std::to_string(worker.last_hash) + " has failed; its items are lost.");
+    }
+}
+
+int PartitionCoordinator::begin_request(std::size_t p) {
+    workers_[p].busy = true;
+    return workers_[p].fd;
+}
+
+PartitionCoordinator::Worker PartitionCoordinator::spawn(const MyBambooFilter::Config& config) {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        throw std::runtime_error(std::string("Cannot create worker socket: ") + std::strerror(errno));
+    }
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        throw std::runtime_error(std::string("Cannot fork partition worker: ") + std::strerror(errno));
+    }
+    if (pid == 0) {
+        // Worker: keep only its own end, so siblings see EOF when the coordinator exits.
+        ::close(fds[0]);
+        for (const Worker& other : workers_) {
+            if (other.fd >= 0) ::close(other.fd);
+        }
+        int status = 0;
+        try {
+            serve(fds[1], config);
+        } catch (const std::exception&) {
+            status = 1;
+        }
+        ::_exit(status);
+    }
+    ::close(fds[1]);
+    return Worker{0, 0, pid, fds[0]};
+}
+
+//================================================================================
+// Routing and batched operations
+//================================================================================
+
+std::size_t PartitionCoordinator::route(std::uint64_t h) const {
+    const auto it = std::upper_bound(workers_.begin(), workers_.end(), h,
+                                     [](std::uint64_t value, const Worker& w) { return value < w.first_hash; });
+    return static_cast<std::size_t>(it - workers_.begin()) - 1;
+}
+
+std::vector<std::vector<std::size_t>> PartitionCoordinator::group(const std::uint64_t* hashes, std::size_t count) const {
+    std::vector<std::vector<std::size_t>> groups(workers_.size());
+    for (std::size_t i = 0; i < count; ++i) groups[route(hashes[i])].push_back(i);
+    return groups;
+}
+
+void PartitionCoordinator::insert(std::string_view key) {
+    const std::uint64_t h = MyBambooFilter::hash_with_policy(config_.hash_policy, key);
+    insert_hashed_batch(&h, 1);
+}
+
+bool PartitionCoordinator::contains(std::string_view key) {
+    const std::uint64_t h = MyBambooFilter::hash_with_policy(config_.hash_policy, key);
+    bool found = false;
+    contains_hashed_batch(&h, 1, &found);
+    return found;
+}
+
+void PartitionCoordinator::insert_hashed_batch(const std::uint64_t* hashes, std::size_t count) {
+    const auto groups = group(hashes, count);
+    for (std::size_t p = 0; p < groups.size(); ++p) {
+        if (!groups[p].empty()) require_worker(p);
+    }
+    std::exception_ptr error;
+    std::vector<std::uint64_t> part;
+    // Send every part before reading any reply, so the workers run concurrently.
+    for (std::size_t p = 0; p < groups.size(); ++p) {
+        if (groups[p].empty()) continue;
+        part.clear();
+        for (std::size_t i : groups[p]) part.push_back(hashes[i]);
+        if (!try_step([&] { send_request(begin_request(p), Op::Insert, part.data(), part.size()); }, error)) retire(p);
+    }
+    for (std::size_t p = 0; p < groups.size(); ++p) {
+        if (groups[p].empty() || workers_[p].fd < 0) continue;
+        if (try_step([&] { read_u64(workers_[p].fd); }, error)) reply_done(p);
+        else retire(p);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void PartitionCoordinator::contains_hashed_batch(const std::uint64_t* hashes, std::size_t count, bool* results) {
+    const auto groups = group(hashes, count);
+    for (std::size_t p = 0; p < groups.size(); ++p) {
+        if (!groups[p].empty()) require_worker(p);
+    }
+    std::exception_ptr error;
+    std::vector<std::uint64_t> part;
+    for (std::size_t p = 0; p < groups.size(); ++p) {
+        if (groups[p].empty()) continue;
+        part.clear();
+        for (std::size_t i : groups[p]) part.push_back(hashes[i]);
+        if (!try_step([&] { send_request(begin_request(p), Op::Contains, part.data(), part.size()); }, error)) retire(p);
+    }
+    std::vector<std::uint8_t> flags;
+    for (std::size_t p = 0; p < groups.size(); ++p) {
+        if (groups[p].empty() || workers_[p].fd < 0) continue;
+        flags.resize(groups[p].size());
+        if (!try_step([&] { read_all(workers_[p].fd, flags.data(), flags.size()); }, error)) {
+            retire(p);
+            continue;
+        }
+        reply_done(p);
+        for (std::size_t j = 0; j < flags.size(); ++j) results[groups[p][j]] = flags[j] != 0;
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+std::size_t PartitionCoordinator::erase_hashed_batch(const std::uint64_t* hashes, std::size_t count) {
+    const auto groups = group(hashes, count);
+    for (std::size_t p = 0; p < groups.size(); ++p) {
+        if (!groups[p].empty()) require_worker(p);
+    }
+    std::exception_ptr error;
+    std::vector<std::uint64_t> part;
+    for (std::size_t p = 0; p < groups.size(); ++p) {
+        if (groups[p].empty()) continue;
+        part.clear();
+        for (std::size_t i : groups[p]) part.push_back(hashes[i]);
+        if (!try_step([&] { send_request(begin_request(p), Op::Erase, part.data(), part.size()); }, error)) retire(p);
+    }
+    std::size_t erased = 0;
+    for (std::size_t p = 0; p < groups.size(); ++p) {
+        if (groups[p].empty() || workers_[p].fd < 0) continue;
+        if (try_step([&] { erased += read_u64(workers_[p].fd); }, error)) reply_done(p);
+        else retire(p);
+    }
+    if (error) std::rethrow_exception(error);
+    return erased;
+}
+
+//================================================================================
+// Statistics and rebalancing
+//================================================================================
+
+std::vector<PartitionCoordinator::PartitionStats> PartitionCoordinator::stats() {
+    for (std::size_t p = 0; p < workers_.size(); ++p) require_worker(p);
+    std::exception_ptr error;
+    for (std::size_t p = 0; p < workers_.size(); ++p) {
+        if (!try_step([&] { send_request(begin_request(p), Op::Stats, nullptr, 0); }, error)) retire(p);
+    }
+    std::vector<PartitionStats> result;
+    result.reserve(workers_.size());
+    for (std::size_t p = 0; p < workers_.size(); ++p) {
+        const Worker& worker = workers_[p];
+        if (worker.fd < 0) continue;
+        std::uint64_t reply[3];
+        if (!try_step([&] { read_all(worker.fd, reply, sizeof(reply)); }, error)) {
+            retire(p);
+            continue;
+        }
+        reply_done(p);
+        result.push_back(PartitionStats{worker.first_hash, worker.last_hash, worker.pid, reply[0], reply[1], reply[2]});
+    }
+    if (error) std::rethrow_exception(error);
+    return result;
+}
+
+void PartitionCoordinator::split_partition(std::size_t index) {
+    if (index >= workers_.size()) throw std::out_of_range("Partition index out of range.");
+    const Worker& old_worker = workers_[index];
+    if (old_worker.first_hash == old_worker.last_hash) throw std::invalid_argument("Partition range cannot be split.");
+    require_worker(index);
+    const std::uint64_t mid = old_worker.first_hash + (old_worker.last_hash - old_worker.first_hash) / 2;
+
+    // Pull the upper half out of the old worker.
+    const std::uint64_t range[2] = {mid + 1, old_worker.last_hash};
+    send_request(begin_request(index), Op::Extract, range, 2);
+    std::vector<std::uint64_t> moved(read_u64(old_worker.fd));
+    if (!moved.empty()) read_all(old_worker.fd, moved.data(), moved.size() * sizeof(std::uint64_t));
+    reply_done(index);
+
+    // Start the new worker large enough for its share, so it does not rebuild right away.
+    MyBambooFilter::Config config = config_;
+    const auto needed = static_cast<std::size_t>(
+        std::ceil(moved.size() / (config.slots_per_bucket * static_cast<double>(config.load_factor_threshold))));
+    config.initial_num_buckets = std::max(config.initial_num_buckets, needed);
+    Worker new_worker;
+    try {
+        new_worker = spawn(config);
+    } catch (...) {
+        // Give the items back, so a failed fork loses nothing.
+        if (!moved.empty()) {
+            send_request(begin_request(index), Op::Insert, moved.data(), moved.size());
+            read_u64(workers_[index].fd);
+            reply_done(index);
+        }
+        throw;
+    }
+    new_worker.first_hash = mid + 1;
+    new_worker.last_hash = workers_[index].last_hash;
+    workers_[index].last_hash = mid;
+    workers_.insert(workers_.begin() + static_cast<std::ptrdiff_t>(index) + 1, new_worker);
+
+    if (!moved.empty()) {
+        send_request(begin_request(index + 1), Op::Insert, moved.data(), moved.size());
+        read_u64(new_worker.fd);
+        reply_done(index + 1);
+    }
+}
+
+std::size_t PartitionCoordinator::split_largest() {
+    const auto current = stats();
+    std::size_t largest = 0;
+    for (std::size_t p = 1; p < current.size(); ++p) {
+        if (current[p].items > current[largest].items) largest = p;
+    }
+    split_partition(largest);
+    return largest;
+}
+
+std::size_t PartitionCoordinator::num_partitions() const {
+    return workers_.size();
+}
@@ -0,0 +1,158 @@
+#ifndef MY_BAMBOO_PARTITION_COORDINATOR_H
+#define MY_BAMBOO_PARTITION_COORDINATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+#include "bamboo_filter.h"
+
+/**
+ * @file partition_coordinator.h
+ * @brief Spreads one logical filter over several worker processes by hash range.
+ *
+ * The coordinator forks one worker process per partition. Each worker owns a
+ * MyBambooFilter holding the items whose 64-bit hash falls in the partition's
+ * range, and serves batched requests over a local socket pair. Workers insert with
+ * MyBambooFilter::insert_distinct_hashed(), so every distinct hash has its own entry
+ * and moves with its range when the partition is split. Batches are routed
+ * by range, sent to all involved workers first and answered afterwards, so workers
+ * process their parts in parallel.
+ *
+ * A partition that grows too large can be split at the midpoint of its range: the
+ * upper half of its items moves to a newly forked worker. Like rebuild_table(),
+ * which doubles the bucket count so that every item either stays or moves by one
+ * extra hash bit, a split decides each item's side by one more bit of its hash.
+ *
+ * If an exchange with a worker fails part-way (a socket error, a worker that
+ * exited, or an exception while a reply is outstanding), the worker's stream can
+ * no longer be trusted. It is retired: its socket is closed and every later request
+ * routed to its range throws std::runtime_error. Workers are not restarted, since
+ * the items they held are lost with them.
+ */
+class PartitionCoordinator {
+public:
+    /** @brief Deployment settings. */
+    struct Options {
+        std::size_t num_workers = 4;     ///< Initial partitions; hash space is divided evenly
+        MyBambooFilter::Config config;   ///< Configuration of every worker's filter
+    };
+
+    /** @brief State of one partition as reported by its worker. */
+    struct PartitionStats {
+        std::uint64_t first_hash;   ///< Inclusive lower bound of the hash range
+        std::uint64_t last_hash;    ///< Inclusive upper bound of the hash range
+        pid_t pid;                  ///< Worker process
+        std::size_t items;
+        std::size_t buckets;
+        std::size_t memory_bytes;
+    };
+
+    /**
+     * @brief Forks the worker processes. Create the coordinator before starting other threads.
+     * @param options Deployment settings.
+     * @throws std::invalid_argument If num_workers is 0.
+     * @throws std::runtime_error If a worker cannot be started.
+     */
+    explicit PartitionCoordinator(const Options& options);
+
+    /** @brief Shuts all workers down and reaps them. */
+    ~PartitionCoordinator();
+
+    PartitionCoordinator(const PartitionCoordinator&) = delete;
+    PartitionCoordinator& operator=(const PartitionCoordinator&) = delete;
+
+    /** @brief Inserts a key hashed with the configured hash policy. */
+    void insert(std::string_view key);
+
+    /** @brief Checks a key hashed with the configured hash policy. */
+    bool contains(std::string_view key);
+
+    /**
+     * @brief Inserts pre-hashed items, routed to their partitions.
+     * @throws std::runtime_error If a worker fails now or failed earlier.
+     */
+    void insert_hashed_batch(const std::uint64_t* hashes, std::size_t count);
+
+    /**
+     * @brief Checks pre-hashed items; `results[i]` answers `hashes[i]`.
+     * @throws std::runtime_error If a worker fails now or failed earlier.
+     */
+    void contains_hashed_batch(const std::uint64_t* hashes, std::size_t count, bool* results);
+
+    /**
+     * @brief Erases pre-hashed items.
+     * @return The number of items that were found and erased.
+     */
+    std::size_t erase_hashed_batch(const std::uint64_t* hashes, std::size_t count);
+
+    /** @brief Queries every worker for its partition's state, in hash-range order. */
+    std::vector<PartitionStats> stats();
+
+    /**
+     * @brief Splits a partition at the midpoint of its hash range, moving the upper half
+     * of its items to a new worker.
+     *
+     * The new worker is forked from the calling process, so, as for the constructor, call
+     * this only while the process runs no other threads. A thread holding a lock (inside
+     * malloc, for example) at the moment of the fork leaves it held forever in the worker.
+     * @param index Partition index in hash-range order.
+     * @throws std::out_of_range If the index is out of range.
+     * @throws std::invalid_argument If the range holds a single hash value.
+     * @throws std::runtime_error If the partition's worker failed or a new one cannot be started.
+     */
+    void split_partition(std::size_t index);
+
+    /**
+     * @brief Splits the partition holding the most items.
+     * @return The index of the partition that was split.
+     */
+    std::size_t split_largest();
+
+    /** @brief Returns the current number of partitions. */
+    std::size_t num_partitions() const;
+
+private:
+    struct Worker {
+        std::uint64_t first_hash;
+        std::uint64_t last_hash;
+        pid_t pid;
+        int fd;             ///< -1 once the worker is retired
+        bool busy = false;  ///< A request was sent and its reply not yet read in full
+    };
+
+    /** @brief Forks a worker whose filter starts with `config`; the caller sets its range. */
+    Worker spawn(const MyBambooFilter::Config& config);
+
+    /** @brief Asks every worker to exit, closes the sockets and reaps the processes. */
+    void shutdown_workers();
+
+    /**
+     * @brief Checks that worker `p` can take a request. A worker still busy from an earlier
+     * exchange that failed part-way is retired first. Call for every worker an operation
+     * involves before sending anything, so a retired worker fails the operation up front.
+     * @throws std::runtime_error If the worker is retired.
+     */
+    void require_worker(std::size_t p);
+
+    /** @brief Marks worker `p` busy and returns its socket for sending a request. */
+    int begin_request(std::size_t p);
+
+    /** @brief Records that the reply of worker `p` was read in full. */
+    void reply_done(std::size_t p) { workers_[p].busy = false; }
+
+    /** @brief Closes the socket of worker `p`, which then exits on end of file. */
+    void retire(std::size_t p);
+
+    /** @brief Returns the partition owning a hash. */
+    std::size_t route(std::uint64_t h) const;
+
+    /** @brief Groups batch positions by partition. */
+    std::vector<std::vector<std::size_t>> group(const std::uint64_t* hashes, std::size_t count) const;
+
+    MyBambooFilter::Config config_;
+    std::vector<Worker> workers_; ///< Sorted by first_hash; ranges tile the hash space
+};
+
+#endif // MY_BAMBOO_PARTITION_COORDINATOR_H
@@ -0,0 +1,432 @@
+#include "shm_filter.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char kShmMagic[8] = {'B', 'A', 'M', 'B', 'O', 'O', 'S', 'H'};
+constexpr std::uint32_t kShmLayoutVersion = 2;
+// Header::index_layout values.
+constexpr std::uint32_t kPowerOfTwoLayout = 0; ///< create(): masked primary, XOR alternate
+constexpr std::uint32_t kCopiedLayout = 1;     ///< create_from(): MyBambooFilter's index functions
+// Yields a reader waits on an odd sequence counter before checking whether the writer died.
+constexpr unsigned kSpinsBeforeWriterCheck = 1024;
+
+std::runtime_error system_error(const std::string& what, const std::string& name) {
+    return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+}
+
+std::size_t round_up_pow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Table cells are read while the writer may modify them; relaxed atomic accesses keep
+// that well-defined, and the sequence counter provides the ordering.
+inline std::uint16_t load_cell(const std::uint16_t* cell) { return __atomic_load_n(cell, __ATOMIC_RELAXED); }
+inline void store_cell(std::uint16_t* cell, std::uint16_t value) { __atomic_store_n(cell, value, __ATOMIC_RELAXED); }
+} // namespace
+
+/** @brief Metadata at the start of the shared-memory object; the fingerprint table follows it. */
+struct SharedMemoryBambooFilter::Header {
+    char magic[8];                        ///< Written last by create(), so readers never see a partial header
+    std::uint32_t layout_version;
+    std::uint32_t fingerprint_bits;
+    std::uint64_t num_buckets;            ///< Power of two unless the layout is copied
+    std::uint64_t slots_per_bucket;
+    std::uint64_t max_cuckoo_kicks;
+    std::uint32_t hash_policy;
+    std::uint32_t index_layout;           ///< kPowerOfTwoLayout or kCopiedLayout
+    std::uint64_t alternate_window;       ///< MyBambooFilter::alternate_window_buckets() of a copied layout
+    alignas(64) std::atomic<std::uint64_t> sequence; ///< Odd while the writer is modifying the table
+    std::atomic<std::uint64_t> items;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared-memory counters must be lock-free.");
+
+std::size_t SharedMemoryBambooFilter::header_bytes() {
+    return (sizeof(Header) + 63) / 64 * 64;
+}
+
+//================================================================================
+// Creation, opening and lifetime
+//================================================================================
+
+SharedMemoryBambooFilter SharedMemoryBambooFilter::create(const std::string& name, const Options& options) {
+    if (options.num_buckets == 0 || options.slots_per_bucket == 0) {
+        throw std::invalid_argument("Number of buckets and slots per bucket must be greater than 0.");
+    }
+    if (options.fingerprint_bits == 0 || options.fingerprint_bits > 16) {
+        throw std::invalid_argument("Fingerprint width must be between 1 and 16 bits.");
+    }
+    SharedMemoryBambooFilter filter = create_object(name, round_up_pow2(options.num_buckets), options.slots_per_bucket);
+    Header* header = filter.header_;
+    header->fingerprint_bits = options.fingerprint_bits;
+    header->max_cuckoo_kicks = options.max_cuckoo_kicks;
+    header->hash_policy = static_cast<std::uint32_t>(options.hash_policy);
+    header->index_layout = kPowerOfTwoLayout;
+    filter.load_geometry();
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kShmMagic, sizeof(kShmMagic));
+    return filter;
+}
+
+SharedMemoryBambooFilter SharedMemoryBambooFilter::create_from(const std::string& name, const MyBambooFilter& source) {
+    // Stashed items make some buckets longer than slots_per_bucket(); every bucket gets room for the longest.
+    std::vector<std::size_t> fill(source.capacity_buckets(), 0);
+    std::size_t slots = source.slots_per_bucket();
+    auto cursor = source.entries();
+    MyBambooFilter::Entry entry;
+    while (cursor.next(entry)) slots = std::max(slots, ++fill[entry.bucket]);
+
+    SharedMemoryBambooFilter filter = create_object(name, source.capacity_buckets(), slots);
+    Header* header = filter.header_;
+    header->fingerprint_bits = source.fingerprint_bits();
+    header->max_cuckoo_kicks = 0; // Copied layouts cannot kick
+    header->hash_policy = static_cast<std::uint32_t>(source.hash_policy());
+    header->index_layout = kCopiedLayout;
+    header->alternate_window = source.alternate_window_buckets();
+    filter.load_geometry();
+
+    // No reader can open the object before the magic is written, so the table is filled without the seqlock.
+    std::fill(fill.begin(), fill.end(), std::size_t{0});
+    std::uint64_t items = 0;
+    cursor = source.entries();
+    while (cursor.next(entry)) {
+        filter.table_[entry.bucket * slots + fill[entry.bucket]++] = entry.fingerprint;
+        ++items;
+    }
+    header->items.store(items, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kShmMagic, sizeof(kShmMagic));
+    return filter;
+}
+
+SharedMemoryBambooFilter SharedMemoryBambooFilter::create_object(const std::string& name, std::size_t num_buckets,
+                                                                 std::size_t slots_per_bucket) {
+    const std::size_t bytes = header_bytes() + num_buckets * slots_per_bucket * sizeof(std::uint16_t);
+
+    const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) throw system_error("Cannot create shared memory", name);
+    if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        const auto error = system_error("Cannot lock shared memory", name);
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw error;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        const auto error = system_error("Cannot size shared memory", name);
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw error;
+    }
+    void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        const auto error = system_error("Cannot map shared memory", name);
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw error;
+    }
+
+    // ftruncate() zero-fills, so the table starts out empty (fingerprint 0 marks a free slot).
+    auto* header = new (base) Header{};
+    header->layout_version = kShmLayoutVersion;
+    header->num_buckets = num_buckets;
+    header->slots_per_bucket = slots_per_bucket;
+    return SharedMemoryBambooFilter(fd, base, bytes, true);
+}
+
+SharedMemoryBambooFilter SharedMemoryBambooFilter::open_writer(const std::string& name) {
+    return open(name, true);
+}
+
+SharedMemoryBambooFilter SharedMemoryBambooFilter::open_reader(const std::string& name) {
+    return open(name, false);
+}
+
+SharedMemoryBambooFilter SharedMemoryBambooFilter::open(const std::string& name, bool writer) {
+    const int fd = ::shm_open(name.c_str(), writer ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) throw system_error("Cannot open shared memory", name);
+    if (writer && ::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Shared filter " + name + " already has a writer.");
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < header_bytes()) {
+        ::close(fd);
+        throw std::runtime_error("Shared memory " + name + " is not a filter.");
+    }
+    const auto bytes = static_cast<std::size_t>(st.st_size);
+    void* base = ::mmap(nullptr, bytes, writer ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        const auto error = system_error("Cannot map shared memory", name);
+        ::close(fd);
+        throw error;
+    }
+
+    SharedMemoryBambooFilter filter(fd, base, bytes, writer); // Unmaps on any exception below
+    const Header& header = *filter.header_;
+    if (std::memcmp(header.magic, kShmMagic, sizeof(kShmMagic)) != 0 || header.layout_version != kShmLayoutVersion ||
+        header.index_layout > kCopiedLayout ||
+        bytes != header_bytes() + header.num_buckets * header.slots_per_bucket * sizeof(std::uint16_t)) {
+        throw std::runtime_error("Shared memory " + name + " is not a filter.");
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    filter.load_geometry();
+    if (writer && (filter.header_->sequence.load(std::memory_order_relaxed) & 1)) {
+        filter.end_write(); // The previous writer died mid-modification; readers may proceed again
+    }
+    return filter;
+}
+
+bool SharedMemoryBambooFilter::unlink(const std::string& name) {
+    return ::shm_unlink(name.c_str()) == 0;
+}
+
+SharedMemoryBambooFilter::SharedMemoryBambooFilter(int fd, void* base, std::size_t mapped_bytes, bool writer)
+  : fd_(fd),
+    base_(base),
+    mapped_bytes_(mapped_bytes),
+    writer_(writer),
+    header_(static_cast<Header*>(base)),
+    table_(reinterpret_cast<std::uint16_t*>(static_cast<char*>(base) + header_bytes())) {}
+
+SharedMemoryBambooFilter::SharedMemoryBambooFilter(SharedMemoryBambooFilter&& other) noexcept
+  : fd_(std::exchange(other.fd_, -1)),
+    base_(std::exchange(other.base_, nullptr)),
+    mapped_bytes_(std::exchange(other.mapped_bytes_, 0)),
+    writer_(std::exchange(other.writer_, false)),
+    header_(std::exchange(other.header_, nullptr)),
+    table_(std::exchange(other.table_, nullptr)),
+    num_buckets_(other.num_buckets_),
+    slots_(other.slots_),
+    alt_window_(other.alt_window_),
+    copied_layout_(other.copied_layout_) {}
+
+SharedMemoryBambooFilter& SharedMemoryBambooFilter::operator=(SharedMemoryBambooFilter&& other) noexcept {
+    if (this != &other) {
+        SharedMemoryBambooFilter moved(std::move(other));
+        std::swap(fd_, moved.fd_);
+        std::swap(base_, moved.base_);
+        std::swap(mapped_bytes_, moved.mapped_bytes_);
+        std::swap(writer_, moved.writer_);
+        std::swap(header_, moved.header_);
+        std::swap(table_, moved.table_);
+        std::swap(num_buckets_, moved.num_buckets_);
+        std::swap(slots_, moved.slots_);
+        std::swap(alt_window_, moved.alt_window_);
+        std::swap(copied_layout_, moved.copied_layout_);
+    }
+    return *this;
+}
+
+SharedMemoryBambooFilter::~SharedMemoryBambooFilter() {
+    if (base_) ::munmap(base_, mapped_bytes_);
+    if (fd_ >= 0) ::close(fd_); // Also releases the writer lock
+}
+
+//================================================================================
+// Private Helpers
+//================================================================================
+
+std::uint16_t SharedMemoryBambooFilter::fingerprint(std::uint64_t h) const {
+    const auto fp = static_cast<std::uint16_t>(h & ((1u << header_->fingerprint_bits) - 1));
+    return fp == 0 ? 1 : fp;
+}
+
+void SharedMemoryBambooFilter::load_geometry() {
+    num_buckets_ = header_->num_buckets;
+    slots_ = header_->slots_per_bucket;
+    alt_window_ = header_->alternate_window;
+    copied_layout_ = header_->index_layout == kCopiedLayout;
+}
+
+std::size_t SharedMemoryBambooFilter::primary(std::uint64_t h) const {
+    return copied_layout_ ? MyBambooFilter::primary_bucket(h, num_buckets_) : (h >> 16) & (num_buckets_ - 1);
+}
+
+std::size_t SharedMemoryBambooFilter::alternate(std::size_t bucket, std::uint16_t fp) const {
+    if (copied_layout_) return MyBambooFilter::alternate_bucket(bucket, fp, num_buckets_, alt_window_);
+    // XOR with a value derived from the fingerprint alone is its own inverse, so the
+    // alternate of the alternate is the original bucket.
+    return (bucket ^ static_cast<std::size_t>(MyBambooFilter::mix64(fp))) & (num_buckets_ - 1);
+}
+
+bool SharedMemoryBambooFilter::probe(std::uint64_t h) const {
+    const std::uint16_t fp = fingerprint(h);
+    const std::size_t i1 = primary(h);
+    const std::size_t i2 = alternate(i1, fp);
+    const std::uint16_t* b1 = table_ + i1 * slots_;
+    const std::uint16_t* b2 = table_ + i2 * slots_;
+    for (std::size_t s = 0; s < slots_; ++s) {
+        if (load_cell(b1 + s) == fp || load_cell(b2 + s) == fp) return true;
+    }
+    return false;
+}
+
+bool SharedMemoryBambooFilter::writer_gone() const {
+    // The writer holds an exclusive lock for as long as its handle is open, so a shared
+    // lock only succeeds when there is no writer.
+    if (::flock(fd_, LOCK_SH | LOCK_NB) != 0) return false;
+    ::flock(fd_, LOCK_UN);
+    return true;
+}
+
+void SharedMemoryBambooFilter::require_writer() const {
+    if (!writer_) throw std::logic_error("Shared filter is open read-only.");
+}
+
+void SharedMemoryBambooFilter::begin_write() {
+    header_->sequence.store(header_->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // Readers that see a table change also see the odd counter
+}
+
+void SharedMemoryBambooFilter::end_write() {
+    header_->sequence.fetch_add(1, std::memory_order_release);
+}
+
+//================================================================================
+// Public Methods
+//================================================================================
+
+bool SharedMemoryBambooFilter::insert(std::string_view key) {
+    return insert_hashed(MyBambooFilter::hash_with_policy(static_cast<MyBambooFilter::HashPolicy>(header_->hash_policy), key));
+}
+
+bool SharedMemoryBambooFilter::insert(std::uint64_t key) {
+    return insert_hashed(MyBambooFilter::mix64(key));
+}
+
+bool SharedMemoryBambooFilter::insert_hashed(std::uint64_t h) {
+    require_writer();
+    std::uint16_t fp = fingerprint(h);
+    const std::size_t i1 = primary(h);
+    const std::size_t i2 = alternate(i1, fp);
+
+    for (std::size_t b : {i1, i2}) {
+        for (std::size_t s = b * slots_; s < (b + 1) * slots_; ++s) {
+            if (table_[s] == 0) {
+                begin_write();
+                store_cell(table_ + s, fp);
+                header_->items.fetch_add(1, std::memory_order_relaxed);
+                end_write();
+                return true;
+            }
+        }
+    }
+
+    // A copied layout's alternate is not its own inverse, so a fingerprint cannot be moved on.
+    if (copied_layout_) return false;
+
+    // Both buckets full: plan a kick path without touching the table, so readers are not
+    // held off during the search and a failed attempt needs no undo.
+    static thread_local std::mt19937 rng(std::random_device{}());
+    std::vector<std::pair<std::size_t, std::uint16_t>> path; // (cell, fingerprint it will hold)
+    auto planned = [&](std::size_t cell) { // A cell's value once the path so far is applied
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            if (it->first == cell) return it->second;
+        }
+        return table_[cell];
+    };
+    std::size_t bucket = (rng() & 1) ? i1 : i2;
+    for (std::size_t kick = 0; kick < header_->max_cuckoo_kicks; ++kick) {
+        const std::size_t cell = bucket * slots_ + rng() % slots_;
+        const std::uint16_t victim = planned(cell);
+        path.emplace_back(cell, fp);
+        fp = victim; // The victim moves on to its other bucket
+        bucket = alternate(bucket, fp);
+        // Cells on the path were occupied and stay occupied, so the table alone tells which are free.
+        for (std::size_t s = bucket * slots_; s < (bucket + 1) * slots_; ++s) {
+            if (table_[s] != 0) continue;
+            path.emplace_back(s, fp);
+            begin_write();
+            for (const auto& step : path) store_cell(table_ + step.first, step.second);
+            header_->items.fetch_add(1, std::memory_order_relaxed);
+            end_write();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SharedMemoryBambooFilter::contains(std::string_view key) const {
+    return contains_hashed(MyBambooFilter::hash_with_policy(static_cast<MyBambooFilter::HashPolicy>(header_->hash_policy), key));
+}
+
+bool SharedMemoryBambooFilter::contains(std::uint64_t key) const {
+    return contains_hashed(MyBambooFilter::mix64(key));
+}
+
+bool SharedMemoryBambooFilter::contains_hashed(std::uint64_t h) const {
+    unsigned spins = 0;
+    for (;;) {
+        const std::uint64_t before = header_->sequence.load(std::memory_order_acquire);
+        if (before & 1) { // A modification is in progress
+            // A writer handle is its own writer, and checking would convert its exclusive lock.
+            if (++spins == kSpinsBeforeWriterCheck && !writer_) {
+                spins = 0;
+                if (header_->sequence.load(std::memory_order_acquire) == before && writer_gone()) {
+                    throw std::runtime_error("Shared filter writer died during a modification.");
+                }
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        const bool found = probe(h);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header_->sequence.load(std::memory_order_relaxed) == before) return found;
+    }
+}
+
+bool SharedMemoryBambooFilter::erase(std::string_view key) {
+    return erase_hashed(MyBambooFilter::hash_with_policy(static_cast<MyBambooFilter::HashPolicy>(header_->hash_policy), key));
+}
+
+bool SharedMemoryBambooFilter::erase(std::uint64_t key) {
+    return erase_hashed(MyBambooFilter::mix64(key));
+}
+
+bool SharedMemoryBambooFilter::erase_hashed(std::uint64_t h) {
+    require_writer();
+    const std::uint16_t fp = fingerprint(h);
+    const std::size_t i1 = primary(h);
+    const std::size_t i2 = alternate(i1, fp);
+    for (std::size_t b : {i1, i2}) {
+        for (std::size_t s = b * slots_; s < (b + 1) * slots_; ++s) {
+            if (table_[s] != fp) continue;
+            begin_write();
+            store_cell(table_ + s, 0);
+            header_->items.fetch_sub(1, std::memory_order_relaxed);
+            end_write();
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t SharedMemoryBambooFilter::size() const {
+    return static_cast<std::size_t>(header_->items.load(std::memory_order_relaxed));
+}
+
+std::size_t SharedMemoryBambooFilter::capacity_buckets() const { return num_buckets_; }
+
+float SharedMemoryBambooFilter::loadFactor() const {
+    return static_cast<float>(size()) / static_cast<float>(capacity_buckets() * slots_);
+}
+
+std::size_t SharedMemoryBambooFilter::memoryUsage() const { return mapped_bytes_; }
+
+bool SharedMemoryBambooFilter::is_writer() const { return writer_; }
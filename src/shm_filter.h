@@ -0,0 +1,179 @@
+#ifndef MY_BAMBOO_SHM_FILTER_H
+#define MY_BAMBOO_SHM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "bamboo_filter.h"
+
+/**
+ * @file shm_filter.h
+ * @brief Cuckoo filter stored in a POSIX shared-memory object, shared by one writer
+ * process and any number of reader processes.
+ *
+ * The whole filter (header and table) lives in one `shm_open` object that every
+ * process maps, so all local query processes share a single physical copy. The
+ * table is a flat array of fingerprints. A table from create() has a power-of-two
+ * bucket count, and the alternate bucket is `bucket ^ mix(fingerprint)`, so it can be
+ * computed from either bucket without the full hash. Unlike MyBambooFilter the table
+ * cannot grow: size it at creation.
+ *
+ * A table from create_from() instead copies a MyBambooFilter bucket for bucket and
+ * keeps that filter's bucket count and index functions, so it answers every query
+ * exactly as the source did. Its alternate bucket can only be computed from the
+ * primary bucket, so fingerprints cannot be kicked: later inserts succeed only while
+ * one of their two buckets has a free slot.
+ *
+ * Concurrency: the writer brackets each modification with a sequence counter (a
+ * seqlock). Readers never write shared memory; a probe that overlaps a modification
+ * sees an odd or changed counter and is retried. Only one writer may have the object
+ * open at a time, which is enforced with an advisory lock.
+ *
+ * Readers wait while the counter is odd. An insert that has to kick first plans the
+ * whole kick path without writing and only then applies it, so the counter stays odd
+ * for one store per kick rather than for the search; a failed insert writes nothing.
+ * If the writer process dies while the counter is odd, a waiting reader notices that
+ * the writer lock is free and throws instead of spinning forever; the next
+ * open_writer() makes the counter even again. An insert interrupted that way can have
+ * lost one fingerprint of its kick path.
+ */
+class SharedMemoryBambooFilter {
+public:
+    /** @brief Geometry of a new shared filter. */
+    struct Options {
+        std::size_t num_buckets = 1u << 20;     ///< Rounded up to a power of two
+        std::size_t slots_per_bucket = 4;
+        unsigned fingerprint_bits = 16;         ///< 1..16
+        MyBambooFilter::HashPolicy hash_policy = MyBambooFilter::HashPolicy::Fnv1a;
+        std::size_t max_cuckoo_kicks = 500;
+    };
+
+    /**
+     * @brief Creates a new, empty shared filter and opens it as the writer.
+     * @param name Shared-memory object name, e.g. "/bamboo-ref".
+     * @param options Geometry.
+     * @throws std::invalid_argument If the geometry is invalid.
+     * @throws std::runtime_error If the object exists already or cannot be created.
+     */
+    static SharedMemoryBambooFilter create(const std::string& name, const Options& options);
+
+    /**
+     * @brief Creates a shared filter that copies `source` bucket for bucket.
+     * The copy keeps the source's bucket count, fingerprints and bucket index functions,
+     * so every key the source reports as present is present in the copy, including keys
+     * the source skipped at insert because a look-alike fingerprint was stored. Buckets
+     * get as many slots as the fullest source bucket, stash included.
+     * @param name Shared-memory object name.
+     * @param source Filter to copy.
+     * @return The writer handle.
+     * @throws std::runtime_error If the object exists already or cannot be created.
+     */
+    static SharedMemoryBambooFilter create_from(const std::string& name, const MyBambooFilter& source);
+
+    /**
+     * @brief Opens an existing shared filter for writing.
+     * Recovers a counter left odd by a writer that died during a modification.
+     * @throws std::runtime_error If it does not exist, is not a filter, or another writer has it open.
+     */
+    static SharedMemoryBambooFilter open_writer(const std::string& name);
+
+    /**
+     * @brief Opens an existing shared filter read-only.
+     * @throws std::runtime_error If it does not exist or is not a filter.
+     */
+    static SharedMemoryBambooFilter open_reader(const std::string& name);
+
+    /**
+     * @brief Removes the shared-memory object name; mappings that are still open stay valid.
+     * @return True if the name existed.
+     */
+    static bool unlink(const std::string& name);
+
+    SharedMemoryBambooFilter(const SharedMemoryBambooFilter&) = delete;
+    SharedMemoryBambooFilter& operator=(const SharedMemoryBambooFilter&) = delete;
+    SharedMemoryBambooFilter(SharedMemoryBambooFilter&& other) noexcept;
+    SharedMemoryBambooFilter& operator=(SharedMemoryBambooFilter&& other) noexcept;
+    ~SharedMemoryBambooFilter();
+
+    /**
+     * @brief Inserts a key (writer only).
+     * @return False if the table is full; the table is then left unchanged.
+     * @throws std::logic_error If this handle is a reader.
+     */
+    bool insert(std::string_view key);
+    /** @brief Inserts an integer key, hashed like MyBambooFilter::insert(std::uint64_t). */
+    bool insert(std::uint64_t key);
+    /** @brief Inserts a pre-hashed item. */
+    bool insert_hashed(std::uint64_t h);
+
+    /**
+     * @brief Checks whether a key is possibly present. Lock-free; callable from any process.
+     * @throws std::runtime_error If the writer died during a modification (reader handles only).
+     */
+    bool contains(std::string_view key) const;
+    /** @brief Checks whether an integer key is possibly present. */
+    bool contains(std::uint64_t key) const;
+    /** @brief Checks whether a pre-hashed item is possibly present. */
+    bool contains_hashed(std::uint64_t h) const;
+
+    /**
+     * @brief Removes one copy of a key's fingerprint (writer only). Only erase keys that were inserted.
+     * @return True if a matching fingerprint was removed.
+     */
+    bool erase(std::string_view key);
+    /** @brief Removes an integer key (writer only). */
+    bool erase(std::uint64_t key);
+    /** @brief Removes a pre-hashed item (writer only). */
+    bool erase_hashed(std::uint64_t h);
+
+    /** @brief Returns the number of stored items. */
+    std::size_t size() const;
+    /** @brief Returns the number of buckets. */
+    std::size_t capacity_buckets() const;
+    /** @brief Returns stored items divided by total slots. */
+    float loadFactor() const;
+    /** @brief Returns the size of the shared mapping in bytes. */
+    std::size_t memoryUsage() const;
+    /** @brief Returns true if this handle may modify the filter. */
+    bool is_writer() const;
+
+private:
+    struct Header;
+
+    /** @brief Size of the header rounded up to a cache line; the table starts at this offset. */
+    static std::size_t header_bytes();
+
+    SharedMemoryBambooFilter(int fd, void* base, std::size_t mapped_bytes, bool writer);
+    static SharedMemoryBambooFilter open(const std::string& name, bool writer);
+
+    /** @brief Creates and maps a zero-filled object; the caller fills in the header. */
+    static SharedMemoryBambooFilter create_object(const std::string& name, std::size_t num_buckets,
+                                                  std::size_t slots_per_bucket);
+    /** @brief Fills in the geometry members from the header. */
+    void load_geometry();
+
+    std::size_t primary(std::uint64_t h) const;
+    /** @brief Returns the other bucket of an item in `bucket`; for a copied layout, `bucket` must be its primary. */
+    std::size_t alternate(std::size_t bucket, std::uint16_t fp) const;
+    std::uint16_t fingerprint(std::uint64_t h) const;
+    bool probe(std::uint64_t h) const;
+    /** @brief Returns true if no process holds the writer lock. Reader handles only. */
+    bool writer_gone() const;
+    void require_writer() const;
+    void begin_write();
+    void end_write();
+
+    int fd_ = -1;
+    void* base_ = nullptr;
+    std::size_t mapped_bytes_ = 0;
+    bool writer_ = false;
+    Header* header_ = nullptr;
+    std::uint16_t* table_ = nullptr;
+    std::size_t num_buckets_ = 0;
+    std::size_t slots_ = 0;
+    std::size_t alt_window_ = 0;   ///< Copied layout only; 0 if the alternate may be anywhere
+    bool copied_layout_ = false;   ///< Built by create_from() with MyBambooFilter's index functions
+};
+
+#endif // MY_BAMBOO_SHM_FILTER_H
@@ -0,0 +1,115 @@
+/**
+ * @file clone_test.cpp
+ * @brief Copy-on-write isolation, move and segment sizing tests for MyBambooFilter::clone().
+ */
+#include <cstdint>
+#include <utility>
+#include "bamboo_filter.h"
+#include "test_util.h"
+
+namespace {
+
+MyBambooFilter::Config config_with(std::size_t buckets) {
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = buckets;
+    return config;
+}
+
+/** @brief True if `filter` contains every key in [first, last). */
+bool contains_all(const MyBambooFilter& filter, std::uint64_t first, std::uint64_t last) {
+    for (std::uint64_t i = first; i < last; ++i) {
+        if (!filter.contains(i)) return false;
+    }
+    return true;
+}
+
+void test_write_to_clone_leaves_original() {
+    MyBambooFilter original(config_with(10000)); // Spans several segments, the last one partial
+    for (std::uint64_t i = 0; i < 5000; ++i) original.insert(i);
+    MyBambooFilter copy = original.clone();
+
+    for (std::uint64_t i = 5000; i < 6000; ++i) copy.insert(i);
+    for (std::uint64_t i = 0; i < 500; ++i) CHECK(copy.erase(i));
+
+    CHECK(original.size() == 5000);
+    CHECK(contains_all(original, 0, 5000));
+    CHECK(copy.size() == 5500);
+    CHECK(contains_all(copy, 500, 6000));
+}
+
+void test_write_to_original_leaves_clone() {
+    MyBambooFilter original(config_with(10000));
+    for (std::uint64_t i = 0; i < 5000; ++i) original.insert(i);
+    MyBambooFilter copy = original.clone();
+
+    for (std::uint64_t i = 5000; i < 6000; ++i) original.insert(i);
+    for (std::uint64_t i = 0; i < 500; ++i) CHECK(original.erase(i));
+
+    CHECK(copy.size() == 5000);
+    CHECK(contains_all(copy, 0, 5000));
+    CHECK(original.size() == 5500);
+    CHECK(contains_all(original, 500, 6000));
+}
+
+void test_rebuild_leaves_clone() {
+    MyBambooFilter original(config_with(64));
+    for (std::uint64_t i = 0; i < 100; ++i) original.insert(i);
+    MyBambooFilter copy = original.clone();
+    const std::size_t buckets = copy.capacity_buckets();
+
+    for (std::uint64_t i = 100; i < 20000; ++i) original.insert(i); // Grows the table several times
+    CHECK(original.capacity_buckets() > buckets);
+    CHECK(contains_all(original, 0, 20000));
+    CHECK(copy.capacity_buckets() == buckets);
+    CHECK(copy.size() == 100);
+    CHECK(contains_all(copy, 0, 100));
+}
+
+void test_swap() {
+    MyBambooFilter a(config_with(256));
+    MyBambooFilter b(config_with(8192));
+    for (std::uint64_t i = 0; i < 100; ++i) a.insert(i);
+    for (std::uint64_t i = 1000; i < 1500; ++i) b.insert(i);
+    swap(a, b);
+    CHECK(a.capacity_buckets() == 8192 && a.size() == 500 && contains_all(a, 1000, 1500));
+    CHECK(b.capacity_buckets() == 256 && b.size() == 100 && contains_all(b, 0, 100));
+}
+
+void test_small_filter_memory() {
+    // The last segment is sized to the table, so a small filter stays small.
+    const MyBambooFilter small(config_with(16));
+    const MyBambooFilter full(config_with(4096));
+    CHECK(small.memoryUsage() * 64 < full.memoryUsage());
+}
+
+void test_moved_from_is_empty() {
+    MyBambooFilter a(config_with(256));
+    for (std::uint64_t i = 0; i < 100; ++i) a.insert(i);
+    MyBambooFilter b(std::move(a));
+    CHECK(b.size() == 100 && contains_all(b, 0, 100));
+    CHECK(a.size() == 0 && a.capacity_buckets() == 0 && a.loadFactor() == 0.0f);
+    CHECK(!a.contains(std::uint64_t{0}) && !a.erase(std::uint64_t{0}));
+    const std::uint64_t hashes[] = {1, 2, 3};
+    bool results[3] = {true, true, true};
+    a.contains_hashed_batch(hashes, 3, results);
+    CHECK(!results[0] && !results[1] && !results[2]);
+
+    // A moved-from filter can be assigned to and used again.
+    a = std::move(b);
+    CHECK(a.size() == 100 && contains_all(a, 0, 100) && b.size() == 0);
+    b = MyBambooFilter(config_with(64));
+    b.insert(std::uint64_t{7});
+    CHECK(b.contains(std::uint64_t{7}));
+}
+
+} // namespace
+
+int main() {
+    test_write_to_clone_leaves_original();
+    test_write_to_original_leaves_clone();
+    test_rebuild_leaves_clone();
+    test_swap();
+    test_small_filter_memory();
+    test_moved_from_is_empty();
+    return test::exit_code();
+}
@@ -0,0 +1,93 @@
+/**
+ * @file column_test.cpp
+ * @brief Tests for MyBambooFilter::insert_column() and contains_column() on Arrow-layout string columns.
+ */
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bamboo_filter.h"
+#include "test_util.h"
+
+namespace {
+
+/** @brief An Arrow String column built from plain strings. */
+struct Column {
+    explicit Column(const std::vector<std::string>& rows) {
+        offsets.push_back(0);
+        for (const auto& row : rows) {
+            data += row;
+            offsets.push_back(static_cast<std::int32_t>(data.size()));
+        }
+    }
+    std::vector<std::int32_t> offsets;
+    std::string data;
+};
+
+std::vector<std::string> numbered_rows(std::size_t n) {
+    std::vector<std::string> rows;
+    for (std::size_t i = 0; i < n; ++i) rows.push_back("row-" + std::to_string(i));
+    return rows;
+}
+
+void test_insert_counts_items_added() {
+    std::vector<std::string> rows = numbered_rows(600);
+    rows.push_back("row-1"); // Repeated values add nothing
+    rows.push_back("row-2");
+    const Column column(rows);
+    MyBambooFilter filter{MyBambooFilter::Config{}};
+    CHECK(filter.insert_column(column.offsets.data(), column.data.data(), rows.size()) == 600);
+    CHECK(filter.size() == 600);
+    CHECK(filter.insert_column(column.offsets.data(), column.data.data(), rows.size()) == 0);
+    for (const auto& row : rows) CHECK(filter.contains(row));
+}
+
+void test_bad_offset_leaves_filter_unchanged() {
+    const std::vector<std::string> rows = numbered_rows(600);
+    Column column(rows);
+    column.offsets[550] = column.offsets[549] - 1; // Past the first hashing block
+    MyBambooFilter filter{MyBambooFilter::Config{}};
+    CHECK_THROWS(filter.insert_column(column.offsets.data(), column.data.data(), rows.size()), std::invalid_argument);
+    CHECK(filter.size() == 0);
+
+    std::vector<std::uint8_t> bitmap((rows.size() + 7) / 8);
+    CHECK_THROWS(filter.contains_column(column.offsets.data(), column.data.data(), rows.size(), bitmap.data()),
+                 std::invalid_argument);
+    column.offsets[550] = column.offsets[549];
+    column.offsets[0] = -1;
+    CHECK_THROWS(filter.insert_column(column.offsets.data(), column.data.data(), rows.size()), std::invalid_argument);
+    CHECK(filter.size() == 0);
+}
+
+void test_unaligned_validity_offset() {
+    // A slice starting at row 3 of its parent: its validity bits start at bit 3 of the bitmap.
+    const std::vector<std::string> rows = numbered_rows(20);
+    const Column column(rows);
+    const std::size_t slice_offset = 3;
+    std::vector<std::uint8_t> validity((slice_offset + rows.size() + 7) / 8, 0);
+    for (std::size_t row = 0; row < rows.size(); ++row) {
+        if (row % 3 != 0) validity[(slice_offset + row) / 8] |= static_cast<std::uint8_t>(1u << ((slice_offset + row) % 8));
+    }
+
+    MyBambooFilter filter{MyBambooFilter::Config{}};
+    const std::size_t added =
+        filter.insert_column(column.offsets.data(), column.data.data(), rows.size(), validity.data(), slice_offset);
+    CHECK(added == 13);
+    for (std::size_t row = 0; row < rows.size(); ++row) CHECK(filter.contains(rows[row]) == (row % 3 != 0));
+
+    std::vector<std::uint8_t> bitmap((rows.size() + 7) / 8, 0xff);
+    filter.contains_column(column.offsets.data(), column.data.data(), rows.size(), bitmap.data(), validity.data(),
+                           slice_offset);
+    for (std::size_t row = 0; row < rows.size(); ++row) {
+        CHECK(((bitmap[row / 8] >> (row % 8)) & 1) == (row % 3 != 0 ? 1 : 0));
+    }
+}
+
+} // namespace
+
+int main() {
+    test_insert_counts_items_added();
+    test_bad_offset_leaves_filter_unchanged();
+    test_unaligned_validity_offset();
+    return test::exit_code();
+}
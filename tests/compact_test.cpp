@@ -0,0 +1,50 @@
+/**
+ * @file compact_test.cpp
+ * @brief Tests for incremental compaction with MyBambooFilter::compact_step().
+ */
+#include <cstdint>
+#include <limits>
+#include "bamboo_filter.h"
+#include "test_util.h"
+
+namespace {
+
+MyBambooFilter filled_filter() {
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = 1000;
+    MyBambooFilter filter(config);
+    for (std::uint64_t i = 0; i < 3000; ++i) filter.insert(i);
+    return filter;
+}
+
+bool contains_all(const MyBambooFilter& filter, std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+        if (!filter.contains(i)) return false;
+    }
+    return true;
+}
+
+void test_unbounded_step_finishes_a_started_pass() {
+    // SIZE_MAX means "finish the pass"; after a partial step, cursor + max_buckets must not wrap.
+    MyBambooFilter filter = filled_filter();
+    CHECK(!filter.compact_step(10));
+    CHECK(filter.compact_step(std::numeric_limits<std::size_t>::max()));
+    CHECK(filter.compact_step(std::numeric_limits<std::size_t>::max())); // A fresh pass from bucket 0
+    CHECK(contains_all(filter, 3000));
+}
+
+void test_small_steps_cover_the_table() {
+    MyBambooFilter filter = filled_filter();
+    std::size_t steps = 1;
+    while (!filter.compact_step(64)) ++steps;
+    CHECK(steps == (filter.capacity_buckets() + 63) / 64);
+    CHECK(contains_all(filter, 3000));
+}
+
+} // namespace
+
+int main() {
+    test_unbounded_step_finishes_a_started_pass();
+    test_small_steps_cover_the_table();
+    return test::exit_code();
+}
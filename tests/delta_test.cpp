@@ -0,0 +1,136 @@
+/**
+ * @file delta_test.cpp
+ * @brief Round-trip, golden-encoding and malformed-input tests for MyBambooFilter::Delta.
+ */
+#include <stdexcept>
+#include <string>
+#include "bamboo_filter.h"
+#include "test_util.h"
+
+namespace {
+
+MyBambooFilter::Config small_config() {
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = 1024;
+    return config;
+}
+
+/** @brief True if both filters answer every key in [0, n) identically and have the same size. */
+bool same_answers(const MyBambooFilter& a, const MyBambooFilter& b, std::uint64_t n) {
+    if (a.size() != b.size() || a.capacity_buckets() != b.capacity_buckets()) return false;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        if (a.contains(i) != b.contains(i)) return false;
+    }
+    return true;
+}
+
+void test_incremental_round_trip() {
+    MyBambooFilter primary(small_config());
+    for (std::uint64_t i = 0; i < 2000; ++i) primary.insert(i);
+    MyBambooFilter replica = primary.clone();
+
+    const std::uint64_t snapshot = primary.take_snapshot();
+    for (std::uint64_t i = 2000; i < 2300; ++i) primary.insert(i);
+    for (std::uint64_t i = 0; i < 100; ++i) primary.erase(i);
+    const MyBambooFilter::Delta delta = primary.diff_since(snapshot);
+    CHECK(!delta.full);
+    CHECK(!delta.patches.empty());
+    CHECK(delta.patches.size() < primary.capacity_buckets());
+
+    replica.apply_delta(MyBambooFilter::Delta::deserialize(delta.serialize()));
+    CHECK(same_answers(primary, replica, 4000));
+    CHECK(MyBambooFilter::diff(replica, primary).patches.empty());
+}
+
+void test_full_round_trip() {
+    MyBambooFilter primary(small_config());
+    for (std::uint64_t i = 0; i < 50000; ++i) primary.insert(i); // Forces rebuilds
+    MyBambooFilter replica(small_config());
+    const MyBambooFilter::Delta delta = MyBambooFilter::diff(replica, primary);
+    CHECK(delta.full);
+    replica.apply_delta(MyBambooFilter::Delta::deserialize(delta.serialize()));
+    CHECK(same_answers(primary, replica, 60000));
+}
+
+void test_golden_encoding() {
+    MyBambooFilter::Delta delta;
+    delta.num_buckets = 1024;
+    delta.slots_per_bucket = 4;
+    delta.fingerprint_bits = 16;
+    delta.items = 3;
+    delta.patches = {{5, {1, 2}}, {200, {0x0102030405060708ULL}}};
+    const std::string expected = std::string("BFD2") +
+        std::string("\x00\x80\x08\x04\x10\x00\x00\x03\x00\x02", 10) + // flags, geometry, counts, 2 patches
+        std::string("\x05\x02", 2) +                                  // bucket 5, 2 slots
+        std::string("\x01\x00\x00\x00\x00\x00\x00\x00\x02\x00\x00\x00\x00\x00\x00\x00", 16) +
+        std::string("\xc2\x01\x01", 3) +                              // bucket 6 + 194, 1 slot
+        std::string("\x08\x07\x06\x05\x04\x03\x02\x01", 8);
+    CHECK(delta.serialize() == expected);
+
+    const MyBambooFilter::Delta decoded = MyBambooFilter::Delta::deserialize(expected);
+    CHECK(decoded.num_buckets == 1024 && decoded.items == 3 && decoded.patches.size() == 2);
+    CHECK(decoded.patches[1].bucket == 200 && decoded.patches[1].hashes[0] == 0x0102030405060708ULL);
+    CHECK(decoded.serialize() == expected);
+}
+
+void test_malformed_input() {
+    MyBambooFilter primary(small_config());
+    for (std::uint64_t i = 0; i < 500; ++i) primary.insert(i);
+    const std::string good = primary.full_delta().serialize();
+
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize(""), std::runtime_error);
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize("BFD1" + good.substr(4)), std::runtime_error); // Old magic
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize("XXXX" + good.substr(4)), std::runtime_error);
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize(good + '\0'), std::runtime_error);
+    for (std::size_t len = 0; len < good.size(); len += 1 + len / 8) {
+        CHECK_THROWS(MyBambooFilter::Delta::deserialize(good.substr(0, len)), std::runtime_error);
+    }
+
+    const std::string header = std::string("BFD2") + std::string("\x00\x80\x08\x04\x10\x00\x00\x03\x00", 9);
+    // An unterminated varint.
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize(std::string("BFD2\x00", 5) + std::string(11, '\xff')), std::runtime_error);
+    // More patches than the input can hold.
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize(header + std::string("\xff\x07", 2)), std::runtime_error);
+    // A patch past the last bucket, and a gap that would wrap around.
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize(header + std::string("\x01\x80\x08\x00", 4)), std::runtime_error);
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize(
+                     header + std::string("\x01\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01\x00", 12)),
+                 std::runtime_error);
+    // A slot count larger than the remaining bytes.
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize(header + std::string("\x01\x00\x05", 3) + std::string(16, '\0')),
+                 std::runtime_error);
+    // An unknown hash policy and an impossible fingerprint width.
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize(std::string("BFD2\x00\x80\x08\x04\x10\x07\x00\x00\x00\x00", 14)),
+                 std::runtime_error);
+    CHECK_THROWS(MyBambooFilter::Delta::deserialize(std::string("BFD2\x00\x80\x08\x04\x11\x00\x00\x00\x00\x00", 14)),
+                 std::runtime_error);
+}
+
+void test_geometry_mismatch() {
+    MyBambooFilter primary(small_config());
+    MyBambooFilter::Config other = small_config();
+    other.initial_num_buckets = 2048;
+    MyBambooFilter replica(other);
+    const std::uint64_t snapshot = primary.take_snapshot();
+    primary.insert(std::uint64_t{1});
+    CHECK_THROWS(replica.apply_delta(primary.diff_since(snapshot)), std::invalid_argument);
+
+    other = small_config();
+    other.slots_per_bucket = 8;
+    CHECK_THROWS(MyBambooFilter::diff(MyBambooFilter(other), primary), std::invalid_argument);
+
+    other = small_config();
+    other.hash_policy = MyBambooFilter::HashPolicy::WordMix;
+    CHECK_THROWS(MyBambooFilter::diff(MyBambooFilter(other), primary), std::invalid_argument);
+}
+
+} // namespace
+
+int main() {
+    test_incremental_round_trip();
+    test_full_round_trip();
+    test_golden_encoding();
+    test_malformed_input();
+    test_geometry_mismatch();
+    return test::exit_code();
+}
@@ -0,0 +1,105 @@
+/**
+ * @file front_cached_test.cpp
+ * @brief Checks that FrontCachedFilter answers exactly like its backing filter while
+ * items are inserted (with kicks and rebuilds) and erased, and that batches admit a
+ * hash only once.
+ */
+#include <cstdint>
+#include <vector>
+#include "front_cached_filter.h"
+#include "test_util.h"
+
+namespace {
+
+FrontCachedFilter::Options eager_front() {
+    FrontCachedFilter::Options options;
+    options.front_bytes = 1u << 14;
+    options.admission_threshold = 1; // Admit on the first confirmed hit
+    return options;
+}
+
+/** @brief Collects `count` hashes that were never inserted but that the backing filter reports. */
+std::vector<std::uint64_t> false_positives(const FrontCachedFilter& filter, std::uint64_t first, std::size_t count) {
+    std::vector<std::uint64_t> result;
+    for (std::uint64_t i = first; result.size() < count; ++i) {
+        const std::uint64_t h = MyBambooFilter::mix64(i);
+        if (filter.backing().contains_hashed(h)) result.push_back(h);
+    }
+    return result;
+}
+
+/** @brief Number of hashes the front answers differently from the backing filter. */
+std::size_t mismatches(FrontCachedFilter& filter, const std::vector<std::uint64_t>& hashes) {
+    std::size_t differing = 0;
+    for (std::uint64_t h : hashes) differing += filter.contains_hashed(h) != filter.backing().contains_hashed(h);
+    return differing;
+}
+
+void test_exact_through_kicks() {
+    // A high threshold keeps the table from rebuilding, so inserts near full load kick. With a
+    // bucket count that is not a power of two the alternate bucket is not its own inverse, so a
+    // kicked item can leave the bucket pair that a cached false positive relied on.
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = 1000;
+    config.fingerprint_bits = 8;
+    config.load_factor_threshold = 0.97f;
+    FrontCachedFilter::Options options = eager_front();
+    options.front_bytes = 1u << 16; // Room for many cached false positives per fingerprint
+    FrontCachedFilter filter(config, options);
+    std::uint64_t next = 0;
+    for (; next < 3000; ++next) filter.insert_hashed(MyBambooFilter::mix64(next));
+
+    std::size_t differing = 0;
+    for (std::uint64_t round = 0; round < 8; ++round) {
+        const std::vector<std::uint64_t> hot = false_positives(filter, 1000000 + round * 1000000, 4000);
+        for (std::uint64_t h : hot) filter.contains_hashed(h); // Cache them
+        for (std::uint64_t end = next + 100; next < end; ++next) filter.insert_hashed(MyBambooFilter::mix64(next));
+        differing += mismatches(filter, hot);
+    }
+    CHECK(filter.backing().relocations() > 0);
+    CHECK(filter.backing().expansion_history().empty());
+    CHECK(filter.stats().flushes > 0);
+    CHECK(differing == 0);
+}
+
+void test_exact_through_erase_and_rebuild() {
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = 1024;
+    config.fingerprint_bits = 8;
+    FrontCachedFilter filter(config, eager_front());
+    for (std::uint64_t i = 0; i < 3000; ++i) filter.insert_hashed(MyBambooFilter::mix64(i));
+
+    std::vector<std::uint64_t> hot = false_positives(filter, 1000000, 200);
+    for (std::uint64_t h : hot) filter.contains_hashed(h);
+    for (std::uint64_t i = 0; i < 3000; i += 2) filter.erase_hashed(MyBambooFilter::mix64(i));
+    CHECK(mismatches(filter, hot) == 0);
+
+    hot = false_positives(filter, 2000000, 200);
+    for (std::uint64_t h : hot) filter.contains_hashed(h);
+    for (std::uint64_t i = 10000; i < 20000; ++i) filter.insert_hashed(MyBambooFilter::mix64(i)); // Rebuilds
+    CHECK(!filter.backing().expansion_history().empty());
+    CHECK(mismatches(filter, hot) == 0);
+}
+
+void test_batch_admits_once() {
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = 1024;
+    FrontCachedFilter filter(config, eager_front());
+    const std::uint64_t h = MyBambooFilter::mix64(7);
+    filter.insert_hashed(h);
+
+    const std::vector<std::uint64_t> batch(8, h); // One hash repeated within a block
+    bool results[8];
+    filter.contains_hashed_batch(batch.data(), batch.size(), results);
+    for (bool found : results) CHECK(found);
+    CHECK(filter.stats().admissions == 1);
+}
+
+} // namespace
+
+int main() {
+    test_exact_through_kicks();
+    test_exact_through_erase_and_rebuild();
+    test_batch_admits_once();
+    return test::exit_code();
+}
@@ -0,0 +1,279 @@
+/**
+ * @file inflate_test.cpp
+ * @brief Golden-vector and error tests for the in-tree gzip decompressor.
+ *
+ * The vectors were produced with zlib (gzip wrapper, level 9; the stored vector at
+ * level 0 and the fixed one with Z_FIXED) and each exercises one DEFLATE block type.
+ */
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "inflate.h"
+#include "test_util.h"
+
+namespace {
+
+// "stored block\n", one stored block.
+const unsigned char kStored[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x01, 0x0d, 0x00, 0xf2, 0xff, 0x73,
+    0x74, 0x6f, 0x72, 0x65, 0x64, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x0a, 0x6d, 0x75, 0x88, 0xc5,
+    0x0d, 0x00, 0x00, 0x00,
+};
+
+// "fixed huffman fixed huffman fixed huffman\n", one fixed-Huffman block.
+const unsigned char kFixed[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x4b, 0xcb, 0xac, 0x48, 0x4d, 0x51,
+    0xc8, 0x28, 0x4d, 0x4b, 0xcb, 0x4d, 0xcc, 0x53, 0x48, 0xc3, 0xcd, 0xe3, 0x02, 0x00, 0xf0, 0x53,
+    0x17, 0x67, 0x2a, 0x00, 0x00, 0x00,
+};
+
+// dynamic_text(), one dynamic-Huffman block.
+const unsigned char kDynamic[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x6d, 0x94, 0xbb, 0x0d, 0xc3, 0x30,
+    0x0c, 0x44, 0xfb, 0x4c, 0x91, 0x11, 0xac, 0x0f, 0xf5, 0x29, 0x03, 0x17, 0x5e, 0x40, 0x7d, 0x10,
+    0x20, 0x59, 0xc0, 0xfb, 0x17, 0x81, 0xa0, 0xd3, 0x8f, 0xa4, 0x3a, 0x3d, 0x02, 0x47, 0xf9, 0xce,
+    0xe4, 0xfd, 0xfb, 0x7c, 0xdf, 0xc7, 0xf3, 0x75, 0x5e, 0xa5, 0x5c, 0xe7, 0xeb, 0x71, 0xd7, 0xbb,
+    0x19, 0xf7, 0xb3, 0x01, 0x3b, 0xc0, 0x75, 0x35, 0xe2, 0x06, 0x29, 0xa5, 0x34, 0xe4, 0x07, 0xaa,
+    0xa7, 0x31, 0x9a, 0x4a, 0xf5, 0x34, 0x18, 0x16, 0xb5, 0x7a, 0x1a, 0x8d, 0xab, 0x62, 0x19, 0xaa,
+    0x69, 0x53, 0x9d, 0xca, 0x79, 0x57, 0x9e, 0xea, 0xe6, 0x60, 0xf2, 0xb3, 0x85, 0x31, 0xbc, 0xc7,
+    0xec, 0x63, 0xac, 0x68, 0x34, 0x9b, 0x19, 0xc7, 0x1d, 0x9a, 0x1f, 0xdb, 0xb5, 0x69, 0xd1, 0x06,
+    0x0a, 0xab, 0x24, 0x58, 0xdc, 0xde, 0x0d, 0x98, 0xf6, 0x27, 0x83, 0x66, 0xf6, 0x5a, 0x64, 0x71,
+    0xf0, 0x87, 0x82, 0x1b, 0xe1, 0x08, 0x0a, 0x56, 0x1a, 0x82, 0x8a, 0x53, 0xfc, 0x40, 0xc9, 0x6b,
+    0x76, 0xa0, 0x46, 0xd2, 0xfb, 0xd9, 0x2d, 0x30, 0xab, 0xec, 0x12, 0x2c, 0xc8, 0x9a, 0x29, 0xd0,
+    0x16, 0x27, 0x7e, 0xb1, 0x3d, 0x48, 0x40, 0x16, 0x21, 0x28, 0x0f, 0x0f, 0xd8, 0xf1, 0x87, 0x82,
+    0x7b, 0xe1, 0x08, 0x0a, 0x24, 0x0d, 0x41, 0x25, 0x28, 0x7e, 0xa0, 0x14, 0x35, 0x3b, 0x50, 0x4b,
+    0xca, 0xcf, 0x38, 0xba, 0x65, 0x66, 0x95, 0x5f, 0xa2, 0x05, 0x59, 0x43, 0x05, 0xda, 0xe2, 0x04,
+    0xdb, 0x83, 0x04, 0x64, 0x11, 0x82, 0xf2, 0xf0, 0x80, 0xf9, 0x50, 0x76, 0x65, 0x31, 0x96, 0x5d,
+    0x5d, 0x0e, 0x66, 0xef, 0xa0, 0x8c, 0x26, 0xba, 0x90, 0x36, 0x9b, 0xe8, 0x44, 0xea, 0x70, 0xa2,
+    0x1b, 0x59, 0x66, 0x15, 0x39, 0xbe, 0xa3, 0xc8, 0x8b, 0x25, 0x45, 0x24, 0xb7, 0x14, 0x05, 0x6d,
+    0x4d, 0x45, 0x6d, 0x4f, 0x51, 0x52, 0x17, 0x15, 0x65, 0xb1, 0xa9, 0xfe, 0xa1, 0xab, 0x2f, 0xd8,
+    0x46, 0x05, 0x00, 0x00,
+};
+
+// repeated_text(), dynamic-Huffman blocks with back-references 3000 bytes apart.
+const unsigned char kRepeats[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0x96, 0xd1, 0x91, 0x5c, 0x31,
+    0x08, 0x04, 0x63, 0xa3, 0xf4, 0x41, 0x02, 0xe4, 0x1f, 0x8b, 0x45, 0x8f, 0xde, 0xda, 0x39, 0xb8,
+    0x6b, 0xcf, 0xbe, 0xbd, 0x5d, 0x3d, 0x09, 0x06, 0x18, 0x75, 0xf7, 0x99, 0x99, 0x9e, 0xba, 0xbf,
+    0xab, 0xce, 0xdc, 0x57, 0x77, 0xf3, 0xd1, 0xe9, 0xfb, 0xc1, 0xbe, 0xef, 0x73, 0x6a, 0xbf, 0xbb,
+    0x6f, 0xa6, 0xfb, 0xbe, 0x9f, 0x5d, 0x72, 0x78, 0xf0, 0x3e, 0x79, 0xf6, 0x89, 0xae, 0xfb, 0x73,
+    0xdf, 0x0d, 0xdf, 0xcf, 0xa9, 0xfb, 0x3a, 0x75, 0xf7, 0xb8, 0xdf, 0xef, 0x87, 0xfc, 0xe3, 0x8f,
+    0xbb, 0xed, 0x5d, 0x79, 0x97, 0xef, 0xea, 0xdd, 0xbb, 0xf7, 0x9c, 0xfb, 0xd0, 0x9e, 0xce, 0xfa,
+    0xd9, 0x9d, 0xcf, 0x6e, 0xb0, 0x67, 0xec, 0x63, 0xbb, 0xa4, 0x37, 0x52, 0x36, 0x6f, 0x82, 0xb9,
+    0xbb, 0xf7, 0x9e, 0xb3, 0x11, 0xef, 0xfb, 0x4d, 0x20, 0xc1, 0xec, 0x82, 0xbb, 0x75, 0xed, 0x51,
+    0xf7, 0xa3, 0x5d, 0xca, 0x67, 0x77, 0xf3, 0xfb, 0x5c, 0xed, 0x16, 0xb5, 0xb1, 0x0c, 0x91, 0x73,
+    0xe0, 0xa6, 0xb5, 0x19, 0xf5, 0x46, 0xba, 0x2b, 0x37, 0x88, 0xd5, 0x64, 0x48, 0x2b, 0x91, 0x46,
+    0x92, 0xbb, 0xfc, 0x86, 0x3b, 0xec, 0x8b, 0x6e, 0xe7, 0x7c, 0x29, 0x9f, 0x79, 0xa9, 0x17, 0xab,
+    0xe7, 0x20, 0x54, 0x11, 0xc8, 0xa6, 0x79, 0xb7, 0x3d, 0xf3, 0x6d, 0x7a, 0x55, 0x20, 0x1d, 0xd4,
+    0x6b, 0xf4, 0xda, 0x75, 0xbb, 0xf1, 0xe6, 0x4f, 0x26, 0xb5, 0x1f, 0x9c, 0x8d, 0xff, 0xf0, 0x24,
+    0x9a, 0x53, 0x88, 0x4d, 0x9b, 0x40, 0xae, 0x9a, 0x37, 0x08, 0x32, 0xa0, 0x58, 0x95, 0x52, 0x1e,
+    0xc2, 0xaf, 0x95, 0x3a, 0x45, 0xdb, 0xcd, 0x08, 0x65, 0x36, 0xde, 0xe1, 0x55, 0x6c, 0x43, 0x2d,
+    0x37, 0xe4, 0x64, 0x1f, 0x6d, 0x28, 0xf2, 0xa1, 0xac, 0x27, 0x4f, 0xed, 0xf3, 0x1b, 0x48, 0xa7,
+    0x4c, 0x43, 0x0d, 0x10, 0x9f, 0x83, 0x09, 0xaf, 0x92, 0xd8, 0x6e, 0xb7, 0x87, 0xbd, 0x1a, 0x1c,
+    0xca, 0xdd, 0x45, 0xf6, 0x79, 0x28, 0x59, 0xac, 0xe4, 0xc8, 0x37, 0xcd, 0x82, 0x94, 0x7a, 0x90,
+    0x99, 0xb8, 0xf6, 0xa4, 0x4d, 0x68, 0x2b, 0x4d, 0xc8, 0xbb, 0x01, 0x07, 0xd3, 0xac, 0xa4, 0xc9,
+    0x19, 0x53, 0xaf, 0xea, 0x4f, 0xae, 0x5d, 0x58, 0xfc, 0xa6, 0x27, 0xa3, 0xf6, 0xc6, 0xc5, 0x67,
+    0x15, 0x3d, 0x57, 0xff, 0x15, 0x74, 0x45, 0xa3, 0x18, 0xfb, 0x7b, 0x1f, 0xa7, 0x53, 0x4e, 0xba,
+    0x3e, 0x0b, 0x87, 0xc2, 0x54, 0xa2, 0xe9, 0xa4, 0x56, 0x04, 0x58, 0xe9, 0x78, 0x52, 0x38, 0x4f,
+    0xc9, 0x83, 0x02, 0x1c, 0xd7, 0xb4, 0xdb, 0xf9, 0xde, 0xd2, 0x1f, 0xbb, 0x1c, 0x35, 0xd2, 0x24,
+    0x5b, 0x24, 0xda, 0xa9, 0xa8, 0x63, 0xfe, 0x5b, 0x99, 0xd9, 0xb4, 0xd2, 0xfb, 0xf5, 0x6b, 0x9f,
+    0x55, 0x2a, 0x23, 0x97, 0x52, 0xf2, 0xdd, 0xce, 0x6b, 0x13, 0x7c, 0x53, 0xa4, 0x49, 0xf4, 0xbf,
+    0x0d, 0x33, 0x9a, 0x1b, 0x39, 0x0f, 0xef, 0xf3, 0xa7, 0x9f, 0xa4, 0x19, 0xa9, 0xdd, 0x78, 0x7b,
+    0x60, 0x57, 0x34, 0xba, 0xd3, 0xe0, 0xac, 0xa6, 0x19, 0xb7, 0xad, 0x53, 0xc9, 0x54, 0x77, 0xa8,
+    0x68, 0xda, 0xed, 0x05, 0xc2, 0xd7, 0x9c, 0x3a, 0x6f, 0x46, 0xfa, 0x9b, 0x79, 0x86, 0xab, 0x92,
+    0x2c, 0x13, 0x35, 0x64, 0x9d, 0xa7, 0x77, 0x2d, 0x61, 0x0c, 0x33, 0x9d, 0x9e, 0x3a, 0x91, 0xfa,
+    0xa4, 0x07, 0x12, 0x08, 0x2d, 0xb8, 0x52, 0x9e, 0x9c, 0x82, 0x8a, 0xc9, 0x8c, 0x60, 0x72, 0xce,
+    0x50, 0x6d, 0xd4, 0xee, 0x78, 0x13, 0x76, 0x42, 0x92, 0xcc, 0xfc, 0xfe, 0x31, 0xe9, 0x6e, 0x92,
+    0xac, 0x7e, 0x46, 0x40, 0x47, 0xd2, 0x43, 0x7b, 0x74, 0x7a, 0x3d, 0xb3, 0x42, 0x3c, 0xf1, 0xb7,
+    0xd5, 0x98, 0x29, 0xdd, 0x0a, 0x30, 0x79, 0xfc, 0xe6, 0x59, 0xce, 0xa5, 0x39, 0xa9, 0x1b, 0x4d,
+    0xb0, 0x85, 0xe5, 0x60, 0xb2, 0xa8, 0x7f, 0x2a, 0x8e, 0x5c, 0xd8, 0xc1, 0xc9, 0xbf, 0xc1, 0x26,
+    0xe6, 0x13, 0x2c, 0x83, 0x85, 0x9c, 0xab, 0xd4, 0x7c, 0xdd, 0x99, 0x32, 0x47, 0x7c, 0xe6, 0xb8,
+    0xe3, 0xaa, 0xfb, 0x62, 0xe2, 0x26, 0xc6, 0xc7, 0x78, 0xac, 0xd0, 0x07, 0x03, 0xe8, 0x58, 0x14,
+    0xe3, 0x14, 0xab, 0xcf, 0x28, 0x4d, 0xa5, 0xc2, 0xb8, 0x0f, 0x9a, 0xa6, 0x0f, 0x68, 0xd4, 0xf4,
+    0x2c, 0x3d, 0x48, 0x43, 0x4f, 0x9c, 0x6f, 0x9e, 0x0f, 0x7f, 0x8d, 0x18, 0x37, 0x22, 0x98, 0x8a,
+    0xd9, 0x51, 0xf7, 0xe7, 0xc0, 0x0c, 0x52, 0x4a, 0x7b, 0xe2, 0x9b, 0x93, 0xf6, 0x27, 0xdc, 0xf8,
+    0x79, 0xdc, 0x3c, 0xdd, 0x14, 0xf1, 0xeb, 0xb3, 0x9a, 0x18, 0x37, 0xf9, 0x65, 0xc8, 0x13, 0x48,
+    0x02, 0xdc, 0x4d, 0x7f, 0xdf, 0xbd, 0xea, 0x91, 0x2e, 0xa2, 0x45, 0xdd, 0xce, 0x10, 0x21, 0x5e,
+    0xae, 0x38, 0x6c, 0x9e, 0x96, 0x23, 0xb8, 0xec, 0x9b, 0x5b, 0x8f, 0x66, 0x3c, 0x6f, 0x9a, 0x4f,
+    0xcd, 0xf7, 0x6d, 0xe6, 0xb5, 0xd2, 0x7a, 0x69, 0xea, 0x49, 0xf9, 0x68, 0x9c, 0xf9, 0x0d, 0xc7,
+    0x64, 0xf3, 0x54, 0x33, 0xb7, 0x57, 0xc4, 0x7f, 0xe9, 0xd2, 0x7f, 0xe7, 0xd9, 0x34, 0xb7, 0x4b,
+    0xf6, 0xed, 0xdc, 0x5e, 0xc9, 0xff, 0x74, 0x3c, 0x9a, 0x13, 0x98, 0xce, 0x89, 0x8b, 0xc6, 0x5a,
+    0x3a, 0x16, 0x58, 0xe9, 0x84, 0x49, 0xb3, 0x62, 0xd1, 0x8d, 0x01, 0x6f, 0xe6, 0xf4, 0xe4, 0x86,
+    0x93, 0xc1, 0xd8, 0x30, 0x28, 0x5e, 0x6e, 0x18, 0x2e, 0xdd, 0xdc, 0x6e, 0x6c, 0x94, 0xf9, 0xa6,
+    0x03, 0x32, 0x92, 0xf5, 0x06, 0xe4, 0xc4, 0x11, 0x68, 0xe6, 0x22, 0xac, 0x97, 0x0c, 0x86, 0x5f,
+    0x31, 0x8d, 0x83, 0x5a, 0x8c, 0xc7, 0x73, 0x1d, 0xc2, 0x4c, 0x28, 0x11, 0x27, 0x2e, 0x8e, 0x1b,
+    0x4f, 0x06, 0x25, 0x43, 0x96, 0x51, 0x3e, 0xef, 0x7e, 0x8d, 0x49, 0xed, 0x26, 0xaf, 0x3a, 0xf1,
+    0x4b, 0xf4, 0x79, 0x86, 0x10, 0xb1, 0x82, 0x11, 0x48, 0x11, 0xa3, 0xea, 0xbf, 0xed, 0x5a, 0x31,
+    0xf2, 0x49, 0xee, 0x74, 0xe3, 0x07, 0x12, 0xaf, 0x83, 0xea, 0xdd, 0x45, 0x1d, 0xf3, 0xab, 0x5c,
+    0xe5, 0xf5, 0x8e, 0xe3, 0xce, 0x8c, 0x21, 0xef, 0x9b, 0x7e, 0x97, 0x7d, 0xa7, 0x31, 0x69, 0xff,
+    0x38, 0x06, 0xa7, 0xb0, 0xeb, 0xe4, 0x32, 0x0d, 0xc0, 0xa4, 0x97, 0xce, 0x64, 0xa4, 0x50, 0xfd,
+    0x8d, 0x33, 0xf5, 0x7c, 0xa3, 0xc8, 0x79, 0x4f, 0xf3, 0x79, 0xbb, 0x0f, 0x82, 0x7d, 0xd7, 0xe9,
+    0xe4, 0x8e, 0x79, 0x55, 0x0f, 0x2a, 0x10, 0xc7, 0x21, 0xd3, 0x97, 0x72, 0x58, 0xa0, 0xe7, 0xb1,
+    0x4c, 0xc6, 0xb8, 0x98, 0x83, 0x7e, 0xb7, 0x2d, 0x40, 0x95, 0x18, 0x3f, 0x67, 0x7f, 0x96, 0x17,
+    0xc3, 0x0e, 0x19, 0xe5, 0xee, 0x88, 0xe1, 0x27, 0xb7, 0x60, 0x01, 0x1d, 0x40, 0x7d, 0xb8, 0x02,
+    0xe0, 0xb5, 0x7e, 0x37, 0x63, 0xe3, 0x36, 0x4f, 0x9e, 0xf0, 0x0b, 0x37, 0xfe, 0xfc, 0xd0, 0x26,
+    0x8e, 0xfe, 0x19, 0x04, 0x86, 0xfd, 0x3c, 0x95, 0x8e, 0xfc, 0xa8, 0x2e, 0xe2, 0x25, 0xa5, 0x0c,
+    0x1b, 0x97, 0x4e, 0x6a, 0x5e, 0x5f, 0x07, 0x06, 0x13, 0x9e, 0x94, 0x21, 0x10, 0xfa, 0x2a, 0x30,
+    0x98, 0xab, 0xf0, 0x69, 0x01, 0x18, 0x9c, 0xa0, 0x52, 0x07, 0x71, 0xcf, 0xc3, 0xab, 0x0a, 0x68,
+    0xe4, 0xe8, 0xcc, 0x20, 0x7c, 0x99, 0xcb, 0xa5, 0xe6, 0x59, 0x68, 0x42, 0xaf, 0xb0, 0xec, 0x2b,
+    0x5c, 0x68, 0xed, 0xa9, 0x93, 0xc2, 0x3f, 0xcf, 0xa0, 0xe1, 0xd2, 0xab, 0x31, 0xb1, 0x30, 0x01,
+    0x3f, 0x61, 0xeb, 0x50, 0x34, 0xf0, 0x30, 0xf1, 0x9f, 0xe7, 0xf1, 0x7d, 0xa2, 0x1a, 0x7a, 0xa2,
+    0x20, 0xe0, 0xc5, 0x4d, 0xdb, 0x41, 0xf3, 0x3e, 0xcf, 0x3a, 0xa8, 0x07, 0x77, 0x8f, 0xdc, 0x2e,
+    0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb,
+    0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72,
+    0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc,
+    0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7,
+    0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed,
+    0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb,
+    0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e,
+    0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb,
+    0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72,
+    0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc,
+    0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7,
+    0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed,
+    0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb,
+    0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e,
+    0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb,
+    0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72,
+    0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc,
+    0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7,
+    0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed,
+    0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb,
+    0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e,
+    0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb,
+    0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72,
+    0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xbb, 0xdc, 0x2e, 0xb7, 0xcb, 0xed, 0x72, 0xfb, 0xff,
+    0xc4, 0xed, 0x7f, 0x00, 0x68, 0x07, 0xa4, 0x67, 0x60, 0xea, 0x00, 0x00,
+};
+
+std::string dynamic_text() {
+    std::string text;
+    for (int i = 0; i < 60; ++i) {
+        text += "read_" + std::to_string(i) + " ACGTTGCA" + std::string(i % 13, "ACGT"[i % 4]) + "\n";
+    }
+    return text;
+}
+
+std::string repeated_text() {
+    std::string unit;
+    std::uint32_t x = 1;
+    for (int i = 0; i < 3000; ++i) {
+        x = (x * 1103515245u + 12345u) & 0x7fffffffu;
+        unit += "ACGT"[(x >> 16) & 3];
+    }
+    std::string text;
+    for (int i = 0; i < 20; ++i) text += unit;
+    return text;
+}
+
+std::vector<unsigned char> bytes(const unsigned char* data, std::size_t len) {
+    return std::vector<unsigned char>(data, data + len);
+}
+
+template <std::size_t N>
+std::vector<unsigned char> bytes(const unsigned char (&data)[N]) {
+    return bytes(data, N);
+}
+
+/** @brief Decompresses `data`; the sink consumes everything it is given. */
+std::string gunzip(const std::vector<unsigned char>& data, std::size_t flush_bytes = 8u << 20) {
+    std::string out;
+    bool saw_final = false;
+    inflate::gunzip(data.data(), data.size(), [&](const char* p, std::size_t len, bool final) {
+        out.append(p, len);
+        saw_final = saw_final || final;
+        return len;
+    }, flush_bytes);
+    CHECK(saw_final);
+    return out;
+}
+
+void test_block_types() {
+    CHECK(inflate::is_gzip(kStored, sizeof(kStored)));
+    CHECK(gunzip(bytes(kStored)) == "stored block\n");
+    CHECK(gunzip(bytes(kFixed)) == "fixed huffman fixed huffman fixed huffman\n");
+    CHECK(gunzip(bytes(kDynamic)) == dynamic_text());
+    CHECK(gunzip(bytes(kRepeats)) == repeated_text());
+}
+
+void test_small_flushes() {
+    // Back-references must keep working across sink calls.
+    CHECK(gunzip(bytes(kRepeats), 1024) == repeated_text());
+}
+
+void test_partial_consumption() {
+    // A sink that only takes whole lines gets the rest again with newer output.
+    std::string out;
+    inflate::gunzip(kDynamic, sizeof(kDynamic), [&](const char* p, std::size_t len, bool final) {
+        std::size_t take = final ? len : 0;
+        for (std::size_t i = 0; i < len && !final; ++i) {
+            if (p[i] == '\n') take = i + 1;
+        }
+        out.append(p, take);
+        return take;
+    }, 64);
+    CHECK(out == dynamic_text());
+}
+
+void test_multi_member() {
+    std::vector<unsigned char> data = bytes(kStored);
+    const std::vector<unsigned char> second = bytes(kFixed);
+    const std::vector<unsigned char> third = bytes(kDynamic);
+    data.insert(data.end(), second.begin(), second.end());
+    data.insert(data.end(), third.begin(), third.end());
+    CHECK(gunzip(data) == "stored block\nfixed huffman fixed huffman fixed huffman\n" + dynamic_text());
+}
+
+void test_truncated() {
+    const std::vector<unsigned char> full = bytes(kDynamic);
+    for (std::size_t len : {std::size_t{0}, std::size_t{5}, std::size_t{12}, full.size() / 2, full.size() - 4,
+                            full.size() - 1}) {
+        const std::vector<unsigned char> cut(full.begin(), full.begin() + static_cast<std::ptrdiff_t>(len));
+        CHECK_THROWS(gunzip(cut), std::runtime_error);
+    }
+    CHECK(!inflate::is_gzip(kDynamic, 1));
+}
+
+void test_corrupt() {
+    std::vector<unsigned char> data = bytes(kDynamic);
+    data[data.size() - 8] ^= 0x01; // CRC32
+    CHECK_THROWS(gunzip(data), std::runtime_error);
+
+    data = bytes(kDynamic);
+    data[data.size() - 4] ^= 0x01; // Uncompressed size
+    CHECK_THROWS(gunzip(data), std::runtime_error);
+
+    data = bytes(kStored);
+    data[10] |= 0x06; // Block type 3 is reserved
+    CHECK_THROWS(gunzip(data), std::runtime_error);
+
+    data = bytes(kStored);
+    data[13] ^= 0xff; // NLEN no longer complements LEN
+    CHECK_THROWS(gunzip(data), std::runtime_error);
+
+    data = bytes(kStored);
+    data[2] = 7; // Not deflate
+    CHECK_THROWS(gunzip(data), std::runtime_error);
+
+    // Flipping a byte of the compressed body must be detected, never crash. The last body
+    // byte is skipped: its high bits are padding after the final block.
+    const std::vector<unsigned char> clean = bytes(kRepeats);
+    for (std::size_t i = 10; i < clean.size() - 9; i += 7) {
+        data = clean;
+        data[i] ^= 0x5a;
+        CHECK_THROWS(gunzip(data), std::runtime_error);
+    }
+}
+
+} // namespace
+
+int main() {
+    test_block_types();
+    test_small_flushes();
+    test_partial_consumption();
+    test_multi_member();
+    test_truncated();
+    test_corrupt();
+    return test::exit_code();
+}
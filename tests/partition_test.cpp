@@ -0,0 +1,100 @@
+/**
+ * @file partition_test.cpp
+ * @brief Multi-process tests for PartitionCoordinator: forks workers, inserts, splits
+ * and checks that no inserted key goes missing.
+ */
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
+#include "partition_coordinator.h"
+#include "test_util.h"
+
+namespace {
+
+std::vector<std::uint64_t> key_hashes(std::size_t n) {
+    std::vector<std::uint64_t> hashes(n);
+    for (std::size_t i = 0; i < n; ++i) hashes[i] = MyBambooFilter::mix64(i);
+    return hashes;
+}
+
+std::size_t count_missing(PartitionCoordinator& coordinator, const std::vector<std::uint64_t>& hashes) {
+    std::unique_ptr<bool[]> found(new bool[hashes.size()]);
+    coordinator.contains_hashed_batch(hashes.data(), hashes.size(), found.get());
+    std::size_t missing = 0;
+    for (std::size_t i = 0; i < hashes.size(); ++i) missing += !found[i];
+    return missing;
+}
+
+std::size_t total_items(PartitionCoordinator& coordinator) {
+    std::size_t items = 0;
+    for (const auto& partition : coordinator.stats()) items += partition.items;
+    return items;
+}
+
+PartitionCoordinator::Options small_options() {
+    // Short fingerprints make many keys share a fingerprint with a key in the same buckets.
+    PartitionCoordinator::Options options;
+    options.num_workers = 3;
+    options.config.initial_num_buckets = 1024;
+    options.config.fingerprint_bits = 8;
+    return options;
+}
+
+void test_insert_and_split_keep_every_key() {
+    PartitionCoordinator coordinator(small_options());
+    const std::vector<std::uint64_t> hashes = key_hashes(200000);
+    coordinator.insert_hashed_batch(hashes.data(), hashes.size());
+    CHECK(total_items(coordinator) == hashes.size());
+    CHECK(count_missing(coordinator, hashes) == 0);
+
+    coordinator.insert_hashed_batch(hashes.data(), 1000); // Repeats add nothing
+    CHECK(total_items(coordinator) == hashes.size());
+
+    for (int s = 0; s < 3; ++s) coordinator.split_largest();
+    coordinator.split_partition(0);
+    CHECK(coordinator.num_partitions() == 7);
+    CHECK(total_items(coordinator) == hashes.size());
+    CHECK(count_missing(coordinator, hashes) == 0);
+
+    // Ranges still tile the hash space after the splits.
+    const auto partitions = coordinator.stats();
+    CHECK(partitions.front().first_hash == 0 && partitions.back().last_hash == ~0ULL);
+    for (std::size_t p = 1; p < partitions.size(); ++p) CHECK(partitions[p].first_hash == partitions[p - 1].last_hash + 1);
+
+    CHECK(coordinator.erase_hashed_batch(hashes.data(), 5000) == 5000);
+    CHECK(total_items(coordinator) == hashes.size() - 5000);
+    const std::vector<std::uint64_t> rest(hashes.begin() + 5000, hashes.end());
+    CHECK(count_missing(coordinator, rest) == 0);
+}
+
+void test_dead_worker_is_retired() {
+    PartitionCoordinator coordinator(small_options());
+    const std::vector<std::uint64_t> hashes = key_hashes(30000);
+    coordinator.insert_hashed_batch(hashes.data(), hashes.size());
+    const auto partitions = coordinator.stats();
+    ::kill(partitions[1].pid, SIGKILL);
+    ::usleep(100000);
+
+    std::unique_ptr<bool[]> found(new bool[hashes.size()]);
+    CHECK_THROWS(coordinator.contains_hashed_batch(hashes.data(), hashes.size(), found.get()), std::runtime_error);
+    CHECK_THROWS(coordinator.contains_hashed_batch(hashes.data(), hashes.size(), found.get()), std::runtime_error);
+
+    // Keys of the other partitions are still answered correctly.
+    std::vector<std::uint64_t> others;
+    for (std::uint64_t h : hashes) {
+        if (h < partitions[1].first_hash || h > partitions[1].last_hash) others.push_back(h);
+    }
+    CHECK(count_missing(coordinator, others) == 0);
+    CHECK_THROWS(coordinator.split_partition(1), std::runtime_error);
+}
+
+} // namespace
+
+int main() {
+    test_insert_and_split_keep_every_key();
+    test_dead_worker_is_retired();
+    return test::exit_code();
+}
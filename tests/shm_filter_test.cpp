@@ -0,0 +1,186 @@
+/**
+ * @file shm_filter_test.cpp
+ * @brief Reader/writer round-trip, concurrent-reader and dead-writer tests for
+ * SharedMemoryBambooFilter and its sequence-counter (seqlock) protocol.
+ */
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "shm_filter.h"
+#include "test_util.h"
+
+namespace {
+
+/** @brief A name unique to this process and test, unlinked again on destruction. */
+struct ScopedName {
+    explicit ScopedName(const char* test) : name("/bamboo-test-" + std::to_string(getpid()) + "-" + test) {
+        SharedMemoryBambooFilter::unlink(name);
+    }
+    ~ScopedName() { SharedMemoryBambooFilter::unlink(name); }
+    std::string name;
+};
+
+SharedMemoryBambooFilter::Options small_options() {
+    SharedMemoryBambooFilter::Options options;
+    options.num_buckets = 1u << 12;
+    return options;
+}
+
+void test_reader_sees_writer() {
+    ScopedName shm("round-trip");
+    SharedMemoryBambooFilter writer = SharedMemoryBambooFilter::create(shm.name, small_options());
+    SharedMemoryBambooFilter reader = SharedMemoryBambooFilter::open_reader(shm.name);
+    CHECK(writer.is_writer() && !reader.is_writer());
+
+    for (std::uint64_t i = 0; i < 10000; ++i) CHECK(writer.insert(i));
+    CHECK(reader.size() == 10000);
+    bool all = true;
+    for (std::uint64_t i = 0; i < 10000; ++i) all = all && reader.contains(i);
+    CHECK(all);
+
+    for (std::uint64_t i = 0; i < 1000; ++i) CHECK(writer.erase(i));
+    CHECK(reader.size() == 9000);
+    CHECK(writer.contains(std::uint64_t{5000}) && reader.contains(std::uint64_t{5000}));
+    CHECK_THROWS(reader.insert(std::uint64_t{1}), std::logic_error);
+}
+
+void test_fills_without_losing_items() {
+    // Inserts past the point where kicks are needed; a failed insert must leave earlier items intact.
+    ScopedName shm("fill");
+    SharedMemoryBambooFilter writer = SharedMemoryBambooFilter::create(shm.name, small_options());
+    const std::uint64_t slots = writer.capacity_buckets() * 4;
+    std::uint64_t inserted = 0;
+    for (std::uint64_t i = 0; i < slots; ++i) inserted += writer.insert(i);
+    CHECK(inserted > slots * 9 / 10);
+    CHECK(writer.size() == inserted);
+    std::uint64_t found = 0;
+    for (std::uint64_t i = 0; i < slots; ++i) found += writer.contains(i);
+    CHECK(found >= inserted);
+}
+
+void test_concurrent_reader() {
+    // Items inserted before the reader starts must stay visible while kicks move them around.
+    ScopedName shm("concurrent");
+    SharedMemoryBambooFilter writer = SharedMemoryBambooFilter::create(shm.name, small_options());
+    const std::uint64_t stable = 4000;
+    for (std::uint64_t i = 0; i < stable; ++i) writer.insert(i);
+
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> misses{0}, rounds{0};
+    std::thread reader_thread([&] {
+        SharedMemoryBambooFilter reader = SharedMemoryBambooFilter::open_reader(shm.name);
+        while (!done.load(std::memory_order_acquire)) {
+            for (std::uint64_t i = 0; i < stable; ++i) misses += !reader.contains(i);
+            ++rounds;
+        }
+    });
+    for (std::uint64_t i = stable; i < writer.capacity_buckets() * 4 * 95 / 100; ++i) {
+        writer.insert(i);
+        if (i % 64 == 0) std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+    reader_thread.join();
+    CHECK(rounds.load() > 0);
+    CHECK(misses.load() == 0);
+}
+
+void test_dead_writer() {
+    ScopedName shm("dead-writer");
+    {
+        SharedMemoryBambooFilter writer = SharedMemoryBambooFilter::create(shm.name, small_options());
+        writer.insert(std::uint64_t{1});
+    }
+    // Leave the sequence counter odd, as a writer killed inside a modification would.
+    // The counter sits at the start of the header's second cache line.
+    const int fd = shm_open(shm.name.c_str(), O_RDWR, 0);
+    CHECK(fd >= 0);
+    void* base = mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    CHECK(base != MAP_FAILED);
+    reinterpret_cast<std::atomic<std::uint64_t>*>(static_cast<char*>(base) + 64)->fetch_add(1);
+    munmap(base, 4096);
+    close(fd);
+
+    SharedMemoryBambooFilter reader = SharedMemoryBambooFilter::open_reader(shm.name);
+    CHECK_THROWS(reader.contains(std::uint64_t{1}), std::runtime_error);
+
+    // A new writer closes the interrupted modification, and readers proceed.
+    SharedMemoryBambooFilter writer = SharedMemoryBambooFilter::open_writer(shm.name);
+    CHECK(reader.contains(std::uint64_t{1}));
+}
+
+/** @brief Copies `source` and checks that the copy answers keys [0, n) exactly as the source does. */
+void check_copy(const MyBambooFilter& source, std::uint64_t n, const char* test) {
+    ScopedName shm(test);
+    SharedMemoryBambooFilter copy = SharedMemoryBambooFilter::create_from(shm.name, source);
+    CHECK(copy.size() == source.size());
+    CHECK(copy.capacity_buckets() == source.capacity_buckets());
+    std::uint64_t missing = 0, differing = 0;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        const bool expected = source.contains(i);
+        const bool found = copy.contains(i);
+        missing += expected && !found;
+        differing += expected != found;
+    }
+    CHECK(missing == 0);
+    CHECK(differing == 0);
+
+    // Keys the source skipped at insert share a look-alike's fingerprint, so the copy must keep them too.
+    SharedMemoryBambooFilter reader = SharedMemoryBambooFilter::open_reader(shm.name);
+    bool all = true;
+    for (std::uint64_t i = 0; i < n; i += 7) all = all && reader.contains(i) == source.contains(i);
+    CHECK(all);
+
+    // Erasing and re-inserting in the copied layout keeps the item findable.
+    const std::uint64_t key = n / 2;
+    if (copy.erase(key)) {
+        CHECK(copy.insert(key));
+        CHECK(copy.contains(key));
+    }
+}
+
+void test_create_from_keeps_every_key() {
+    // Short fingerprints make the source skip many keys whose fingerprint is already present.
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = 1000; // Not a power of two
+    config.fingerprint_bits = 8;
+    config.slots_per_bucket = 8;
+    MyBambooFilter source(config);
+    const std::uint64_t n = 200000;
+    for (std::uint64_t i = 0; i < n; ++i) source.insert(i);
+    CHECK(source.size() < n); // Some keys were skipped
+    check_copy(source, n, "copy");
+
+    config.alternate_window_bytes = 4096;
+    MyBambooFilter windowed(config);
+    for (std::uint64_t i = 0; i < n; ++i) windowed.insert(i);
+    check_copy(windowed, n, "copy-window");
+}
+
+void test_open_errors() {
+    ScopedName shm("errors");
+    CHECK_THROWS(SharedMemoryBambooFilter::open_reader(shm.name), std::runtime_error);
+    SharedMemoryBambooFilter::Options bad = small_options();
+    bad.fingerprint_bits = 17;
+    CHECK_THROWS(SharedMemoryBambooFilter::create(shm.name, bad), std::invalid_argument);
+
+    SharedMemoryBambooFilter writer = SharedMemoryBambooFilter::create(shm.name, small_options());
+    CHECK_THROWS(SharedMemoryBambooFilter::create(shm.name, small_options()), std::runtime_error);
+    CHECK_THROWS(SharedMemoryBambooFilter::open_writer(shm.name), std::runtime_error);
+}
+
+} // namespace
+
+int main() {
+    test_reader_sees_writer();
+    test_fills_without_losing_items();
+    test_concurrent_reader();
+    test_dead_writer();
+    test_create_from_keeps_every_key();
+    test_open_errors();
+    return test::exit_code();
+}
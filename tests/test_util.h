@@ -0,0 +1,50 @@
+#ifndef BAMBOO_TEST_UTIL_H
+#define BAMBOO_TEST_UTIL_H
+
+#include <iostream>
+
+/**
+ * @file test_util.h
+ * @brief Minimal checks for the test executables: a failed check is reported with its
+ * location and the test keeps going; main() returns test::exit_code().
+ */
+namespace test {
+
+/** @brief Number of failed checks so far. */
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+/** @brief Reports a failed check. */
+inline void fail(const char* file, int line, const char* what) {
+    std::cerr << file << ":" << line << ": check failed: " << what << "\n";
+    ++failures();
+}
+
+/** @brief Returns the process exit code: 0 if every check passed. */
+inline int exit_code() {
+    if (failures() != 0) std::cerr << failures() << " check(s) failed\n";
+    return failures() == 0 ? 0 : 1;
+}
+
+} // namespace test
+
+#define CHECK(cond)                                          \
+    do {                                                     \
+        if (!(cond)) test::fail(__FILE__, __LINE__, #cond);  \
+    } while (0)
+
+/** @brief Checks that `expr` throws an exception of type `type` (or a type derived from it). */
+#define CHECK_THROWS(expr, type)                                                      \
+    do {                                                                              \
+        bool thrown_ = false;                                                         \
+        try {                                                                         \
+            (void)(expr);                                                             \
+        } catch (const type&) {                                                       \
+            thrown_ = true;                                                           \
+        }                                                                             \
+        if (!thrown_) test::fail(__FILE__, __LINE__, #expr " throws " #type);         \
+    } while (0)
+
+#endif // BAMBOO_TEST_UTIL_H
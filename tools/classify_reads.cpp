@@ -0,0 +1,83 @@
+/**
+ * @file classify_reads.cpp
+ * @brief Screens reads against a reference: builds a k-mer filter from the
+ * reference, then classifies every read with early-terminating batched probes.
+ *
+ * Usage:
+ *   BambooClassifyReads --reference REF [-k K] [--threshold F] [--threads N]
+ *                       [--buckets N] [--matched-output FILE] READS...
+ */
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "fastx_reader.h"
+
+int main(int argc, char** argv) {
+    std::string reference;
+    std::string matched_output;
+    unsigned k = 31;
+    float threshold = 0.5f;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    MyBambooFilter::Config config;
+    config.initial_num_buckets = 1u << 20;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--reference") reference = argv[++i];
+        else if (i + 1 < argc && arg == "-k") k = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (i + 1 < argc && arg == "--threshold") threshold = std::stof(argv[++i]);
+        else if (i + 1 < argc && arg == "--threads") threads = std::stoull(argv[++i]);
+        else if (i + 1 < argc && arg == "--buckets") config.initial_num_buckets = std::stoull(argv[++i]);
+        else if (i + 1 < argc && arg == "--matched-output") matched_output = argv[++i];
+        else if (!arg.empty() && arg[0] != '-') files.push_back(arg);
+        else {
+            files.clear();
+            break;
+        }
+    }
+    if (reference.empty() || files.empty()) {
+        std::cerr << "Usage: BambooClassifyReads --reference REF [-k K] [--threshold F] [--threads N]\n"
+                     "                           [--buckets N] [--matched-output FILE] READS...\n";
+        return 1;
+    }
+
+    try {
+        MyBambooFilter filter(config);
+        bench::Stopwatch watch;
+        const std::size_t reference_kmers = build_filter_from_fastx(reference, filter, k, threads);
+        std::cout << "reference: " << reference_kmers << " k-mers, " << filter.size() << " items in "
+                  << watch.seconds() << " s\n";
+
+        std::ofstream matched;
+        std::mutex matched_mutex;
+        if (!matched_output.empty()) {
+            matched.open(matched_output);
+            if (!matched) throw std::runtime_error("Cannot write " + matched_output);
+        }
+
+        for (const auto& file : files) {
+            watch.reset();
+            const ClassificationSummary summary = classify_fastx(
+                file, filter, k, threshold, threads,
+                [&](const FastxRecord& record, const MyBambooFilter::ReadClassification& result, std::size_t) {
+                    if (!result.matched || !matched.is_open()) return;
+                    std::lock_guard<std::mutex> lock(matched_mutex);
+                    matched << record.name << '\n';
+                });
+            const double seconds = watch.seconds();
+            std::cout << file << ": reads=" << summary.reads << " matched=" << summary.matched
+                      << " probed " << summary.kmers_probed << " of " << summary.kmers_total << " k-mers ("
+                      << (summary.kmers_total ? 100.0 * summary.kmers_probed / summary.kmers_total : 0.0)
+                      << "%) in " << seconds << " s (" << summary.reads / seconds / 1e6 << " M reads/s)\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file kmer_count.cpp
+ * @brief Counts k-mers of FASTA/FASTQ files with singleton pre-filtering and
+ * prints the count histogram, optionally writing the counted k-mers as TSV.
+ *
+ * Usage:
+ *   BambooKmerCount [-k K] [--hash-threads N] [--partitions N] [--buckets N]
+ *                   [--min-count N] [--output FILE] FILE...
+ */
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "kmer.h"
+#include "kmer_counter.h"
+
+int main(int argc, char** argv) {
+    KmerCounter::Options options;
+    const std::size_t cores = std::max(2u, std::thread::hardware_concurrency());
+    options.hash_workers = cores / 2;
+    options.partitions = cores - cores / 2;
+    options.filter_config.initial_num_buckets = 1u << 18;
+    std::uint32_t min_count = 2;
+    std::string output;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "-k") options.k = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (i + 1 < argc && arg == "--hash-threads") options.hash_workers = std::stoull(argv[++i]);
+        else if (i + 1 < argc && arg == "--partitions") options.partitions = std::stoull(argv[++i]);
+        else if (i + 1 < argc && arg == "--buckets") options.filter_config.initial_num_buckets = std::stoull(argv[++i]);
+        else if (i + 1 < argc && arg == "--min-count") min_count = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+        else if (i + 1 < argc && arg == "--output") output = argv[++i];
+        else if (!arg.empty() && arg[0] != '-') files.push_back(arg);
+        else {
+            files.clear();
+            break;
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: BambooKmerCount [-k K] [--hash-threads N] [--partitions N] [--buckets N]\n"
+                     "                       [--min-count N] [--output FILE] FILE...\n";
+        return 1;
+    }
+
+    try {
+        KmerCounter counter(options);
+        bench::Stopwatch watch;
+        for (const auto& file : files) counter.count_file(file);
+        const double seconds = watch.seconds();
+
+        const KmerCounter::Stats stats = counter.stats();
+        std::cout << "records=" << stats.records << " kmers=" << stats.kmers << " time=" << seconds << " s ("
+                  << stats.kmers / seconds / 1e6 << " M k-mers/s)\n"
+                  << "distinct (filter items)=" << stats.filter_items << " counted (seen >= 2)=" << stats.promoted
+                  << " singletons filtered=" << stats.filter_items - stats.promoted << "\n"
+                  << "filter memory=" << stats.filter_memory / (1024.0 * 1024.0)
+                  << " MiB table memory=" << stats.table_memory / (1024.0 * 1024.0) << " MiB\n";
+
+        std::map<std::uint32_t, std::size_t> histogram;
+        counter.for_each([&](std::uint64_t, std::uint32_t count) { histogram[std::min<std::uint32_t>(count, 100)]++; });
+        std::cout << "count\tk-mers\n";
+        for (const auto& [count, kmers] : histogram) {
+            std::cout << (count == 100 ? ">=100" : std::to_string(count)) << "\t" << kmers << "\n";
+        }
+
+        if (!output.empty()) {
+            std::ofstream out(output);
+            if (!out) throw std::runtime_error("Cannot write " + output);
+            counter.for_each([&](std::uint64_t code, std::uint32_t count) {
+                if (count >= min_count) out << kmer::decode(code, options.k) << '\t' << count << '\n';
+            });
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file partition_demo.cpp
+ * @brief Spreads a filter over several worker processes by hash range, splits the
+ * fullest partition while it holds data, and reports lookups of the inserted keys.
+ *
+ * Workers store every distinct hash, so each key moves with its range on a split and
+ * the reported false negatives should always be 0. Repeated keys are the only inserts
+ * that add nothing.
+ *
+ * Usage:
+ *   BambooPartitionDemo [--workers N] [--keys N] [--splits N] [--batch N]
+ */
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "partition_coordinator.h"
+
+namespace {
+
+int usage() {
+    std::cerr << "Usage: BambooPartitionDemo [--workers N] [--keys N] [--splits N] [--batch N]\n";
+    return 1;
+}
+
+void print_stats(PartitionCoordinator& coordinator) {
+    for (const auto& p : coordinator.stats()) {
+        std::cout << "  [" << std::hex << p.first_hash << ", " << p.last_hash << std::dec << "] pid " << p.pid
+                  << ": " << p.items << " items, " << p.buckets << " buckets, "
+                  << p.memory_bytes / (1024.0 * 1024.0) << " MiB\n";
+    }
+}
+
+// Returns the number of inserted keys the partitions do not report.
+std::size_t count_missing(PartitionCoordinator& coordinator, const std::vector<std::uint64_t>& hashes, std::size_t batch,
+                          double& seconds) {
+    std::unique_ptr<bool[]> found(new bool[batch]);
+    std::size_t missing = 0;
+    bench::Stopwatch watch;
+    for (std::size_t i = 0; i < hashes.size(); i += batch) {
+        const std::size_t n = std::min(batch, hashes.size() - i);
+        coordinator.contains_hashed_batch(hashes.data() + i, n, found.get());
+        for (std::size_t j = 0; j < n; ++j) missing += !found[j];
+    }
+    seconds = watch.seconds();
+    return missing;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    PartitionCoordinator::Options options;
+    std::size_t keys = 1000000, splits = 2, batch = 65536;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--workers") options.num_workers = std::stoull(argv[++i]);
+        else if (i + 1 < argc && arg == "--keys") keys = std::stoull(argv[++i]);
+        else if (i + 1 < argc && arg == "--splits") splits = std::stoull(argv[++i]);
+        else if (i + 1 < argc && arg == "--batch") batch = std::max<std::size_t>(1, std::stoull(argv[++i]));
+        else return usage();
+    }
+
+    try {
+        PartitionCoordinator coordinator(options);
+        std::vector<std::uint64_t> hashes(keys);
+        for (std::size_t i = 0; i < keys; ++i) hashes[i] = MyBambooFilter::mix64(i);
+
+        bench::Stopwatch watch;
+        for (std::size_t i = 0; i < keys; i += batch) {
+            coordinator.insert_hashed_batch(hashes.data() + i, std::min(batch, keys - i));
+        }
+        std::cout << "Inserted " << keys << " keys into " << coordinator.num_partitions() << " partitions: "
+                  << keys / watch.seconds() / 1e6 << " Mops/s\n";
+        print_stats(coordinator);
+        std::size_t stored = 0;
+        for (const auto& p : coordinator.stats()) stored += p.items;
+        std::cout << keys - stored << " repeated keys skipped at insert\n";
+
+        double seconds = 0;
+        std::size_t missing = count_missing(coordinator, hashes, batch, seconds);
+        std::cout << "Lookup: " << keys / seconds / 1e6 << " Mops/s, " << missing << " false negatives\n";
+
+        for (std::size_t s = 0; s < splits; ++s) {
+            watch.reset();
+            const std::size_t index = coordinator.split_largest();
+            std::cout << "Split partition " << index << " in " << watch.seconds() * 1e3 << " ms\n";
+        }
+        print_stats(coordinator);
+
+        missing = count_missing(coordinator, hashes, batch, seconds);
+        std::cout << "Lookup after splits: " << keys / seconds / 1e6 << " Mops/s, " << missing
+                  << " false negatives\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * @file shm_filter.cpp
+ * @brief Publishes a reference k-mer filter in POSIX shared memory and queries it
+ * from any number of independent processes.
+ *
+ * Usage:
+ *   BambooShmFilter create NAME --reference REF [-k K] [--threads N]
+ *   BambooShmFilter query NAME [-k K] [--threads N] READS...
+ *   BambooShmFilter unlink NAME
+ */
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "fastx_reader.h"
+#include "kmer.h"
+#include "shm_filter.h"
+
+namespace {
+
+int usage() {
+    std::cerr << "Usage: BambooShmFilter create NAME --reference REF [-k K] [--threads N]\n"
+                 "       BambooShmFilter query NAME [-k K] [--threads N] READS...\n"
+                 "       BambooShmFilter unlink NAME\n";
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) return usage();
+    const std::string command = argv[1];
+    const std::string name = argv[2];
+    std::string reference;
+    unsigned k = 31;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> files;
+
+    for (int i = 3; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--reference") reference = argv[++i];
+        else if (i + 1 < argc && arg == "-k") k = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (i + 1 < argc && arg == "--threads") threads = std::stoull(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-') files.push_back(arg);
+        else return usage();
+    }
+
+    try {
+        if (command == "unlink") {
+            if (!SharedMemoryBambooFilter::unlink(name)) throw std::runtime_error("No shared filter named " + name);
+            return 0;
+        }
+
+        if (command == "create") {
+            if (reference.empty()) return usage();
+            bench::Stopwatch watch;
+            MyBambooFilter::Config config;
+            config.initial_num_buckets = 1u << 20;
+            MyBambooFilter filter(config);
+            const std::size_t kmers = build_filter_from_fastx(reference, filter, k, threads);
+            SharedMemoryBambooFilter shared = SharedMemoryBambooFilter::create_from(name, filter);
+            std::cout << name << ": " << kmers << " k-mers, " << shared.size() << " items, "
+                      << shared.memoryUsage() / (1024.0 * 1024.0) << " MiB shared, load " << shared.loadFactor()
+                      << ", built in " << watch.seconds() << " s\n";
+            return 0;
+        }
+
+        if (command != "query" || files.empty()) return usage();
+        const SharedMemoryBambooFilter shared = SharedMemoryBambooFilter::open_reader(name);
+        for (const auto& file : files) {
+            bench::Stopwatch watch;
+            std::atomic<std::size_t> total{0}, hits{0};
+            FastxReader reader(file);
+            const std::size_t reads = reader.parallel_for_each_record(threads, [&](const FastxRecord& record, std::size_t) {
+                std::size_t record_total = 0, record_hits = 0;
+                kmer::for_each_canonical_kmer(record.sequence, k, [&](std::uint64_t code) {
+                    ++record_total;
+                    record_hits += shared.contains_hashed(MyBambooFilter::mix64(code));
+                });
+                total += record_total;
+                hits += record_hits;
+            });
+            const double seconds = watch.seconds();
+            std::cout << file << ": reads=" << reads << " k-mers=" << total << " present=" << hits << " ("
+                      << (total ? 100.0 * hits / total : 0.0) << "%) in " << seconds << " s ("
+                      << total / seconds / 1e6 << " M k-mers/s)\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file simulate.cpp
+ * @brief Writes a reproducible synthetic reference genome (FASTA) and simulated
+ * reads from it (FASTQ) for benchmarks that cannot ship real data.
+ *
+ * Usage:
+ *   BambooSimulate --genome-out FILE [--genome-length N[K|M|G]] [--repeat-fraction F]
+ *                  [--repeat-families N] [--repeat-length N] [--repeat-divergence F]
+ *                  [--gc F] [--seed N]
+ *                  [--reads N --reads-out FILE] [--read-length N] [--substitution-rate F]
+ *                  [--indel-rate F] [--n-rate F] [--read-seed N]
+ */
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "synthetic_genome.h"
+
+namespace {
+
+std::uint64_t parse_count(const std::string& text) {
+    std::size_t pos = 0;
+    double value = std::stod(text, &pos);
+    if (pos < text.size()) {
+        switch (text[pos]) {
+            case 'k': case 'K': value *= 1e3; break;
+            case 'm': case 'M': value *= 1e6; break;
+            case 'g': case 'G': value *= 1e9; break;
+            default: throw std::invalid_argument("Bad count suffix in " + text);
+        }
+    }
+    return static_cast<std::uint64_t>(value);
+}
+
+void write_or_throw(std::FILE* out, const char* data, std::size_t len) {
+    if (std::fwrite(data, 1, len, out) != len) throw std::runtime_error("Write failed.");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::GenomeOptions genome_options;
+    bench::ReadOptions read_options;
+    std::string genome_out;
+    std::string reads_out;
+    std::uint64_t num_reads = 0;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--genome-out") genome_out = next();
+            else if (arg == "--genome-length") genome_options.length = parse_count(next());
+            else if (arg == "--repeat-fraction") genome_options.repeat_fraction = std::stod(next());
+            else if (arg == "--repeat-families") genome_options.repeat_families = parse_count(next());
+            else if (arg == "--repeat-length") genome_options.repeat_length = parse_count(next());
+            else if (arg == "--repeat-divergence") genome_options.repeat_divergence = std::stod(next());
+            else if (arg == "--gc") genome_options.gc_content = std::stod(next());
+            else if (arg == "--seed") genome_options.seed = parse_count(next());
+            else if (arg == "--reads") num_reads = parse_count(next());
+            else if (arg == "--reads-out") reads_out = next();
+            else if (arg == "--read-length") read_options.read_length = parse_count(next());
+            else if (arg == "--substitution-rate") read_options.substitution_rate = std::stod(next());
+            else if (arg == "--indel-rate") read_options.insertion_rate = read_options.deletion_rate = std::stod(next()) / 2;
+            else if (arg == "--n-rate") read_options.n_rate = std::stod(next());
+            else if (arg == "--read-seed") read_options.seed = parse_count(next());
+            else throw std::invalid_argument("Unknown argument " + arg);
+        }
+        if (genome_out.empty() || (num_reads > 0 && reads_out.empty())) {
+            throw std::invalid_argument("--genome-out is required, and --reads needs --reads-out");
+        }
+
+        const std::string genome = bench::generate_genome(genome_options);
+
+        std::FILE* out = std::fopen(genome_out.c_str(), "w");
+        if (!out) throw std::runtime_error("Cannot write " + genome_out);
+        std::fprintf(out, ">synthetic length=%llu seed=%llu\n", static_cast<unsigned long long>(genome.size()),
+                     static_cast<unsigned long long>(genome_options.seed));
+        for (std::size_t pos = 0; pos < genome.size(); pos += 80) {
+            write_or_throw(out, genome.data() + pos, std::min<std::size_t>(80, genome.size() - pos));
+            write_or_throw(out, "\n", 1);
+        }
+        std::fclose(out);
+
+        if (num_reads > 0) {
+            out = std::fopen(reads_out.c_str(), "w");
+            if (!out) throw std::runtime_error("Cannot write " + reads_out);
+            bench::ReadSimulator simulator(genome, read_options);
+            std::string sequence, quality;
+            for (std::uint64_t r = 0; r < num_reads; ++r) {
+                const std::uint64_t pos = simulator.next(sequence, quality);
+                std::fprintf(out, "@read%llu pos=%llu\n", static_cast<unsigned long long>(r),
+                             static_cast<unsigned long long>(pos));
+                write_or_throw(out, sequence.data(), sequence.size());
+                write_or_throw(out, "\n+\n", 3);
+                write_or_throw(out, quality.data(), quality.size());
+                write_or_throw(out, "\n", 1);
+            }
+            std::fclose(out);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}